@@ -16,6 +16,7 @@
 // Includes:
 #include <pthread.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -23,6 +24,14 @@
 
 // Macros:
 
+//! \def ASYNC_RECORD_SIZE
+//! \brief Char length of a message record stored by the asynchronous logger.
+//!
+//! When asynchronous logging is enabled, each message's context and contents
+//! are copied into a fixed size record of the asynchronous logging ring buffer.
+//! Messages whose context and contents exceed this length are truncated.
+#define ASYNC_RECORD_SIZE 1024
+
 //! \def DEFAULT_LOGGER_MESSAGE_COLORS
 //! \brief Macro to initialize a DisplayColors array with the default values
 //! used by the Message Logger for messages.
@@ -95,6 +104,155 @@
   }                                 \
 }
 
+//! \def FLIGHT_RECORD_SIZE
+//! \brief Char length of a message record stored by the flight recorder.
+//!
+//! When the flight recorder is enabled, each message's context and contents
+//! are copied into a fixed size record of the flight recorder. Messages whose
+//! context and contents exceed this length are truncated.
+#define FLIGHT_RECORD_SIZE 256
+
+//! \def LOGGER_BATCH
+//! \brief Runs the following statement or block as a batch of the Message
+//! Logger's operations.
+//!
+//! Calls begin_logger_batch() before the statement and end_logger_batch()
+//! after it, so no other thread can interleave with it's messages or output.
+//!
+//! \warning Do NOT leave the statement with break, goto or return, since the
+//! batch would not end.
+//!
+//! \par Usage example
+//! \code
+//! LOGGER_BATCH {
+//!   error("Example", "Request failed with the following data:\n");
+//!   printf("%s\n", request_data);
+//! }
+//! \endcode
+#define LOGGER_BATCH                                                          \
+  for(                                                                         \
+    int logger_batch_pending = (begin_logger_batch(), 1);                      \
+    logger_batch_pending;                                                      \
+    logger_batch_pending = (end_logger_batch(), 0)                             \
+  )
+
+//! \def LOGGER_LEVEL_INFO
+//! \brief Severity level of info messages. The lowest severity level.
+//!
+//! The severity levels order the message categories from the least to the
+//! most severe: info, default message, success, warning and error. Define the
+//! MESSAGE_LOGGER_MIN_LEVEL macro with one of these levels before including
+//! this header (or with the compiler's -D flag) to remove every call to the
+//! logging functions with a lower severity level at compile time. Removed calls
+//! do NOT evaluate their arguments.
+//!
+//! \par Usage example
+//! \code
+//! #define MESSAGE_LOGGER_MIN_LEVEL LOGGER_LEVEL_WARNING
+//! #include "message_logger.h"
+//!
+//! // ...
+//! info("Example", "Removed at compile time: %d\n", expensive_function());
+//! warning("Example", "Still logged.\n");
+//! \endcode
+#define LOGGER_LEVEL_INFO 0
+
+//! \def LOGGER_LEVEL_MESSAGE
+//! \brief Severity level of default messages. See #LOGGER_LEVEL_INFO.
+#define LOGGER_LEVEL_MESSAGE 1
+
+//! \def LOGGER_LEVEL_SUCCESS
+//! \brief Severity level of success messages. See #LOGGER_LEVEL_INFO.
+#define LOGGER_LEVEL_SUCCESS 2
+
+//! \def LOGGER_LEVEL_WARNING
+//! \brief Severity level of warning messages. See #LOGGER_LEVEL_INFO.
+#define LOGGER_LEVEL_WARNING 3
+
+//! \def LOGGER_LEVEL_ERROR
+//! \brief Severity level of error messages. See #LOGGER_LEVEL_INFO.
+#define LOGGER_LEVEL_ERROR 4
+
+//! \def LOGGER_LEVEL_NONE
+//! \brief Severity level above every message category. Use it as the
+//! MESSAGE_LOGGER_MIN_LEVEL to remove all logging calls. See
+//! #LOGGER_LEVEL_INFO.
+#define LOGGER_LEVEL_NONE 5
+
+//! \def LOG_BOOL(field_key, field_value)
+//! \brief Creates a LogField with a boolean value. See #LOG_FIELDS.
+#define LOG_BOOL(field_key, field_value)                                      \
+  ((LogField) {                                                                \
+    .key = (field_key), .type = BOOL_FIELD, .bool_value = (field_value)        \
+  })
+
+//! \def LOG_DOUBLE(field_key, field_value)
+//! \brief Creates a LogField with a floating point value. See #LOG_FIELDS.
+#define LOG_DOUBLE(field_key, field_value)                                    \
+  ((LogField) {                                                                \
+    .key = (field_key), .type = DOUBLE_FIELD, .double_value = (field_value)    \
+  })
+
+//! \def LOG_FIELDS(...)
+//! \brief Expands to the fields and number of fields arguments of the
+//! structured logging functions (e.g: error_fields()).
+//!
+//! Receives the message's fields, created with the #LOG_BOOL, #LOG_DOUBLE,
+//! #LOG_INT, #LOG_STRING and #LOG_UINT macros, and stores them in a temporary
+//! array, so no memory is allocated.
+//!
+//! \par Usage example
+//! \code
+//! error_fields(
+//!   "Database",
+//!   LOG_FIELDS(LOG_STRING("table", "users"), LOG_INT("code", -4)),
+//!   "Query failed after %d retries.\n",
+//!   retries
+//! );
+//! \endcode
+#define LOG_FIELDS(...)                                                       \
+  (const LogField[]) { __VA_ARGS__ },                                          \
+  sizeof((const LogField[]) { __VA_ARGS__ }) / sizeof(LogField)
+
+//! \def LOG_INT(field_key, field_value)
+//! \brief Creates a LogField with a signed integer value. See #LOG_FIELDS.
+#define LOG_INT(field_key, field_value)                                       \
+  ((LogField) {                                                                \
+    .key = (field_key), .type = INT_FIELD, .int_value = (field_value)          \
+  })
+
+//! \def LOG_STRING(field_key, field_value)
+//! \brief Creates a LogField with a null terminated string value. See
+//! #LOG_FIELDS.
+#define LOG_STRING(field_key, field_value)                                    \
+  ((LogField) {                                                                \
+    .key = (field_key), .type = STRING_FIELD, .string_value = (field_value)    \
+  })
+
+//! \def LOG_UINT(field_key, field_value)
+//! \brief Creates a LogField with an unsigned integer value. See #LOG_FIELDS.
+#define LOG_UINT(field_key, field_value)                                      \
+  ((LogField) {                                                                \
+    .key = (field_key), .type = UINT_FIELD, .uint_value = (field_value)        \
+  })
+
+//! \def MAPPED_LOG_FILE_WINDOW
+//! \brief Max char length of a memory mapped log file.
+//!
+//! A memory mapped log file reserves this much address space when it is
+//! configured, but only allocates disk space as messages are written to it.
+#if SIZE_MAX > 0xFFFFFFFF
+#define MAPPED_LOG_FILE_WINDOW ((size_t) 1 << 36)
+#else
+#define MAPPED_LOG_FILE_WINDOW ((size_t) 1 << 30)
+#endif
+
+//! \def MAX_LOG_SINKS
+//! \brief Max number of log sinks attached to the Message Logger at once.
+//!
+//! See add_log_sink().
+#define MAX_LOG_SINKS 8
+
 //! \def TIME_FMT_SIZE
 //! \brief Char length of the string_representation member of a TimeFormat.
 //!
@@ -131,6 +289,58 @@ typedef enum {
   DFLT          //!< Default color according to terminal settings.
 } Color;
 
+//! \enum ArchiveNaming
+//! \brief A naming scheme for the archives of a rotated log file.
+//!
+//! When a log file is rotated, it is renamed to an archive and a new, empty
+//! log file is created in it's place. This enumeration determines how the
+//! archives are named, using the log file's name as a prefix.
+typedef enum {
+  //! Archives are numbered from the newest ("file.log.1") to the oldest.
+  NUMBERED_ARCHIVES,
+  //! Archives are suffixed with their rotation time (e.g:
+  //! "file.log.20191231-235959").
+  TIMESTAMPED_ARCHIVES
+} ArchiveNaming;
+
+//! \enum ColorMode
+//! \brief A mode that determines if colors are displayed on the terminal.
+//!
+//! When the program's standard output is redirected to a file or a pipe (e.g:
+//! when running as a service), the ANSI escape codes used to display colors
+//! only add noise to the output. This enumeration determines whether the
+//! Message Logger emits those escape codes.
+typedef enum {
+  AUTO_COLORS,  //!< Display colors only if the standard output is a terminal.
+  ALWAYS_COLORS,//!< Always display colors.
+  NEVER_COLORS  //!< Never display colors, writing plain text instead.
+} ColorMode;
+
+//! \enum LogFieldType
+//! \brief Type of the value of a LogField.
+typedef enum {
+  BOOL_FIELD,   //!< Boolean, written as true or false.
+  DOUBLE_FIELD, //!< Floating point number.
+  INT_FIELD,    //!< Signed integer.
+  STRING_FIELD, //!< Null terminated string.
+  UINT_FIELD    //!< Unsigned integer.
+} LogFieldType;
+
+//! \enum LogFileFormat
+//! \brief A format in which messages are written to the log file.
+//!
+//! Log files are written as text lines by default, meant to be read by people.
+//! When log files are ingested by other programs, the JSON Lines format writes
+//! each message as a JSON object in it's own line, so no parsing rules are
+//! needed to extract the message's information and fields.
+typedef enum {
+  //! "[time] context: (Tag) contents {fields}" lines.
+  TEXT_LOG_FILE,
+  //! {"timestamp":..., "category":..., "context":..., "message":...,
+  //! "fields":{...}} lines. The timestamp is in seconds since the epoch.
+  JSON_LOG_FILE
+} LogFileFormat;
+
 //! \enum LogFileMode
 //! \brief A file mode used to open a log file.
 //!
@@ -200,6 +410,54 @@ typedef enum {
 //! \endcode
 #define NUM_OF_TAG_CATEGORIES 5
 
+//! \def ALL_MESSAGE_CATEGORIES
+//! \brief Category mask with every #MessageCategory enabled.
+//!
+//! Companion macro to the #MessageCategory enumeration. It is the default mask
+//! of categories enabled in the Message Logger.
+//!
+//! \par Usage example
+//! \code
+//! set_enabled_categories(ALL_MESSAGE_CATEGORIES & ~CATEGORY_MASK(INFO_MSG));
+//! \endcode
+#define ALL_MESSAGE_CATEGORIES ((1u << NUM_OF_MESSAGE_CATEGORIES) - 1)
+
+//! \def CATEGORY_MASK(category)
+//! \brief Category mask with only a given #MessageCategory enabled.
+//!
+//! Companion macro to the #MessageCategory enumeration. Combine the masks of
+//! several categories with a bitwise or to enable all of them.
+//!
+//! \par Usage example
+//! \code
+//! set_enabled_categories(
+//!   CATEGORY_MASK(ERROR_MSG) | CATEGORY_MASK(WARNING_MSG)
+//! );
+//! \endcode
+#define CATEGORY_MASK(category) (1u << (category))
+
+//! \def CATEGORIES_FROM_LEVEL(level)
+//! \brief Category mask with every #MessageCategory whose severity level is
+//! equal to or above a given level.
+//!
+//! Companion macro to the #MessageCategory enumeration. The levels are the
+//! same used by MESSAGE_LOGGER_MIN_LEVEL (see #LOGGER_LEVEL_INFO).
+//!
+//! \par Usage example
+//! \code
+//! LogSinkConfiguration errors_sink = {
+//!   .file_name = "errors.log",
+//!   .category_mask = CATEGORIES_FROM_LEVEL(LOGGER_LEVEL_ERROR)
+//! };
+//! \endcode
+#define CATEGORIES_FROM_LEVEL(level) (                                        \
+  ((level) <= LOGGER_LEVEL_INFO ? CATEGORY_MASK(INFO_MSG) : 0u) |             \
+  ((level) <= LOGGER_LEVEL_MESSAGE ? CATEGORY_MASK(DEFAULT_MSG) : 0u) |       \
+  ((level) <= LOGGER_LEVEL_SUCCESS ? CATEGORY_MASK(SUCCESS_MSG) : 0u) |       \
+  ((level) <= LOGGER_LEVEL_WARNING ? CATEGORY_MASK(WARNING_MSG) : 0u) |       \
+  ((level) <= LOGGER_LEVEL_ERROR ? CATEGORY_MASK(ERROR_MSG) : 0u)             \
+)
+
 // Type definitions:
 
 //! \struct DisplayColors
@@ -236,6 +494,110 @@ typedef struct {
   DisplayColors tag_colors[NUM_OF_TAG_CATEGORIES];
 } LoggerColorPallet;
 
+//! \struct LogDurabilityPolicy
+//! \brief When the log file's messages are forced to disk.
+//!
+//! Messages written to a log file are buffered by the C library and by the
+//! operating system, so a crash of the program loses the messages still
+//! buffered and a crash of the system loses the messages not yet on disk. A
+//! background thread flushes and syncs (with fdatasync()) the log file every
+//! #sync_interval milliseconds and whenever #sync_size chars were written
+//! since the last sync. Error messages can also be flushed and synced as soon
+//! as they are written, with #sync_errors. Set a member to 0 to disable it's
+//! condition.
+typedef struct {
+  unsigned int sync_interval;     //!< Milliseconds between syncs. 0 = off.
+  size_t sync_size;               //!< Chars written between syncs. 0 = off.
+  int sync_errors;                //!< Whether errors are synced at once.
+} LogDurabilityPolicy;
+
+//! \struct LogField
+//! \brief A typed key-value field attached to a message.
+//!
+//! Structured logging functions (e.g: error_fields()) receive an array of
+//! fields along with the message. Fields are written to the terminal and to
+//! text log files as a JSON object after the message's contents, and as the
+//! "fields" member of the message's object in JSON Lines log files. Create
+//! fields with the #LOG_BOOL, #LOG_DOUBLE, #LOG_INT, #LOG_STRING and
+//! #LOG_UINT macros.
+typedef struct {
+  const char *key;              //!< Field's name.
+  LogFieldType type;            //!< Type of the field's value.
+  union {
+    int bool_value;             //!< Value of a #BOOL_FIELD.
+    double double_value;        //!< Value of a #DOUBLE_FIELD.
+    long long int_value;        //!< Value of an #INT_FIELD.
+    const char *string_value;   //!< Value of a #STRING_FIELD.
+    unsigned long long uint_value; //!< Value of an #UINT_FIELD.
+  };
+} LogField;
+
+//! \struct LogRotationPolicy
+//! \brief Conditions that rotate the log file and how it's archives are kept.
+//!
+//! A log file is rotated before a message would make it larger than
+//! #max_file_size or when a message is logged #rotation_interval seconds or
+//! more after the log file was created. Set a member to 0 to disable it's
+//! condition. At most #max_archives archives are kept, the oldest ones being
+//! deleted.
+typedef struct {
+  size_t max_file_size;           //!< Max char length of a log file. 0 = off.
+  unsigned int rotation_interval; //!< Seconds between rotations. 0 = off.
+  unsigned int max_archives;      //!< Max number of archives kept.
+  ArchiveNaming archive_naming;   //!< Naming scheme of the archives.
+} LogRotationPolicy;
+
+//! \struct LogRecordView
+//! \brief A logged message, as passed to a LogRecordCallback.
+//!
+//! The strings referenced point into the Message Logger's own buffers. They
+//! are NOT null terminated, must be used with their respective lengths and
+//! are only valid until the callback returns.
+typedef struct {
+  MessageCategory category;     //!< Category of the message.
+  struct timespec timestamp;    //!< Time when the message was logged.
+  const char *context;          //!< Message's context. NULL if it has none.
+  size_t context_length;        //!< Char length of the message's context.
+  const char *body;             //!< Message's formatted contents.
+  size_t body_length;           //!< Char length of the message's contents.
+  //! Message's fields, as a JSON object. NULL if it has none.
+  const char *fields;
+  size_t fields_length;         //!< Char length of the message's fields.
+} LogRecordView;
+
+//! \typedef LogRecordCallback
+//! \brief Function called by a log sink for each message it accepts.
+//!
+//! Receives the message and the user_data pointer of the sink's
+//! LogSinkConfiguration. It is called with the Message Logger's lock held, so
+//! it must NOT call the Message Logger's functions.
+typedef void (*LogRecordCallback)(const LogRecordView *record, void *user_data);
+
+//! \struct LogSinkConfiguration
+//! \brief Where and how a log sink writes the Message Logger's messages.
+//!
+//! A log sink writes messages to a stream provided by the user (e.g: stderr)
+//! or to a file opened by the Message Logger, when #stream is NULL. If a
+//! #callback is provided, it is called with each message instead and the
+//! other output members are ignored. Only the message categories in
+//! #category_mask are written, and each sink chooses whether it's messages
+//! have display colors and a timestamp. Members left zeroed write no messages,
+//! without colors, timestamped with the Message Logger's time format.
+typedef struct {
+  FILE *stream;                 //!< Stream written to. NULL to open a file.
+  const char *file_name;        //!< Name of the file opened if stream is NULL.
+  LogFileMode file_mode;        //!< Mode used for opening the file.
+  unsigned int category_mask;   //!< Mask of the categories written.
+  //! Whether display colors are written. #AUTO_COLORS writes them only if the
+  //! stream is a terminal.
+  ColorMode color_mode;
+  //! Timestamp format, as in set_time_format(). NULL = the Message Logger's
+  //! time format, "" = no timestamp.
+  const char *time_format;
+  LogRecordCallback callback;   //!< Function called with each message.
+  void *user_data;              //!< Pointer passed to the callback.
+} LogSinkConfiguration;
+
 //! \struct TimeFormat
 //! \brief Time formatting information for storing messages in log files.
 //!
@@ -248,6 +610,171 @@ typedef struct {
 
 // Public function prototypes:
 
+// Give the functions C linkage when the header is included by C++ code (see
+// message_logger.hpp):
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! \fn int add_log_sink(const LogSinkConfiguration *sink_configuration)
+//! \brief Attach a log sink to the Message Logger. Allocates resources,
+//! requiring a call to logger_module_clean_up() afterwards.
+//! \param sink_configuration Pointer to the sink's configuration.
+//! \return Returns the sink's identifier when successfully executed and -1 if
+//! an error occurs.
+//!
+//! This function attaches a log sink that writes messages, in adition to the
+//! terminal and the log file, according to a LogSinkConfiguration provided by
+//! the user. Up to #MAX_LOG_SINKS sinks may be attached, each with it's own
+//! stream or file, categories, colors and timestamp format. Each message's
+//! contents are formatted once and each distinct combination of colors and
+//! timestamp format is rendered once, no matter how many sinks use it.
+//!
+//! Sinks are written to with the Message Logger's lock held, as messages are
+//! logged or, if asynchronous logging is enabled, by the writer thread.
+//! Thread buffering does NOT apply to sinks. Files opened for sinks are NOT
+//! rotated.
+//!
+//! A callback sink hands each message to a LogRecordCallback as a
+//! LogRecordView, which points to the message's context and formatted
+//! contents in the Message Logger's buffers, so nothing is copied or rendered
+//! for it. Enable asynchronous logging to run the callbacks in the writer
+//! thread, away from the threads that log messages.
+//!
+//! If an error occurs when attaching the sink, this function will return -1
+//! and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to close the files opened for
+//! sinks. Streams provided by the user are only flushed.
+//!
+//! \par Usage example
+//! \code
+//! LogSinkConfiguration errors_sink = {
+//!   .file_name = "errors.log",
+//!   .file_mode = APPEND,
+//!   .category_mask = CATEGORY_MASK(ERROR_MSG)
+//! };
+//! configure_log_file("everything.log", APPEND);
+//! add_log_sink(&errors_sink);
+//! // Use the Message Logger normally...
+//! logger_module_clean_up();
+//! \endcode
+//!
+//! \par Callback sink example
+//! \code
+//! void ship_record(const LogRecordView *record, void *user_data) {
+//!   pipeline_push(user_data, record->body, record->body_length);
+//! }
+//!
+//! LogSinkConfiguration pipeline_sink = {
+//!   .category_mask = ALL_MESSAGE_CATEGORIES,
+//!   .callback = ship_record,
+//!   .user_data = pipeline
+//! };
+//! enable_async_logging(4096);
+//! add_log_sink(&pipeline_sink);
+//! \endcode
+int add_log_sink(const LogSinkConfiguration *sink_configuration);
+
+//! \fn int configure_binary_log_file(
+//!   const char *file_name,
+//!   LogFileMode file_mode
+//! )
+//! \brief Configure a binary log file to store the Message Logger's messages.
+//! Allocates resources, requiring a call to logger_module_clean_up()
+//! afterwards.
+//! \param file_name Name of the file used to log messages.
+//! \param file_mode Mode used for opening the log file.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to write any messages to
+//! a binary log file, instead of a regular log file. The messages' contents
+//! are NOT formatted when they are logged. Instead, each message stores an
+//! identifier of it's format string, it's timestamp, it's context and the raw
+//! bytes of it's arguments. Each format string is parsed and written to the
+//! file only the first time it is used, so logging a message only copies it's
+//! arguments. The binary log file is converted to the same text written to a
+//! regular log file by decode_binary_log_file() or by the msg-logger-decode
+//! program. Any regular or memory mapped log file is closed, and vice versa.
+//!
+//! Format strings are identified by their contents: each message hashes it's
+//! whole format string with FNV-1a and compares it with memcmp() against the
+//! recorded format with the same hash, so format strings built at runtime or
+//! reused buffers are fine, but long format strings cost more to look up. A
+//! copy of each recorded format string is kept until the file is closed.
+//! Messages whose format strings have a conversion that can't be recorded
+//! (e.g: "%n" or "%ls"), or that don't fit the cache of recorded formats, are
+//! formatted when they are logged and stored as text. Since string arguments are copied up to their null
+//! terminator or precision, the texts they point to may be freed right after
+//! the message is logged. Binary log files are NOT rotated and can only be
+//! decoded on machines with the same data type sizes and byte order.
+//!
+//! To move the formatting cost out of the program entirely, disable the
+//! terminal output with set_console_output().
+//!
+//! If an error occurs when configuring the log file, this function will return
+//! -1 and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to close the log file created.
+//!
+//! \par Usage example
+//! \code
+//! configure_binary_log_file("logger-test.bin", WRITE);
+//! set_console_output(0);
+//! // Use the Message Logger normally...
+//! logger_module_clean_up();
+//! decode_binary_log_file("logger-test.bin", stdout);
+//! \endcode
+int configure_binary_log_file(const char *file_name, LogFileMode file_mode);
+
+//! \fn int configure_log_durability(
+//!   const LogDurabilityPolicy *durability_policy
+//! )
+//! \brief Configure when the Message Logger's log file is synced to disk.
+//! Allocates resources, requiring a call to logger_module_clean_up()
+//! afterwards.
+//! \param durability_policy Pointer to the durability policy to be used. Must
+//! NOT be NULL.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to force the messages
+//! of it's log file to disk according to a LogDurabilityPolicy. Periodic and
+//! size based syncs are done by a background thread, which holds the Message
+//! Logger's lock only to flush the log file, so the threads that log messages
+//! never wait for the disk. Error messages are flushed and synced by the
+//! thread that logs them (or by the writer thread, if asynchronous logging is
+//! enabled), so the messages that explain a crash are on disk before the
+//! program continues, while other messages pay nothing. The policy applies to
+//! the current log file and any log file configured afterwards with
+//! configure_log_file(). Memory mapped and binary log files are NOT synced. By
+//! default, log files are never synced. Thread safety is enabled automatically
+//! if the policy needs the background thread.
+//!
+//! If an error occurs when configuring the durability policy, this function
+//! will return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to stop the background thread. The
+//! clean up also resets the durability policy.
+//!
+//! \par Usage example
+//! \code
+//! LogDurabilityPolicy durability_policy = {
+//!   .sync_interval = 1000,
+//!   .sync_size = 1024 * 1024,
+//!   .sync_errors = 1
+//! };
+//!
+//! configure_log_file("logger-test.log", APPEND);
+//! configure_log_durability(&durability_policy);
+//! \endcode
+int configure_log_durability(const LogDurabilityPolicy *durability_policy);
+
 //! \fn int configure_log_file(const char *file_name, LogFileMode file_mode)
 //! \brief Configure a log file to store the Message Logger's messages.
 //! Allocates resources, requiring a call to logger_module_clean_up()
@@ -275,23 +802,295 @@ typedef struct {
 //! \endcode
 int configure_log_file(const char *file_name, LogFileMode file_mode);
 
-//! \fn int enable_thread_safety()
-//! \brief Enable thread safety for the Message Logger's operations. Allocates
+//! \fn int configure_log_rotation(const LogRotationPolicy *rotation_policy)
+//! \brief Configure the rotation of the Message Logger's log file.
+//! \param rotation_policy Pointer to the rotation policy to be used. Must NOT
+//! be NULL.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to rotate it's log file,
+//! so log files don't grow indefinitely. When a condition of the
+//! LogRotationPolicy is met, the log file is closed, renamed to an archive
+//! according to the policy's #ArchiveNaming and a new log file is created with
+//! the original name. Archives beyond the policy's max_archives are deleted.
+//! The policy applies to the current log file and any log file configured
+//! afterwards with configure_log_file(). By default, log files are never
+//! rotated.
+//!
+//! The rotation conditions are checked against a count of the chars written
+//! to the log file and the time of each message, without querying the file
+//! system. When asynchronous logging is enabled, the rotation is done by the
+//! writer thread and the max file size is checked for each batch of messages
+//! written, instead of each message. Messages only wait for the log file to
+//! be renamed and replaced: a background thread closes the rotated log file,
+//! names the archive and deletes the old ones afterwards.
+//!
+//! If an error occurs when configuring the log rotation, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \par Usage example
+//! \code
+//! LogRotationPolicy rotation_policy = {
+//!   .max_file_size = 10 * 1024 * 1024,
+//!   .rotation_interval = 24 * 60 * 60,
+//!   .max_archives = 7,
+//!   .archive_naming = NUMBERED_ARCHIVES
+//! };
+//!
+//! configure_log_file("logger-test.log", APPEND);
+//! configure_log_rotation(&rotation_policy);
+//! \endcode
+int configure_log_rotation(const LogRotationPolicy *rotation_policy);
+
+//! \fn int configure_mapped_log_file(
+//!   const char *file_name,
+//!   LogFileMode file_mode,
+//!   size_t extent_size
+//! )
+//! \brief Configure a memory mapped log file to store the Message Logger's
+//! messages. Allocates resources, requiring a call to logger_module_clean_up()
+//! afterwards.
+//! \param file_name Name of the file used to log messages.
+//! \param file_mode Mode used for opening the log file.
+//! \param extent_size Char length by which the log file grows at once. Must
+//! NOT be zero.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to write any messages to
+//! a memory mapped log file, instead of a regular log file. The log file is
+//! allocated on disk in extents of extent_size chars and mapped into memory.
+//! Each message reserves it's space in the file with a single atomic operation
+//! and is copied directly into the mapping, without stdio buffering or system
+//! calls, so many threads can write their messages to the log file
+//! concurrently. Any regular log file configured with configure_log_file() is
+//! closed, and vice versa.
+//!
+//! Messages written to a memory mapped log file have the same format as the
+//! ones written to a regular log file. However, memory mapped log files are
+//! NOT rotated. The mapping is limited to #MAPPED_LOG_FILE_WINDOW chars, and
+//! messages beyond that limit are discarded.
+//!
+//! If an error occurs when configuring the log file, this function will return
+//! -1 and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to truncate the log file to the
+//! length of the messages written to it. If the program terminates before
+//! that, the end of the log file is padded with null characters.
+//!
+//! \par Usage example
+//! \code
+//! configure_mapped_log_file("logger-test.log", WRITE, 16 * 1024 * 1024);
+//! // Use the Message Logger normally...
+//! logger_module_clean_up();
+//! \endcode
+int configure_mapped_log_file(
+  const char *file_name,
+  LogFileMode file_mode,
+  size_t extent_size
+);
+
+//! \fn int decode_binary_log_file(const char *file_name, FILE *destination)
+//! \brief Convert a binary log file to the text of a regular log file.
+//! \param file_name Name of the binary log file to be decoded.
+//! \param destination File where the decoded messages are written. Must NOT
+//! be NULL.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function reads a binary log file written after a call to
+//! configure_binary_log_file() and formats each of it's messages with their
+//! recorded arguments, writing them to the destination file exactly as they
+//! would be written to a regular log file, with the time format that was
+//! configured when they were logged. It doesn't depend on any of the Message
+//! Logger's configurations and may be called by a separate program.
+//!
+//! If an error occurs when decoding the log file, including a truncated or
+//! corrupted log file, this function will return -1 and the Message Logger
+//! will print an error message explaining what went wrong. Any messages
+//! decoded before the error are still written.
+//!
+//! \par Usage example
+//! \code
+//! FILE *text_file = fopen("logger-test.log", "w");
+//! decode_binary_log_file("logger-test.bin", text_file);
+//! fclose(text_file);
+//! \endcode
+int decode_binary_log_file(const char *file_name, FILE *destination);
+
+//! \fn int dump_flight_recorder()
+//! \brief Write the messages kept by the flight recorder to the log file.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function writes, oldest first, the messages kept by the flight
+//! recorder of every thread that are not in the log file yet (e.g: because
+//! their category is disabled) to the configured log file, in the log file's
+//! format. Messages still pending for the asynchronous writer thread are
+//! written before them. Written messages are discarded from the flight
+//! recorder, so later dumps only write newer messages. The flight recorder is
+//! also dumped automatically right before an error message is written.
+//!
+//! If an error occurs when dumping the flight recorder, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \par Usage example
+//! \code
+//! enable_flight_recorder(1024);
+//! set_enabled_categories(CATEGORY_MASK(ERROR_MSG));
+//! info("Example", "Only written to the log file by a dump.\n");
+//! dump_flight_recorder();
+//! \endcode
+int dump_flight_recorder();
+
+//! \fn int enable_async_logging(unsigned int capacity)
+//! \brief Enable asynchronous logging with a dedicated writer thread.
+//! Allocates resources, requiring a call to logger_module_clean_up()
+//! afterwards.
+//! \param capacity Minimum number of messages that can be pending at once.
+//! Rounded up to the next power of two.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to hand every message
+//! over to a background writer thread instead of writing it to the terminal
+//! and log file on the calling thread. The calling thread only formats the
+//! message's contents and copies them into a bounded ring buffer, while the
+//! writer thread drains that buffer and writes many messages at once to the
+//! terminal and to the configured log file.
+//!
+//! Since the writer thread runs concurrently with the rest of the program,
+//! thread safety is enabled automatically if it wasn't enabled already. When
+//! the ring buffer is full, the calling thread waits for the writer thread to
+//! free a slot, so no messages are lost. A thread inside a batch (see
+//! begin_logger_batch()) holds the lock the writer thread needs, so it writes
+//! the oldest pending messages itself instead. Messages longer than
+//! #ASYNC_RECORD_SIZE are truncated.
+//!
+//! If an error occurs when enabling asynchronous logging, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \note Output written directly by the user (e.g: with printf) is NOT
+//! ordered with respect to asynchronously logged messages.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to write any pending messages, stop
+//! the writer thread and release the memory allocated for the ring buffer.
+//!
+//! \par Usage example
+//! \code
+//! enable_async_logging(4096);
+//! info("Example", "This message is written by the writer thread.\n");
+//! logger_module_clean_up();
+//! \endcode
+int enable_async_logging(unsigned int capacity);
+
+//! \fn int enable_flight_recorder(unsigned int capacity)
+//! \brief Enable the flight recorder, which keeps the last messages logged in
+//! memory. Allocates resources, requiring a call to logger_module_clean_up()
+//! afterwards.
+//! \param capacity Minimum number of messages kept at once by each thread.
+//! Rounded up to the next power of two.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function configures the Message Logger module to keep a copy of the
+//! last messages logged by each thread in a ring buffer of it's own, including
+//! the messages of disabled categories (see set_enabled_categories()). Right
+//! before an error message is written, and whenever dump_flight_recorder() is
+//! called, the kept messages that are not in the log file yet are written to
+//! it, so a program can run with quiet output and still have the context of
+//! each failure in it's log file, ahead of the failure itself. Messages removed at compile time (see
+//! MESSAGE_LOGGER_MIN_LEVEL) are NOT kept. Messages longer than
+//! #FLIGHT_RECORD_SIZE are truncated.
+//!
+//! Keeping a message takes no lock. Messages of enabled categories are
+//! formatted once for every output and the flight recorder, while messages of
+//! disabled categories are formatted straight into the ring buffer. The
+//! messages are rendered in the log file's format only when they are dumped.
+//!
+//! If an error occurs when enabling the flight recorder, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called to release the memory allocated
+//! for the ring buffers. Messages not dumped by then are discarded.
+//!
+//! \par Usage example
+//! \code
+//! configure_log_file("logger-test.log", APPEND);
+//! set_enabled_categories(CATEGORIES_FROM_LEVEL(LOGGER_LEVEL_WARNING));
+//! enable_flight_recorder(256);
+//! info("Example", "Written to the log file with the next error.\n");
+//! error("Example", "Something failed.\n");
+//! \endcode
+int enable_flight_recorder(unsigned int capacity);
+
+//! \fn int enable_thread_buffering(
+//!   size_t buffer_size,
+//!   unsigned int flush_interval
+//! )
+//! \brief Enable per-thread buffering of the logged messages. Allocates
 //! resources, requiring a call to logger_module_clean_up() afterwards.
+//! \param buffer_size Char length of the messages a thread buffers before
+//! they are written. Must NOT be zero.
+//! \param flush_interval Max milliseconds a thread keeps messages buffered
+//! when it logs another message. 0 = no time limit.
 //! \return Returns 0 when successfully executed and -1 if an error occurs.
 //!
+//! This function configures the Message Logger module to assemble each
+//! thread's messages in buffers owned by that thread, without taking the
+//! Message Logger's lock. A thread's buffered messages are written to the
+//! terminal and to the log file at once, taking the lock a single time, when
+//! they reach buffer_size chars, when the thread logs a message after
+//! flush_interval milliseconds have passed since it's last write, when the
+//! thread logs an error message and when the thread exits.
+//!
+//! Since each thread writes it's messages in batches, messages of different
+//! threads are NOT written in the order they were logged. Each message in the
+//! log file keeps the timestamp of when it was logged, so include sub-second
+//! digits in the time format (see set_time_format()) to order them. Thread
+//! safety is enabled automatically if it wasn't enabled already. Thread
+//! buffering has no effect while asynchronous logging is enabled, and binary
+//! log files are written without it.
+//!
+//! If an error occurs when enabling thread buffering, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \note After the Message Logger module is no longer used, the function
+//! logger_module_clean_up() must be called, after every other thread that
+//! uses the Message Logger stopped, to write the messages still buffered and
+//! release the threads' buffers.
+//!
+//! \par Usage example
+//! \code
+//! enable_thread_buffering(64 * 1024, 100);
+//! // Create multiple threads to use the Message Logger...
+//! logger_module_clean_up();
+//! \endcode
+int enable_thread_buffering(size_t buffer_size, unsigned int flush_interval);
+
+//! \fn int enable_thread_safety()
+//! \brief Enable thread safety for the Message Logger's operations.
+//! \return Always returns 0.
+//!
 //! This function configures the Message Logger module to enable thread safety
 //! when logging messages or executing other logger operations. This allows the
 //! logger to be utilized in a multi-threaded environment with the pthreads
 //! library without the nuissance of race conditions or other problems.
 //!
-//! If an error occurs when enabling thread safety, this function will return
-//! -1 and the Message Logger will print an error message explaining what went
-//! wrong.
+//! The Message Logger's lock is statically initialized, so this function
+//! allocates nothing, can't fail and may be called at any time, even after
+//! other threads were created. Where the C library tracks whether the program
+//! is single-threaded (glibc 2.32 or newer), thread safety is also enabled
+//! automatically once the program creates it's first thread, so
+//! single-threaded programs never take the lock. Calling this function is
+//! still needed elsewhere.
 //!
-//! \note After the Message Logger module is no longer used, the function
-//! logger_module_clean_up() must be called to release the memory allocated for
-//! the thread-safety data structures utilized.
+//! \note logger_module_clean_up() disables the thread safety enabled by this
+//! function.
 //!
 //! \par Usage example
 //! \code
@@ -308,6 +1107,21 @@ int configure_log_file(const char *file_name, LogFileMode file_mode);
 //! \endcode
 int enable_thread_safety();
 
+//! \fn unsigned int get_enabled_categories()
+//! \brief Get which message categories are logged by the Message Logger.
+//! \return Returns the mask of the enabled categories.
+//!
+//! This function returns the mask of message categories currently enabled in
+//! the Message Logger. Test if a #MessageCategory is enabled with the
+//! #CATEGORY_MASK macro.
+//!
+//! \par Usage example
+//! \code
+//! if(get_enabled_categories() & CATEGORY_MASK(INFO_MSG))
+//!   info("Example", "Info messages are enabled!\n");
+//! \endcode
+unsigned int get_enabled_categories();
+
 //! \fn int get_logger_msg_colors(
 //!   DisplayColors* display_colors_destination,
 //!   MessageCategory requested_category
@@ -401,6 +1215,162 @@ int get_logger_tag_colors(
 //! \endcode
 int get_time_format(TimeFormat *time_format_destination);
 
+//! \fn int install_crash_handlers()
+//! \brief Write the Message Logger's pending messages if the program crashes.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function installs handlers for the SIGABRT, SIGBUS, SIGFPE, SIGILL and
+//! SIGSEGV signals that write the messages the Message Logger hasn't written
+//! yet before the program dies: the text the Message Logger buffers for the
+//! log file and the binary log file, the messages queued for the asynchronous
+//! writer thread and the messages kept in thread buffers. The
+//! handlers only use async-signal-safe functions, so the queued messages are
+//! written with their time in seconds since the epoch instead of the time
+//! format and without colors. In a JSON Lines log file (see
+//! set_log_file_format()), they are written as the usual JSON objects, whose
+//! timestamps are already in seconds since the epoch. Then the signal's previous action takes place
+//! (e.g: the default core dump or the program's own handler). An alternate
+//! signal stack is set up for the calling thread, if it has none, so crashes
+//! caused by a stack overflow in that thread are also handled. Calling this
+//! function again does nothing.
+//!
+//! Pending messages are written on a best effort basis: the handlers do NOT
+//! take the Message Logger's lock, the buffers of the C library (e.g: the
+//! terminal's and the log sink streams') are NOT touched, memory mapped log
+//! files and log sinks are NOT written to, the batch being written by the
+//! writer thread when the crash happens may be lost and buffers being changed
+//! by other threads are skipped.
+//!
+//! If an error occurs when installing the handlers, this function will return
+//! -1 and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \note The function logger_module_clean_up() restores the signal actions
+//! replaced by the handlers.
+//!
+//! \par Usage example
+//! \code
+//! enable_async_logging(1024);
+//! install_crash_handlers();
+//! \endcode
+int install_crash_handlers();
+
+//! \fn int remove_log_sink(int sink_id)
+//! \brief Detach a log sink from the Message Logger.
+//! \param sink_id Identifier returned by add_log_sink().
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function stops writing messages to a log sink, closing it's file if
+//! it was opened by the Message Logger or flushing it's stream otherwise. The
+//! sink's identifier may be reused by sinks attached afterwards.
+//!
+//! If an error occurs when detaching the sink, this function will return -1
+//! and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \par Usage example
+//! \code
+//! int sink_id = add_log_sink(&stderr_sink);
+//! // ...
+//! remove_log_sink(sink_id);
+//! \endcode
+int remove_log_sink(int sink_id);
+
+//! \fn int set_color_mode(ColorMode color_mode)
+//! \brief Set whether the Message Logger displays colors on the terminal.
+//! \param color_mode Mode that determines if colors are displayed.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function sets the #ColorMode used by the Message Logger. When colors
+//! are not displayed, messages are written as plain text, with their context,
+//! tag and contents but without any ANSI escape codes, and the functions
+//! color_text(), color_background() and reset_colors() have no effect. In the
+//! #AUTO_COLORS mode, which is the default, colors are only displayed if the
+//! standard output is a terminal when this function is called or, if it is
+//! never called, when the first message is logged.
+//!
+//! If an error occurs when setting the color mode, this function will return
+//! -1 and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \par Usage example
+//! \code
+//! set_color_mode(NEVER_COLORS);
+//! error("Example", "This error message is written without colors.\n");
+//! \endcode
+int set_color_mode(ColorMode color_mode);
+
+//! \fn int set_console_output(int enabled)
+//! \brief Set whether the Message Logger writes messages to the terminal.
+//! \param enabled Whether messages are written to the standard output.
+//! \return Always returns 0.
+//!
+//! This function enables or disables the terminal output of the logging
+//! functions, which is enabled by default. While it is disabled, messages are
+//! only written to the configured log file, and their contents are only
+//! formatted if the log file needs them as text. Functions that write colors
+//! to the terminal (e.g: color_text()) are not affected.
+//!
+//! \par Usage example
+//! \code
+//! configure_log_file("logger-test.log", WRITE);
+//! set_console_output(0);
+//! info("Example", "This message is only written to the log file.\n");
+//! \endcode
+int set_console_output(int enabled);
+
+//! \fn int set_enabled_categories(unsigned int category_mask)
+//! \brief Set which message categories are logged by the Message Logger.
+//! \param category_mask Mask of the categories enabled, built with
+//! #CATEGORY_MASK and #ALL_MESSAGE_CATEGORIES.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function enables the message categories in the mask and disables all
+//! others. Calls to the logging function of a disabled category return
+//! immediately, before their arguments are processed and without using the
+//! thread safety lock, so disabled categories cost a single check. The mask
+//! may be changed at any time, from any thread, even while other threads are
+//! logging messages. By default, every category is enabled.
+//!
+//! If an error occurs when setting the enabled categories, this function will
+//! return -1 and the Message Logger will print an error message explaining
+//! what went wrong.
+//!
+//! \par Usage example
+//! \code
+//! // Only log warnings and errors:
+//! set_enabled_categories(
+//!   CATEGORY_MASK(ERROR_MSG) | CATEGORY_MASK(WARNING_MSG)
+//! );
+//!
+//! // Log every category again:
+//! set_enabled_categories(ALL_MESSAGE_CATEGORIES);
+//! \endcode
+int set_enabled_categories(unsigned int category_mask);
+
+//! \fn int set_log_file_format(LogFileFormat file_format)
+//! \brief Set the format in which messages are written to the log file.
+//! \param file_format Format of the log file's messages.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function determines whether messages are written to the log file and
+//! the memory mapped log file as text lines (the default) or as JSON Lines.
+//! JSON Lines messages are encoded without allocating memory and without
+//! colors, and their timestamp is in seconds since the epoch, with nanosecond
+//! digits, instead of the time format. Log sinks and binary log files are NOT
+//! affected.
+//!
+//! If an error occurs when setting the format, this function will return -1
+//! and the Message Logger will print an error message explaining what went
+//! wrong.
+//!
+//! \par Usage example
+//! \code
+//! configure_log_file("logger-test.jsonl", APPEND);
+//! set_log_file_format(JSON_LOG_FILE);
+//! \endcode
+int set_log_file_format(LogFileFormat file_format);
+
 //! \fn int set_logger_msg_colors(
 //!   MessageCategory message_category,
 //!   const DisplayColors *assigned_colors
@@ -410,15 +1380,17 @@ int get_time_format(TimeFormat *time_format_destination);
 //! \param message_category Category of message whose display colors are being
 //! set.
 //! \param assigned_colors Pointer to the display colors being copied to a
-//! message category of the \link #logger_color_pallet Message Logger's
-//! color pallet. \endlink
+//! message category of the Message Logger's color pallet.
 //! \return Returns 0 when successfully executed and -1 if an error occurs.
 //!
 //! This function sets the display colors for a given #MessageCategory in the
-//! \link #logger_color_pallet Message Logger's color pallet. \endlink This is
-//! done by copying the information from a valid, non-NULL DisplayColors
-//! pointer provided by the user to an index of the \link
-//! LoggerColorPallet::message_colors message_colors \endlink array.
+//! Message Logger's color pallet. This is done by copying the information from
+//! a valid, non-NULL DisplayColors pointer provided by the user to an index of
+//! the \link LoggerColorPallet::message_colors message_colors \endlink array.
+//!
+//! The color pallet is replaced as a whole, so messages being logged by other
+//! threads are displayed either with the old or the new colors, never with a
+//! mix of both, and are not blocked while the colors change.
 //!
 //! If an error occurs when setting the display colors, this function will
 //! return -1 and the Message Logger will print an error message explaining
@@ -445,15 +1417,13 @@ int set_logger_msg_colors(
 //! category.
 //! \param tag_category Category of tag whose display colors are being set.
 //! \param assigned_colors Pointer to the display colors being copied to a tag
-//! category of the \link #logger_color_pallet Message Logger's
-//! color pallet. \endlink
+//! category of the Message Logger's color pallet.
 //! \return Returns 0 when successfully executed and -1 if an error occurs.
 //!
-//! This function sets the display colors for a given #TagCategory in the \link
-//! #logger_color_pallet Message Logger's color pallet. \endlink This is done
-//! by copying the information from a valid, non-NULL DisplayColors pointer
-//! provided by the user to an index of the \link LoggerColorPallet::tag_colors
-//! tag_colors \endlink array.
+//! This function sets the display colors for a given #TagCategory in the
+//! Message Logger's color pallet. This is done by copying the information from
+//! a valid, non-NULL DisplayColors pointer provided by the user to an index of
+//! the \link LoggerColorPallet::tag_colors tag_colors \endlink array.
 //!
 //! If an error occurs when setting the display colors, this function will
 //! return -1 and the Message Logger will print an error message explaining
@@ -479,11 +1449,15 @@ int set_logger_tag_colors(
 //! \return Returns 0 when successfully executed and -1 if an error occurs.
 //!
 //! This function sets the \link TimeFormat::string_representation
-//! string_representation \endlink in the \link #logger_time_fmt
-//! Message Logger's time format. \endlink This format is used when
-//! timestamping messages saved to a log file, if one is configured. The time
-//! format information is copied from a valid, non-NULL pointer provided by the
-//! user.
+//! string_representation \endlink in the Message Logger's time format. This
+//! format is used when timestamping messages saved to a log file, if one is
+//! configured. The time format information is copied from a valid, non-NULL
+//! pointer provided by the user.
+//!
+//! The time format follows the conversions supported by strftime(). In
+//! addition, it may contain a single "%N" conversion, replaced by the
+//! nanoseconds of the message's time, or a single "%<digits>N" conversion,
+//! replaced by that many sub-second digits (e.g: "%3N" for milliseconds).
 //!
 //! If an error occurs when setting the time format, this function will return
 //! -1 and the Message Logger will print an error message explaining what went
@@ -492,9 +1466,38 @@ int set_logger_tag_colors(
 //! \par Usage example
 //! \code
 //! set_time_format("%c");
+//! set_time_format("%H:%M:%S.%3N");
 //! \endcode
 int set_time_format(const char *new_format);
 
+//! \fn void begin_logger_batch()
+//! \brief Start a batch of the Message Logger's operations that no other
+//! thread can interleave with.
+//!
+//! This function acquires the Message Logger's lock for the calling thread
+//! until end_logger_batch() is called. While in a batch, other threads that
+//! use the Message Logger wait, so several messages, colors and any output
+//! written directly by the user's code (e.g: with printf) stay together. The
+//! logging functions called inside a batch don't lock again, so each batch
+//! locks the Message Logger exactly once. Batches may be nested, in which case
+//! the lock is only released by the outermost end_logger_batch().
+//!
+//! Without thread safety enabled, this function has no effect.
+//!
+//! \warning Every call to this function must be matched by a call to
+//! end_logger_batch() in the same thread. Prefer the #LOGGER_BATCH macro,
+//! which makes that pairing explicit.
+//!
+//! \par Usage example
+//! \code
+//! begin_logger_batch();
+//! color_text(BLU);
+//! printf("This line will NOT be interleaved with other messages!\n");
+//! reset_colors();
+//! end_logger_batch();
+//! \endcode
+void begin_logger_batch();
+
 //! \fn void color_background(Color p_color)
 //! \brief Changes the terminal text's background color to a specific #Color.
 //! \param p_color Color to be applied to the terminal text's background.
@@ -505,6 +1508,9 @@ int set_time_format(const char *new_format);
 //! the middle of a text line, any existing background color will be cleared
 //! after the cursor's position.
 //!
+//! \note This function has no effect if colors are disabled with
+//! set_color_mode().
+//!
 //! \par Usage example
 //! \code
 //! color_background(B_GRN);
@@ -519,12 +1525,32 @@ void color_background(Color p_color);
 //! the user. Bright colors are accompanied by a bold font weight, while the
 //! other font colors are accompanied by a regular font weight.
 //!
+//! \note This function has no effect if colors are disabled with
+//! set_color_mode().
+//!
 //! \par Usage example
 //! \code
 //! color_text(BLU);
 //! \endcode
 void color_text(Color p_color);
 
+//! \fn void end_logger_batch()
+//! \brief End a batch of the Message Logger's operations started by
+//! begin_logger_batch().
+//!
+//! This function releases the Message Logger's lock once every nested batch
+//! of the calling thread has ended, letting other threads use the Message
+//! Logger again. Without thread safety enabled, this function has no effect.
+//!
+//! \par Usage example
+//! \code
+//! begin_logger_batch();
+//! info("Example", "First line of the batch.\n");
+//! info("Example", "Second line of the batch.\n");
+//! end_logger_batch();
+//! \endcode
+void end_logger_batch();
+
 //! \fn void error(const char *context, const char *format, ...)
 //! \brief Log an error message using the Message Logger.
 //! \param context Caller context where message originated. Pass a NULL pointer
@@ -548,6 +1574,43 @@ void color_text(Color p_color);
 //! \endcode
 void error(const char *context, const char *format, ...);
 
+//! \fn void error_fields(
+//!   const char *context,
+//!   const LogField *fields,
+//!   size_t num_of_fields,
+//!   const char *format,
+//!   ...
+//! )
+//! \brief Log an error message with typed key-value fields.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields. May be NULL if num_of_fields
+//! is 0.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format, as in error().
+//! \param ... Arguments to substitute in message's text format.
+//!
+//! This function logs the same message as error(), together with the
+//! fields, which are encoded once and written after the message's contents
+//! (see LogField). Use the #LOG_FIELDS macro to pass the fields. Binary log
+//! files record the message without it's fields.
+//!
+//! \par Usage example
+//! \code
+//! error_fields(
+//!   "Example",
+//!   LOG_FIELDS(LOG_STRING("table", "users"), LOG_INT("code", code)),
+//!   "Query failed.\n"
+//! );
+//! \endcode
+void error_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+);
+
 //! \fn void info(const char *context, const char *format, ...)
 //! \brief Log an info message using the Message Logger.
 //! \param context Caller context where message originated. Pass a NULL pointer
@@ -571,46 +1634,59 @@ void error(const char *context, const char *format, ...);
 //! \endcode
 void info(const char *context, const char *format, ...);
 
-//! \fn void lock_logger_recursive_mutex()
-//! \brief Lock the \link #logger_recursive_mutex Message Logger's recursive
-//! mutex lock. \endlink This prevents any other thread from using the Message
-//! Logger. Thread safety MUST be enabled.
+//! \fn void info_fields(
+//!   const char *context,
+//!   const LogField *fields,
+//!   size_t num_of_fields,
+//!   const char *format,
+//!   ...
+//! )
+//! \brief Log an info message with typed key-value fields.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields. May be NULL if num_of_fields
+//! is 0.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format, as in info().
+//! \param ... Arguments to substitute in message's text format.
+//!
+//! This function logs the same message as info(), together with the
+//! fields, which are encoded once and written after the message's contents
+//! (see LogField). Use the #LOG_FIELDS macro to pass the fields. Binary log
+//! files record the message without it's fields.
 //!
-//! This function locks the recursive mutex lock utilized by the Message Logger
-//! to ensure thread safety. When the recursive mutex is locked by a thread,
-//! the other threads will not be able to lock it as well and will be suspended
-//! until the mutex is unlocked. This ensures that no race conditions take
-//! place. The recursive nature of the mutex lock allows a thread to lock it
-//! more than once without being suspended.
+//! \par Usage example
+//! \code
+//! info_fields(
+//!   "Example",
+//!   LOG_FIELDS(LOG_STRING("user", user_name), LOG_UINT("attempt", attempt)),
+//!   "Login request received.\n"
+//! );
+//! \endcode
+void info_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+);
+
+//! \fn void lock_logger_recursive_mutex()
+//! \brief Start a batch of the Message Logger's operations. Deprecated: use
+//! begin_logger_batch() instead. Thread safety MUST be enabled.
 //!
-//! Since most of the Message Logger's functions already handle the recursive
-//! mutex lock when thread safety is enabled, the main purpose of this function
-//! is to allow the user's code to avoid race conditions with the logger. For
-//! example, if the user wishes to print information on the terminal without
-//! using the Message Logger, this function will guarantee that the logger
-//! doesn't try to do the same from another thread while the user's code is
-//! running.
+//! This function is kept for compatibility and calls begin_logger_batch().
+//! The Message Logger's lock is no longer a recursive mutex, but batches may
+//! still be nested.
 //!
-//! \warning For this function to work properly, the function
-//! enable_thread_safety() must have been called to configure the recursive
-//! mutex lock. Otherwise, this function will emit a warning and will have NO
-//! EFFECT.
+//! \warning If thread safety is not enabled, this function will emit a
+//! warning and will have NO EFFECT.
 //!
 //! \par Usage example
 //! \code
-//! // In the main thread, before creating other threads, enable thread safety.
-//! enable_thread_safety();
-//!
-//! // ...
-//! // After creating multiple threads, in one of the threads.
 //! lock_logger_recursive_mutex();
 //! printf("This message will NOT interfere with the logger's operations!\n");
 //! unlock_logger_recursive_mutex();
-//!
-//! // ...
-//! // In the main thread, after other threads have been joined (and the
-//! // logger is no longer used), call the clean up function.
-//! logger_module_clean_up();
 //! \endcode
 void lock_logger_recursive_mutex();
 
@@ -620,12 +1696,17 @@ void lock_logger_recursive_mutex();
 //! This function cleans up any memory or other resources utilized by the
 //! Message Logger. Ideally, it should always be called after the logger is not
 //! longer utilized. If this function is called and the logger is utilized
-//! afterwards, some configurations such as the log file and thread safety will
-//! NOT work.
+//! afterwards, some configurations such as the log file, thread safety and
+//! asynchronous logging will NOT work.
+//!
+//! If asynchronous logging is enabled, this function waits for the writer
+//! thread to write every pending message before cleaning up the log file. If
+//! thread buffering is enabled, the messages still buffered by any thread are
+//! written.
 //!
-//! \warning This function NEEDS to be called when a log file is configured or
-//! when thread safety is enabled. Failure to do so might result in an
-//! incomplete log file or memory leaks.
+//! \warning This function NEEDS to be called when a log file is configured,
+//! when thread safety is enabled or when asynchronous logging is enabled.
+//! Failure to do so might result in an incomplete log file or memory leaks.
 //!
 //! \par Usage example
 //! \code
@@ -657,6 +1738,43 @@ void logger_module_clean_up();
 //! \endcode
 void message(const char *context, const char *format, ...);
 
+//! \fn void message_fields(
+//!   const char *context,
+//!   const LogField *fields,
+//!   size_t num_of_fields,
+//!   const char *format,
+//!   ...
+//! )
+//! \brief Log a default message with typed key-value fields.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields. May be NULL if num_of_fields
+//! is 0.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format, as in message().
+//! \param ... Arguments to substitute in message's text format.
+//!
+//! This function logs the same message as message(), together with the
+//! fields, which are encoded once and written after the message's contents
+//! (see LogField). Use the #LOG_FIELDS macro to pass the fields. Binary log
+//! files record the message without it's fields.
+//!
+//! \par Usage example
+//! \code
+//! message_fields(
+//!   "Example",
+//!   LOG_FIELDS(LOG_DOUBLE("load", load_average)),
+//!   "Load average sampled.\n"
+//! );
+//! \endcode
+void message_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+);
+
 //! \fn void reset_background_color()
 //! \brief Reset the terminal's text background color to the default color.
 //!
@@ -684,6 +1802,9 @@ void reset_background_color();
 //! the font weight and any other characteristics configured using ANSI escape
 //! codes.
 //!
+//! \note This function has no effect if colors are disabled with
+//! set_color_mode().
+//!
 //! \par Usage example
 //! \code
 //! // Change various text configurations.
@@ -692,13 +1813,12 @@ void reset_background_color();
 void reset_colors();
 
 //! \fn void reset_logger_colors()
-//! \brief Reset the \link #logger_color_pallet Message Logger's color pallet
-//! \endlink colors to their defaults.
+//! \brief Reset the Message Logger's color pallet colors to their defaults.
 //!
-//! This function resets the \link #logger_color_pallet Message Logger's color
-//! pallet \endlink by setting it's \link LoggerColorPallet::message_colors
-//! message_colors \endlink and \link LoggerColorPallet::tag_colors tag_colors
-//! \endlink to the default values specifed in the macros
+//! This function resets the Message Logger's color pallet by setting it's
+//! \link LoggerColorPallet::message_colors message_colors \endlink and \link
+//! LoggerColorPallet::tag_colors tag_colors \endlink to the default values
+//! specifed in the macros
 //! #DEFAULT_LOGGER_MESSAGE_COLORS and #DEFAULT_LOGGER_TAG_COLORS. ALL the
 //! values are reset, so any changes made with calls to the functions
 //! \link set_logger_msg_colors() set_logger_msg_colors \endlink and \link
@@ -751,47 +1871,57 @@ void reset_text_color();
 //! \endcode
 void success(const char *context, const char *format, ...);
 
-//! \fn void unlock_logger_recursive_mutex()
-//! \brief Unlock the \link #logger_recursive_mutex Message Logger's recursive
-//! mutex lock \endlink, allowing other
-//! threads to use the Message Logger if no recursive locks remain. Thread
-//! safety MUST be enabled.
+//! \fn void success_fields(
+//!   const char *context,
+//!   const LogField *fields,
+//!   size_t num_of_fields,
+//!   const char *format,
+//!   ...
+//! )
+//! \brief Log a success message with typed key-value fields.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields. May be NULL if num_of_fields
+//! is 0.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format, as in success().
+//! \param ... Arguments to substitute in message's text format.
+//!
+//! This function logs the same message as success(), together with the
+//! fields, which are encoded once and written after the message's contents
+//! (see LogField). Use the #LOG_FIELDS macro to pass the fields. Binary log
+//! files record the message without it's fields.
 //!
-//! This function unlocks the recursive mutex lock utilized by the Message
-//! Logger to ensure thread safety. When the recursive mutex is locked by a
-//! thread, the other threads will not be able to lock it as well and will be
-//! suspended until the mutex is unlocked. This ensures that no race conditions
-//! take place. The recursive nature of the mutex lock allows a thread to lock
-//! it more than once without being suspended.
+//! \par Usage example
+//! \code
+//! success_fields(
+//!   "Example",
+//!   LOG_FIELDS(LOG_UINT("bytes", bytes_sent), LOG_DOUBLE("seconds", elapsed)),
+//!   "Upload finished.\n"
+//! );
+//! \endcode
+void success_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+);
+
+//! \fn void unlock_logger_recursive_mutex()
+//! \brief End a batch of the Message Logger's operations. Deprecated: use
+//! end_logger_batch() instead. Thread safety MUST be enabled.
 //!
-//! Since most of the Message Logger's functions already handle the recursive
-//! mutex lock when thread safety is enabled, the main purpose of this function
-//! is to allow the user's code to avoid race conditions with the logger. For
-//! example, if the user wishes to print information on the terminal without
-//! using the Message Logger, this function will allow the logger to resume
-//! it's operations in a thread safe manner after the user prints all
-//! information to the screen.
+//! This function is kept for compatibility and calls end_logger_batch().
 //!
-//! \warning For this function to work properly, the function
-//! enable_thread_safety() must have been called to configure the recursive
-//! mutex lock. Otherwise, this function will emit a warning and will have NO
-//! EFFECT.
+//! \warning If thread safety is not enabled, this function will emit a
+//! warning and will have NO EFFECT.
 //!
 //! \par Usage example
 //! \code
-//! // In the main thread, before creating other threads, enable thread safety.
-//! enable_thread_safety();
-//!
-//! // ...
-//! // After creating multiple threads, in one of the threads.
 //! lock_logger_recursive_mutex();
 //! printf("This message will NOT interfere with the logger's operations!\n");
 //! unlock_logger_recursive_mutex();
-//!
-//! // ...
-//! // In the main thread, after other threads have been joined (and the
-//! // logger is no longer used), call the clean up function.
-//! logger_module_clean_up();
 //! \endcode
 void unlock_logger_recursive_mutex();
 
@@ -818,4 +1948,104 @@ void unlock_logger_recursive_mutex();
 //! \endcode
 void warning(const char *context, const char *format, ...);
 
+//! \fn void warning_fields(
+//!   const char *context,
+//!   const LogField *fields,
+//!   size_t num_of_fields,
+//!   const char *format,
+//!   ...
+//! )
+//! \brief Log a warning message with typed key-value fields.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields. May be NULL if num_of_fields
+//! is 0.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format, as in warning().
+//! \param ... Arguments to substitute in message's text format.
+//!
+//! This function logs the same message as warning(), together with the
+//! fields, which are encoded once and written after the message's contents
+//! (see LogField). Use the #LOG_FIELDS macro to pass the fields. Binary log
+//! files record the message without it's fields.
+//!
+//! \par Usage example
+//! \code
+//! warning_fields(
+//!   "Example",
+//!   LOG_FIELDS(LOG_BOOL("cached", 0), LOG_UINT("retries", retries)),
+//!   "Cache miss, retrying.\n"
+//! );
+//! \endcode
+void warning_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Severity threshold front-ends:
+
+// When MESSAGE_LOGGER_MIN_LEVEL is defined, calls to logging functions below
+// the threshold are replaced by an expression that is never evaluated. The
+// arguments are still type checked inside sizeof, so variables only used by
+// removed calls don't cause unused variable warnings. The Message Logger's
+// source file defines MESSAGE_LOGGER_IMPLEMENTATION to keep the functions
+// themselves intact.
+#if defined(MESSAGE_LOGGER_MIN_LEVEL) && !defined(MESSAGE_LOGGER_IMPLEMENTATION)
+
+#ifdef __cplusplus
+
+//! \fn void logger_removed_call(const Call& call)
+//! \brief Stands for a C++ logging call removed by MESSAGE_LOGGER_MIN_LEVEL.
+//! \param call Lambda holding the removed call, which is never called.
+//!
+//! In C++, a removed call may be qualified by the message_logger namespace of
+//! message_logger.hpp, so it's replaced by a call to this function, which is
+//! also declared in that namespace, instead of a parenthesized expression.
+template<class Call>
+inline void logger_removed_call(const Call&) {}
+
+#define LOGGER_REMOVED_CALL(function, ...)                                    \
+  logger_removed_call([] { return sizeof(((::function)(__VA_ARGS__), 0)); })
+
+#else
+
+#define LOGGER_REMOVED_CALL(function, ...)                                    \
+  ((void) sizeof((function(__VA_ARGS__), 0)))
+
+#endif
+
+#if MESSAGE_LOGGER_MIN_LEVEL > LOGGER_LEVEL_INFO
+#define info(...) LOGGER_REMOVED_CALL(info, __VA_ARGS__)
+#define info_fields(...) LOGGER_REMOVED_CALL(info_fields, __VA_ARGS__)
+#endif
+
+#if MESSAGE_LOGGER_MIN_LEVEL > LOGGER_LEVEL_MESSAGE
+#define message(...) LOGGER_REMOVED_CALL(message, __VA_ARGS__)
+#define message_fields(...) LOGGER_REMOVED_CALL(message_fields, __VA_ARGS__)
+#endif
+
+#if MESSAGE_LOGGER_MIN_LEVEL > LOGGER_LEVEL_SUCCESS
+#define success(...) LOGGER_REMOVED_CALL(success, __VA_ARGS__)
+#define success_fields(...) LOGGER_REMOVED_CALL(success_fields, __VA_ARGS__)
+#endif
+
+#if MESSAGE_LOGGER_MIN_LEVEL > LOGGER_LEVEL_WARNING
+#define warning(...) LOGGER_REMOVED_CALL(warning, __VA_ARGS__)
+#define warning_fields(...) LOGGER_REMOVED_CALL(warning_fields, __VA_ARGS__)
+#endif
+
+#if MESSAGE_LOGGER_MIN_LEVEL > LOGGER_LEVEL_ERROR
+#define error(...) LOGGER_REMOVED_CALL(error, __VA_ARGS__)
+#define error_fields(...) LOGGER_REMOVED_CALL(error_fields, __VA_ARGS__)
+#endif
+
+#endif
+
 #endif // MESSAGE_LOGGER_H_
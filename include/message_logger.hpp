@@ -0,0 +1,567 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Message Logger module - C++ header file.
+//! \file message_logger.hpp
+//! \author André Filipe Caldas Laranjeira
+//! \brief Message Logger module - C++ header file.
+//!
+//! The Message Logger module C++ header file contains type safe front-ends for
+//! the logging functions, for programs written in C++. Each front-end checks
+//! it's format string against the types of it's arguments at compile time and
+//! then logs the message with the matching function of message_logger.h, so
+//! both APIs share the same configuration and outputs and can be mixed freely.
+//!
+//! The front-ends require C++17. The format strings are only checked by
+//! compilers with C++20's consteval, which also requires the format strings to
+//! be known at compile time. Format strings only known at runtime must be
+//! logged with the C functions.
+//!
+//! Calls below MESSAGE_LOGGER_MIN_LEVEL are removed by the macros of
+//! message_logger.h, whether they call the C functions or the front-ends, so
+//! their arguments are never evaluated and their format strings aren't
+//! checked. The front-ends' definitions and their calls of the C functions
+//! parenthesize the functions' names, which keeps those macros from replacing
+//! them.
+
+// Define guard:
+#ifndef MESSAGE_LOGGER_HPP_
+#define MESSAGE_LOGGER_HPP_
+
+// Includes:
+#include "message_logger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Macros:
+
+//! \def MESSAGE_LOGGER_CONSTEVAL
+//! \brief Specifier of the constructors of message_logger::FormatString,
+//! which check format strings at compile time where consteval is supported.
+#if defined(__cpp_consteval)
+#define MESSAGE_LOGGER_CONSTEVAL consteval
+#define MESSAGE_LOGGER_CHECKS_FORMATS
+#else
+#define MESSAGE_LOGGER_CONSTEVAL constexpr
+#endif
+
+namespace message_logger {
+
+#if defined(MESSAGE_LOGGER_MIN_LEVEL) && !defined(MESSAGE_LOGGER_IMPLEMENTATION)
+// Calls removed by MESSAGE_LOGGER_MIN_LEVEL keep their namespace qualifier:
+using ::logger_removed_call;
+#endif
+
+namespace detail {
+
+// Private type definitions:
+
+//! \enum ArgumentClass
+//! \brief Class of the values a printf conversion accepts as it's argument.
+enum class ArgumentClass {
+  INTEGER,        //!< Integer or unscoped enumeration.
+  FLOATING,       //!< float or double.
+  LONG_FLOATING,  //!< long double.
+  STRING,         //!< Null terminated string.
+  POINTER,        //!< Any other pointer.
+  OTHER           //!< Value that can't be logged.
+};
+
+//! \struct ArgumentType
+//! \brief Class and size of a logging function's argument, after the default
+//! argument promotions.
+struct ArgumentType {
+  ArgumentClass argument_class;   //!< Class of the argument.
+  std::size_t size;               //!< Size of the argument, in bytes.
+};
+
+//! \struct TypeIdentity
+//! \brief Keeps a template parameter from being deduced from an argument.
+template<class T>
+struct TypeIdentity {
+  using type = T;                 //!< The template parameter itself.
+};
+
+// Private functions:
+
+//! \fn ArgumentType argument_type<T>()
+//! \brief Classifies an argument of a logging function.
+//! \return Returns the argument's class and size.
+//!
+//! Integers smaller than int are promoted to int and float to double, as
+//! they are by a variadic function. Strings may be std::string objects, which
+//! are logged through their c_str().
+template<class T>
+constexpr ArgumentType argument_type() {
+
+  using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+  using Decayed = std::decay_t<Value>;
+
+  if constexpr(std::is_enum_v<Decayed>)
+    return argument_type<std::underlying_type_t<Decayed>>();
+
+  else if constexpr(std::is_integral_v<Decayed>)
+    return { ArgumentClass::INTEGER, sizeof(decltype(+Decayed())) };
+
+  else if constexpr(std::is_same_v<Decayed, long double>)
+    return { ArgumentClass::LONG_FLOATING, sizeof(long double) };
+
+  else if constexpr(std::is_floating_point_v<Decayed>)
+    return { ArgumentClass::FLOATING, sizeof(double) };
+
+  else if constexpr(
+    std::is_same_v<Decayed, char*> ||
+    std::is_same_v<Decayed, const char*> ||
+    std::is_same_v<Decayed, std::string>
+  )
+    return { ArgumentClass::STRING, sizeof(const char*) };
+
+  else if constexpr(
+    std::is_pointer_v<Decayed> ||
+    std::is_same_v<Decayed, std::nullptr_t>
+  )
+    return { ArgumentClass::POINTER, sizeof(void*) };
+
+  else
+    return { ArgumentClass::OTHER, sizeof(Decayed) };
+
+}
+
+//! \fn bool format_matches_arguments(
+//!   const char* format,
+//!   const ArgumentType* arguments,
+//!   std::size_t num_of_arguments
+//! )
+//! \brief Checks whether a format string consumes exactly some arguments.
+//! \param format Format string to be checked.
+//! \param arguments Types of the arguments, in order.
+//! \param num_of_arguments Number of arguments.
+//! \return Returns true if every conversion of the format string matches the
+//! type of it's argument and every argument is consumed, false otherwise.
+//!
+//! Integer conversions accept any integer with the size of their length
+//! modifier, regardless of it's signedness. "%n", wide characters and
+//! positional arguments are never accepted, since they can't be checked.
+constexpr bool format_matches_arguments(
+  const char* format,
+  const ArgumentType* arguments,
+  std::size_t num_of_arguments
+) {
+
+  char length_modifier = '\0';
+  std::size_t argument = 0, integer_size = sizeof(int);
+
+  while(*format != '\0') {
+
+    if(*format++ != '%')
+      continue;
+
+    if(*format == '%') {
+      format++;
+      continue;
+    }
+
+    // Flags:
+    while(
+      *format == '-' || *format == '+' || *format == ' ' || *format == '#' ||
+      *format == '0' || *format == '\''
+    )
+      format++;
+
+    // Width, which may be an int argument:
+    if(*format == '*') {
+
+      if(
+        argument == num_of_arguments ||
+        arguments[argument].argument_class != ArgumentClass::INTEGER ||
+        arguments[argument].size != sizeof(int)
+      )
+        return false;
+
+      argument++;
+      format++;
+
+    }
+
+    else
+      while(*format >= '0' && *format <= '9')
+        format++;
+
+    // Positional arguments can't be checked in order:
+    if(*format == '$')
+      return false;
+
+    // Precision, which may be an int argument:
+    if(*format == '.') {
+
+      format++;
+
+      if(*format == '*') {
+
+        if(
+          argument == num_of_arguments ||
+          arguments[argument].argument_class != ArgumentClass::INTEGER ||
+          arguments[argument].size != sizeof(int)
+        )
+          return false;
+
+        argument++;
+        format++;
+
+      }
+
+      else
+        while(*format >= '0' && *format <= '9')
+          format++;
+
+    }
+
+    // Length modifier:
+    length_modifier = '\0';
+    integer_size = sizeof(int);
+
+    if(*format == 'h') {
+      format += format[1] == 'h' ? 2 : 1;
+      length_modifier = 'h';
+    }
+
+    else if(*format == 'l' && format[1] == 'l') {
+      format += 2;
+      length_modifier = 'q';
+      integer_size = sizeof(long long);
+    }
+
+    else if(*format == 'l' || *format == 'q' || *format == 'L') {
+      length_modifier = *format++;
+      integer_size = length_modifier == 'l' ? sizeof(long) : sizeof(long long);
+    }
+
+    else if(*format == 'j' || *format == 'z' || *format == 't') {
+      length_modifier = *format++;
+      integer_size =
+        length_modifier == 'j' ? sizeof(intmax_t) :
+        length_modifier == 'z' ? sizeof(std::size_t) :
+        sizeof(std::ptrdiff_t);
+    }
+
+    // Conversions without arguments:
+    if(*format == 'm') {
+      format++;
+      continue;
+    }
+
+    if(argument == num_of_arguments)
+      return false;
+
+    // Conversion character:
+    switch(*format++) {
+
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        if(
+          arguments[argument].argument_class != ArgumentClass::INTEGER ||
+          arguments[argument].size != integer_size
+        )
+          return false;
+
+        break;
+
+      case 'c':
+        if(
+          length_modifier != '\0' ||
+          arguments[argument].argument_class != ArgumentClass::INTEGER ||
+          arguments[argument].size != sizeof(int)
+        )
+          return false;
+
+        break;
+
+      case 'a':
+      case 'A':
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+        if(
+          length_modifier == 'L' ?
+            arguments[argument].argument_class !=
+              ArgumentClass::LONG_FLOATING :
+            (length_modifier != '\0' && length_modifier != 'l') ||
+            arguments[argument].argument_class != ArgumentClass::FLOATING
+        )
+          return false;
+
+        break;
+
+      case 's':
+        if(
+          length_modifier != '\0' ||
+          arguments[argument].argument_class != ArgumentClass::STRING
+        )
+          return false;
+
+        break;
+
+      case 'p':
+        if(
+          length_modifier != '\0' || (
+            arguments[argument].argument_class != ArgumentClass::POINTER &&
+            arguments[argument].argument_class != ArgumentClass::STRING
+          )
+        )
+          return false;
+
+        break;
+
+      default:
+        return false;
+
+    }
+
+    argument++;
+
+  }
+
+  return argument == num_of_arguments;
+
+}
+
+//! \fn void format_string_does_not_match_arguments()
+//! \brief Called by a message_logger::FormatString constructor when it's
+//! format string doesn't match the arguments.
+//!
+//! This function is deliberately not constexpr, so calling it while a format
+//! string is checked at compile time stops the compilation, pointing at the
+//! logging call with the wrong format string.
+inline void format_string_does_not_match_arguments() {}
+
+//! \fn const char* logged_argument(const std::string& argument)
+//! \brief Passes a std::string to a logging function as a C string.
+//! \param argument String to be logged.
+//! \return Returns the string's C string.
+inline const char* logged_argument(const std::string& argument) {
+  return argument.c_str();
+}
+
+//! \fn const T& logged_argument(const T& argument)
+//! \brief Passes any other argument to a logging function as is.
+//! \param argument Argument to be logged.
+//! \return Returns the argument itself.
+template<class T>
+constexpr const T& logged_argument(const T& argument) {
+  return argument;
+}
+
+} // namespace detail
+
+// Type definitions:
+
+//! \class FormatString
+//! \brief A format string checked against the types of it's arguments.
+//!
+//! Format strings are implicitly converted to this type by the logging
+//! functions of this header. Where consteval is supported, the conversion
+//! happens at compile time and a format string that doesn't match it's
+//! arguments (e.g: "%d" with a double, "%s" with an int or a missing argument)
+//! stops the compilation.
+template<class... Args>
+class FormatString {
+
+  public:
+
+    //! \brief Checks a format string against the arguments' types.
+    //! \param text Format string to be checked.
+    template<std::size_t N>
+    MESSAGE_LOGGER_CONSTEVAL FormatString(const char (&text)[N]) :
+      text_(text) {
+
+      constexpr detail::ArgumentType arguments[] = {
+        detail::argument_type<Args>()...,
+        { detail::ArgumentClass::OTHER, 0 }
+      };
+
+#ifdef MESSAGE_LOGGER_CHECKS_FORMATS
+      if(
+        !detail::format_matches_arguments(text, arguments, sizeof...(Args))
+      )
+        detail::format_string_does_not_match_arguments();
+#else
+      (void) arguments;
+#endif
+
+    }
+
+    //! \brief Returns the format string.
+    constexpr const char* c_str() const {
+      return text_;
+    }
+
+  private:
+
+    //! \brief Format string.
+    const char *text_;
+
+};
+
+//! \typedef CheckedFormat
+//! \brief The #FormatString type of some logging function's arguments.
+//!
+//! The arguments' types are only deduced from the arguments themselves, not
+//! from the format string.
+template<class... Args>
+using CheckedFormat =
+  FormatString<typename detail::TypeIdentity<Args>::type...>;
+
+// Function definitions:
+
+//! \fn void error(
+//!   const char* context,
+//!   CheckedFormat<Args...> format,
+//!   const Args&... args
+//! )
+//! \brief Logs an error message with a format string checked at compile time.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function logs the message with the error() function of
+//! message_logger.h. std::string arguments may be logged with "%s".
+//!
+//! \par Usage example
+//! \code
+//! std::string table = "users";
+//! message_logger::error("db", "Query on %s failed: %d\n", table, code);
+//! \endcode
+template<class... Args>
+inline void (error)(
+  const char* context,
+  CheckedFormat<Args...> format,
+  const Args&... args
+) {
+  (::error)(context, format.c_str(), detail::logged_argument(args)...);
+}
+
+//! \fn void info(
+//!   const char* context,
+//!   CheckedFormat<Args...> format,
+//!   const Args&... args
+//! )
+//! \brief Logs an info message with a format string checked at compile time.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function logs the message with the info() function of
+//! message_logger.h. std::string arguments may be logged with "%s".
+//!
+//! \par Usage example
+//! \code
+//! message_logger::info("cache", "%zu entries loaded.\n", entries.size());
+//! \endcode
+template<class... Args>
+inline void (info)(
+  const char* context,
+  CheckedFormat<Args...> format,
+  const Args&... args
+) {
+  (::info)(context, format.c_str(), detail::logged_argument(args)...);
+}
+
+//! \fn void message(
+//!   const char* context,
+//!   CheckedFormat<Args...> format,
+//!   const Args&... args
+//! )
+//! \brief Logs a default message with a format string checked at compile
+//! time.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function logs the message with the message() function of
+//! message_logger.h. std::string arguments may be logged with "%s".
+//!
+//! \par Usage example
+//! \code
+//! message_logger::message(nullptr, "Hello, %s!\n", user_name);
+//! \endcode
+template<class... Args>
+inline void (message)(
+  const char* context,
+  CheckedFormat<Args...> format,
+  const Args&... args
+) {
+  (::message)(context, format.c_str(), detail::logged_argument(args)...);
+}
+
+//! \fn void success(
+//!   const char* context,
+//!   CheckedFormat<Args...> format,
+//!   const Args&... args
+//! )
+//! \brief Logs a success message with a format string checked at compile
+//! time.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function logs the message with the success() function of
+//! message_logger.h. std::string arguments may be logged with "%s".
+//!
+//! \par Usage example
+//! \code
+//! message_logger::success("backup", "Saved in %.2f seconds.\n", seconds);
+//! \endcode
+template<class... Args>
+inline void (success)(
+  const char* context,
+  CheckedFormat<Args...> format,
+  const Args&... args
+) {
+  (::success)(context, format.c_str(), detail::logged_argument(args)...);
+}
+
+//! \fn void warning(
+//!   const char* context,
+//!   CheckedFormat<Args...> format,
+//!   const Args&... args
+//! )
+//! \brief Logs a warning message with a format string checked at compile
+//! time.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function logs the message with the warning() function of
+//! message_logger.h. std::string arguments may be logged with "%s".
+//!
+//! \par Usage example
+//! \code
+//! message_logger::warning("disk", "Only %d%% free.\n", free_percentage);
+//! \endcode
+template<class... Args>
+inline void (warning)(
+  const char* context,
+  CheckedFormat<Args...> format,
+  const Args&... args
+) {
+  (::warning)(context, format.c_str(), detail::logged_argument(args)...);
+}
+
+} // namespace message_logger
+
+#endif // MESSAGE_LOGGER_HPP_
@@ -0,0 +1,83 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Regression check of the Message Logger module's batches with asynchronous
+// logging.
+
+// Includes:
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "message_logger.h"
+
+// Macros:
+#define LOG_FILE_NAME "batch-check.log"
+#define MESSAGES 1000
+#define RING_CAPACITY 16
+#define TIMEOUT_SECONDS 10
+
+// Main function:
+int main() {
+
+  // Variable declaration:
+  char line[256];
+  const char *contents;
+  FILE *log;
+  int i, number;
+
+  // A deadlock kills the check instead of hanging it:
+  alarm(TIMEOUT_SECONDS);
+
+  // A batch larger than the ring buffer fills it while the logger lock, which
+  // the writer thread needs, is held:
+  set_console_output(0);
+
+  if(
+    configure_log_file(LOG_FILE_NAME, WRITE) != 0 ||
+    enable_async_logging(RING_CAPACITY) != 0
+  )
+    return 1;
+
+  begin_logger_batch();
+
+  for(i = 0; i < MESSAGES; i++)
+    info("Batch check", "Batched message %d.\n", i);
+
+  end_logger_batch();
+  logger_module_clean_up();
+
+  // Every message must be in the log file, in order:
+  if((log = fopen(LOG_FILE_NAME, "r")) == NULL) {
+    perror("Could not open the log file");
+    return 1;
+  }
+
+  for(i = 0; fgets(line, sizeof(line), log) != NULL; i++) {
+    contents = strstr(line, "Batched message ");
+
+    if(
+      contents == NULL ||
+      sscanf(contents, "Batched message %d.", &number) != 1 ||
+      number != i
+    )
+      break;
+  }
+
+  fclose(log);
+  remove(LOG_FILE_NAME);
+
+  if(i != MESSAGES) {
+    fprintf(stderr, "Batch check failed at message %d of %d.\n", i, MESSAGES);
+    return 1;
+  }
+
+  printf(
+    "Batch check passed: %d messages with a %d slot ring.\n",
+    i,
+    RING_CAPACITY
+  );
+
+  return 0;
+
+}
@@ -0,0 +1,439 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Benchmark program for the Message Logger module.
+
+// Includes:
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "message_logger.h"
+
+// Macros:
+#define DEFAULT_MESSAGES_PER_THREAD 10000
+#define DEFAULT_THREAD_NUM 4
+#define FUNCTION_NUM 5
+#define LOG_TARGET_NUM 4
+#define PAYLOAD_SIZE_NUM 3
+
+// Type definitions:
+typedef void (*LoggingFunction)(const char*, const char*, ...);
+
+typedef struct {
+  LoggingFunction function;
+  int thread_id;
+  unsigned int messages;
+  long long *latencies;
+  const char *payload;
+} ThreadArgs;
+
+// Auxiliary constants:
+const static char *function_names[FUNCTION_NUM] = {
+  "message",
+  "error",
+  "info",
+  "success",
+  "warning"
+};
+
+const static LoggingFunction functions[FUNCTION_NUM] = {
+  message,
+  error,
+  info,
+  success,
+  warning
+};
+
+// A NULL file name means no log file is configured:
+const static char *log_target_names[LOG_TARGET_NUM] = {
+  "none",
+  "dev_null",
+  "tmpfs",
+  "disk"
+};
+
+const static char *log_target_files[LOG_TARGET_NUM] = {
+  NULL,
+  "/dev/null",
+  "/dev/shm/msg-logger-bench.log",
+  "msg-logger-bench.log"
+};
+
+// Payloads logged into a JSON Lines log file, like the SQL and request dumps
+// logged by services, to measure the JSON escaping of long messages:
+const static size_t payload_sizes[PAYLOAD_SIZE_NUM] = { 1024, 4096, 16384 };
+
+const static char payload_pattern[] =
+  "SELECT \"id\", \"name\", \"email\" FROM \"users\" WHERE \"created_at\" > "
+  "'2019-01-01' AND \"status\" IN ('active', 'pending')\n\tORDER BY \"id\" "
+  "LIMIT 100; -- C:\\data\\export.csv\n";
+
+// Auxiliary variables:
+static pthread_barrier_t start_barrier;
+
+// Auxiliary function prototypes:
+int compare_latencies(const void *a, const void *b);
+long long elapsed_ns(const struct timespec *start, const struct timespec *end);
+int log_target_available(int log_target);
+void log_timed_messages(ThreadArgs *thread_args);
+int parse_count(const char *text, unsigned int max, unsigned int *count);
+void remove_log_target(int log_target);
+int run_benchmark(
+  FILE *results,
+  int function_index,
+  int thread_safety,
+  int log_target,
+  int thread_num,
+  unsigned int messages,
+  const char *payload
+);
+void* thread_benchmark(void *args);
+
+// Main function:
+int main(int argc, char **argv) {
+
+  // Variable declaration:
+  char *payload;
+  FILE *results;
+  int function_index, log_target, results_fd, thread_num, thread_safety;
+  size_t i, payload_index;
+  unsigned int max_threads, messages;
+
+  max_threads = DEFAULT_THREAD_NUM;
+  messages = DEFAULT_MESSAGES_PER_THREAD;
+
+  if(
+    argc > 3 ||
+    (argc > 1 && parse_count(argv[1], INT_MAX, &max_threads) != 0) ||
+    (argc > 2 && parse_count(argv[2], UINT_MAX, &messages) != 0)
+  ) {
+    fprintf(stderr, "Usage: %s [max_threads] [messages_per_thread]\n", argv[0]);
+    return 1;
+  }
+
+  // The logger writes to the standard output, so the results are written to
+  // the original standard output and the logger's output is discarded:
+  fflush(stdout);
+  results_fd = dup(STDOUT_FILENO);
+
+  if(results_fd < 0 || (results = fdopen(results_fd, "w")) == NULL) {
+    perror("Could not duplicate the standard output");
+    return 1;
+  }
+
+  if(freopen("/dev/null", "w", stdout) == NULL) {
+    perror("Could not redirect the standard output");
+    return 1;
+  }
+
+  fprintf(
+    results,
+    "function,thread_safety,log_file,threads,messages,seconds,msgs_per_sec,"
+    "p50_ns,p99_ns,p999_ns\n"
+  );
+
+  // Once the program creates a thread, the logger takes it's lock in every
+  // call, so the single thread runs are done on the main thread, with thread
+  // safety disabled and enabled, before any thread is created:
+  for(log_target = 0; log_target < LOG_TARGET_NUM; log_target++) {
+
+    if(!log_target_available(log_target))
+      continue;
+
+    for(function_index = 0; function_index < FUNCTION_NUM; function_index++)
+      for(thread_safety = 0; thread_safety <= 1; thread_safety++)
+        run_benchmark(
+          results,
+          function_index,
+          thread_safety,
+          log_target,
+          1,
+          messages,
+          NULL
+        );
+
+    remove_log_target(log_target);
+
+  }
+
+  // Log long payloads into a JSON Lines log file, discarded in /dev/null:
+  set_log_file_format(JSON_LOG_FILE);
+
+  for(payload_index = 0; payload_index < PAYLOAD_SIZE_NUM; payload_index++) {
+
+    payload = malloc(payload_sizes[payload_index] + 1);
+
+    if(payload == NULL) {
+      fprintf(stderr, "Could not allocate the benchmark payload!\n");
+      break;
+    }
+
+    for(i = 0; i < payload_sizes[payload_index]; i++)
+      payload[i] = payload_pattern[i % (sizeof(payload_pattern) - 1)];
+
+    payload[payload_sizes[payload_index]] = '\0';
+
+    // The info function is the third one:
+    run_benchmark(results, 2, 0, 1, 1, messages, payload);
+    free(payload);
+
+  }
+
+  set_log_file_format(TEXT_LOG_FILE);
+
+  // The other runs log from created threads, which need thread safety:
+  for(log_target = 0; log_target < LOG_TARGET_NUM; log_target++) {
+
+    if(!log_target_available(log_target))
+      continue;
+
+    for(function_index = 0; function_index < FUNCTION_NUM; function_index++)
+      for(thread_num = 2; thread_num <= (int) max_threads; thread_num++)
+        run_benchmark(
+          results,
+          function_index,
+          1,
+          log_target,
+          thread_num,
+          messages,
+          NULL
+        );
+
+    remove_log_target(log_target);
+
+  }
+
+  fclose(results);
+
+  return 0;
+
+}
+
+// Auxiliary functions:
+int compare_latencies(const void *a, const void *b) {
+
+  long long first = *((const long long*) a);
+  long long second = *((const long long*) b);
+
+  return (first > second) - (first < second);
+
+}
+
+long long elapsed_ns(const struct timespec *start, const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1000000000LL +
+    (end->tv_nsec - start->tv_nsec);
+}
+
+int log_target_available(int log_target) {
+
+  // The tmpfs target is skipped on systems without /dev/shm:
+  return log_target_files[log_target] == NULL ||
+    strncmp(log_target_files[log_target], "/dev/shm/", 9) != 0 ||
+    access("/dev/shm", W_OK) == 0;
+
+}
+
+void log_timed_messages(ThreadArgs *thread_args) {
+
+  // Variable declaration:
+  char thread_context[20];
+  struct timespec end, start;
+  unsigned int i;
+
+  sprintf(thread_context, "Thread %d", thread_args->thread_id);
+
+  // Time each call individually:
+  for(i = 0; i < thread_args->messages; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(thread_args->payload != NULL)
+      thread_args->function(thread_context, "%s\n", thread_args->payload);
+
+    else
+      thread_args->function(
+        thread_context,
+        "Benchmark message number %u with a value of %d!\n",
+        i + 1,
+        thread_args->thread_id * 1000
+      );
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    thread_args->latencies[i] = elapsed_ns(&start, &end);
+  }
+
+}
+
+int parse_count(const char *text, unsigned int max, unsigned int *count) {
+
+  char *end;
+  unsigned long value;
+
+  // Reject signs, which strtoul() would accept, empty texts, trailing chars,
+  // zero and values that don't fit:
+  if(!isdigit((unsigned char) text[0]))
+    return -1;
+
+  errno = 0;
+  value = strtoul(text, &end, 10);
+
+  if(errno != 0 || *end != '\0' || value == 0 || value > max)
+    return -1;
+
+  *count = (unsigned int) value;
+
+  return 0;
+
+}
+
+void remove_log_target(int log_target) {
+
+  // Remove the generated log file:
+  if(
+    log_target_files[log_target] != NULL &&
+    strcmp(log_target_files[log_target], "/dev/null") != 0
+  )
+    remove(log_target_files[log_target]);
+
+}
+
+int run_benchmark(
+  FILE *results,
+  int function_index,
+  int thread_safety,
+  int log_target,
+  int thread_num,
+  unsigned int messages,
+  const char *payload
+) {
+
+  // Variable declaration:
+  char function_name[32];
+  double seconds;
+  int i;
+  long long *latencies;
+  pthread_t *thread_ids;
+  size_t total;
+  struct timespec end, start;
+  ThreadArgs *thread_args;
+
+  total = (size_t) thread_num * messages;
+  latencies = malloc(total * sizeof(long long));
+  thread_ids = malloc(thread_num * sizeof(pthread_t));
+  thread_args = malloc(thread_num * sizeof(ThreadArgs));
+
+  if(latencies == NULL || thread_ids == NULL || thread_args == NULL) {
+    fprintf(stderr, "Could not allocate benchmark buffers!\n");
+    free(latencies);
+    free(thread_ids);
+    free(thread_args);
+    return -1;
+  }
+
+  // Configure the logger:
+  if(thread_safety)
+    enable_thread_safety();
+
+  if(log_target_files[log_target] != NULL)
+    configure_log_file(log_target_files[log_target], WRITE);
+
+  for(i = 0; i < thread_num; i++) {
+    thread_args[i].function = functions[function_index];
+    thread_args[i].thread_id = i + 1;
+    thread_args[i].messages = messages;
+    thread_args[i].latencies = latencies + (size_t) i * messages;
+    thread_args[i].payload = payload;
+  }
+
+  // A single thread logs from the main thread, without creating any thread:
+  if(thread_num == 1) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    log_timed_messages(&thread_args[0]);
+  }
+
+  else {
+
+    pthread_barrier_init(&start_barrier, NULL, thread_num + 1);
+
+    // Create threads:
+    for(i = 0; i < thread_num; i++)
+      pthread_create(&thread_ids[i], NULL, thread_benchmark, &thread_args[i]);
+
+    // Start every thread at once and wait for them to finish. The threads are
+    // held by the barrier until we reach it, so the clock is read before:
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_barrier_wait(&start_barrier);
+
+    for(i = 0; i < thread_num; i++)
+      pthread_join(thread_ids[i], NULL);
+
+    pthread_barrier_destroy(&start_barrier);
+
+  }
+
+  // Flush any buffered output so it is accounted for:
+  fflush(stdout);
+  logger_module_clean_up();
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  // Report the results. Payload runs are named after their payload's size:
+  seconds = elapsed_ns(&start, &end) / 1e9;
+
+  if(payload != NULL)
+    snprintf(
+      function_name,
+      sizeof(function_name),
+      "%s_json_%zu",
+      function_names[function_index],
+      strlen(payload)
+    );
+
+  else
+    snprintf(
+      function_name,
+      sizeof(function_name),
+      "%s",
+      function_names[function_index]
+    );
+
+  qsort(latencies, total, sizeof(long long), compare_latencies);
+
+  fprintf(
+    results,
+    "%s,%s,%s,%d,%zu,%.6f,%.0f,%lld,%lld,%lld\n",
+    function_name,
+    thread_safety ? "on" : "off",
+    log_target_names[log_target],
+    thread_num,
+    total,
+    seconds,
+    total / seconds,
+    latencies[total / 2],
+    latencies[total * 99 / 100],
+    latencies[total * 999 / 1000]
+  );
+  fflush(results);
+
+  // Free allocated resources:
+  free(latencies);
+  free(thread_ids);
+  free(thread_args);
+
+  return 0;
+
+}
+
+void* thread_benchmark(void *args) {
+
+  pthread_barrier_wait(&start_barrier);
+  log_timed_messages((ThreadArgs*) args);
+
+  // Finish execution:
+  pthread_exit((void *) 0);
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Binary log file decoder for the Message Logger module.
+
+// Includes:
+#include <stdio.h>
+
+#include "message_logger.h"
+
+// Main function:
+int main(int argc, char **argv) {
+
+  // Variable declaration:
+  FILE *destination = stdout;
+  int result;
+
+  if(argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s binary_log_file [text_log_file]\n", argv[0]);
+    return 1;
+  }
+
+  // Write the decoded messages to the standard output by default:
+  if(argc == 3 && (destination = fopen(argv[2], "w")) == NULL) {
+    perror("Could not create the text log file");
+    return 1;
+  }
+
+  result = decode_binary_log_file(argv[1], destination);
+
+  if(destination != stdout)
+    fclose(destination);
+
+  return result == 0 ? 0 : 1;
+
+}
@@ -0,0 +1,213 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Check of the Message Logger module's message formatting against the C
+// library's snprintf().
+
+// Includes:
+// The formatting function is private to the module, so the module is compiled
+// into the check instead of linked to it:
+#include "message_logger.c"
+
+#include <float.h>
+#include <stdint.h>
+
+// Macros:
+#define DEFAULT_CASES 200000
+#define FORMAT_SIZE 32
+#define TEXT_SIZE 512
+
+// Auxiliary constants:
+const static double edge_values[] = {
+  0.0, -0.0, 0.5, -0.5, 1.5, 2.5, 0.125, 0.375, 9.5, 0.05, 0.15, 0.25, 0.35,
+  0.45, 1.005, 2.675, 9.9995, 99.995, 0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0,
+  123456789.123456789, 4503599627370495.5, 9007199254740993.0, 1e15, 1e16,
+  1e17, 1e18, 1.8446744073709552e19, 1e20, 1e22, 1e300, DBL_MAX, -DBL_MAX,
+  DBL_MIN, -DBL_MIN, DBL_EPSILON, 4.9406564584124654e-324, 1e-5, 1e-10,
+  5e-18, 4.9999999999999996e-18, 0.99999999999999989, 0.9999999999999999,
+  3.14159265358979323846, -2.71828182845904523536
+};
+
+// Auxiliary variables:
+static uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+// Auxiliary function prototypes:
+int check_double(double value, int precision, int width, const char *flags);
+int check_format(size_t text_size, const char *format, ...);
+double random_double();
+uint64_t random_number();
+
+// Main function:
+int main(int argc, char **argv) {
+
+  // Variable declaration:
+  double special_values[4];
+  int failures = 0, precision;
+  size_t i, num_of_cases = DEFAULT_CASES;
+  uint64_t flags;
+
+  if(
+    argc > 2 ||
+    (argc == 2 && (num_of_cases = strtoul(argv[1], NULL, 10)) == 0)
+  ) {
+    fprintf(stderr, "Usage: %s [cases]\n", argv[0]);
+    return 1;
+  }
+
+  special_values[0] = NAN;
+  special_values[1] = -NAN;
+  special_values[2] = INFINITY;
+  special_values[3] = -INFINITY;
+
+  // Every precision the fast path formats and a few past it, which fall back
+  // to vsnprintf(), for each edge case:
+  for(precision = 0; precision <= MAX_FIXED_PRECISION + 3; precision++) {
+
+    for(i = 0; i < sizeof(edge_values) / sizeof(double); i++) {
+      failures += check_double(edge_values[i], precision, 0, "");
+      failures += check_double(-edge_values[i], precision, 0, "");
+      failures += check_double(edge_values[i], precision, 30, "0");
+      failures += check_double(edge_values[i], precision, 30, "-");
+    }
+
+    for(i = 0; i < sizeof(special_values) / sizeof(double); i++) {
+      failures += check_double(special_values[i], precision, 0, "");
+      failures += check_double(special_values[i], precision, 8, "0");
+    }
+
+  }
+
+  // Random values, precisions, widths and flags:
+  for(i = 0; i < num_of_cases && failures < 20; i++) {
+    flags = random_number();
+    failures += check_double(
+      random_double(),
+      (int) (flags % (MAX_FIXED_PRECISION + 4)),
+      (flags >> 8) % 4 == 0 ? (int) ((flags >> 16) % 40) : 0,
+      (flags >> 24) % 3 == 0 ? "0" : (flags >> 24) % 3 == 1 ? "-" : ""
+    );
+  }
+
+  if(failures > 0) {
+    fprintf(stderr, "Format check failed in %d cases.\n", failures);
+    return 1;
+  }
+
+  printf(
+    "Format check passed: %zu random cases and the edge cases.\n",
+    num_of_cases
+  );
+
+  return 0;
+
+}
+
+// Auxiliary functions:
+int check_double(double value, int precision, int width, const char *flags) {
+
+  char format[FORMAT_SIZE];
+  int failures = 0;
+  size_t text_size;
+
+  // The text's storage is sometimes too short, to check the truncation:
+  text_size = random_number() % 4 == 0 ? random_number() % 48 : TEXT_SIZE;
+
+  if(width > 0)
+    snprintf(format, sizeof(format), "<%%%s%d.%df>", flags, width, precision);
+
+  else
+    snprintf(format, sizeof(format), "<%%%s.%df>", flags, precision);
+
+  failures += check_format(text_size, format, value);
+  failures += check_format(text_size, "<%.*f>", precision, value);
+
+  return failures;
+
+}
+
+int check_format(size_t text_size, const char *format, ...) {
+
+  char expected[TEXT_SIZE], text[TEXT_SIZE];
+  int expected_length, length;
+  va_list args, args_copy;
+
+  va_start(args, format);
+  va_copy(args_copy, args);
+  expected_length = vsnprintf(expected, text_size, format, args);
+  length = format_message_text(
+    text_size > 0 ? text : NULL,
+    text_size,
+    format,
+    args_copy
+  );
+  va_end(args_copy);
+  va_end(args);
+
+  if(
+    length == expected_length &&
+    (text_size == 0 || strcmp(text, expected) == 0)
+  )
+    return 0;
+
+  va_start(args, format);
+  vsnprintf(expected, sizeof(expected), format, args);
+  va_end(args);
+
+  fprintf(
+    stderr,
+    "Mismatch for \"%s\" in %zu chars: expected %d \"%s\", got %d \"%.*s\".\n",
+    format,
+    text_size,
+    expected_length,
+    text_size > 0 ? expected : "",
+    length,
+    text_size > 0 ? (int) strlen(text) : 0,
+    text
+  );
+
+  return 1;
+
+}
+
+double random_double() {
+
+  double value;
+  uint64_t bits = random_number();
+
+  switch(bits % 4) {
+
+    // Any bits, including subnormals, infinities and NaNs:
+    case 0:
+      bits = random_number();
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+
+    // Binary fractions, which are exact ties when rounded:
+    case 1:
+      return (double) (int64_t) (random_number() % 2000001 - 1000000) /
+        (double) (1ULL << (random_number() % 20));
+
+    // Decimal looking values, like the ones usually logged:
+    case 2:
+      return (double) (int64_t) (random_number() % 20000001 - 10000000) /
+        pow(10, (double) (random_number() % 10));
+
+    // Values of any magnitude the fast path formats:
+    default:
+      return ((double) random_number() / (double) UINT64_MAX - 0.5) *
+        pow(10, (double) (random_number() % 44) - 24);
+
+  }
+
+}
+
+uint64_t random_number() {
+
+  // A fixed seed xorshift, so a failure can be reproduced:
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+
+  return random_state;
+
+}
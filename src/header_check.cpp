@@ -0,0 +1,38 @@
+// Copyright (c) 2019 André Filipe Caldas Laranjeira
+// MIT License
+
+// Compilation check of the Message Logger module's C++ header.
+
+// Includes:
+#include <string>
+
+#include "message_logger.hpp"
+
+// Auxiliary function definitions:
+
+// Only compiled, never run: it uses every front-end, the C functions and
+// their severity threshold macros. Defining MESSAGE_LOGGER_BAD_FORMAT adds a
+// call whose format string doesn't match it's arguments, which must NOT
+// compile where format strings are checked.
+void check_logging_calls(const std::string& table, int code, double seconds) {
+
+  // C++ front-ends:
+  message_logger::error("db", "Query on %s failed: %d\n", table, code);
+  message_logger::info("db", "%zu chars, %p.\n", table.size(), &code);
+  message_logger::message(nullptr, "Hello, %s!\n", "world");
+  message_logger::success("backup", "Saved in %.2f seconds.\n", seconds);
+  message_logger::warning("disk", "Only %d%% free.\n", code);
+
+  // C functions:
+  error("db", "Query on %s failed: %d\n", table.c_str(), code);
+  info("db", "%f\n", seconds);
+  message(nullptr, "Plain message.\n");
+  success("backup", "Done.\n");
+  warning("disk", "Low space.\n");
+  info_fields("db", nullptr, 0, "Query took %f seconds.\n", seconds);
+
+#ifdef MESSAGE_LOGGER_BAD_FORMAT
+  message_logger::error("db", "Query failed: %d\n", table);
+#endif
+
+}
@@ -11,8 +11,519 @@
 //! private state variables.
 
 // Includes:
+
+// Keep the logging functions intact regardless of MESSAGE_LOGGER_MIN_LEVEL:
+#define MESSAGE_LOGGER_IMPLEMENTATION
+
+// Provide the adaptive mutex type where the C library supports it:
+#define _GNU_SOURCE
 #include "message_logger.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <limits.h>
+#include <math.h>
+#include <sched.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Detect whether the program is still single-threaded where the C library
+// tells it:
+#if defined(__has_include)
+#if __has_include(<sys/single_threaded.h>)
+#include <sys/single_threaded.h>
+#define LOGGER_DETECTS_THREADS
+#endif
+#endif
+
+// Scan texts with x86 vector instructions, chosen at runtime, unless they are
+// disabled with -DMESSAGE_LOGGER_NO_SIMD:
+#if                                                                            \
+  (defined(__x86_64__) || defined(__i386__)) &&                                \
+  defined(__GNUC__) &&                                                         \
+  !defined(MESSAGE_LOGGER_NO_SIMD)
+#include <immintrin.h>
+#define LOGGER_USES_X86_SIMD
+#endif
+
+// Private macros:
+
+//! \def BINARY_FORMAT_CACHE_SIZE
+//! \brief Number of format strings that can be recorded in a binary log file.
+//!
+//! Must be a power of two. Messages with format strings beyond this limit are
+//! stored in the binary log file as text.
+#define BINARY_FORMAT_CACHE_SIZE 512
+
+//! \def BINARY_LOG_MAGIC
+//! \brief Text that starts every binary log file.
+#define BINARY_LOG_MAGIC "MSGLOGB1"
+
+//! \def MAX_BINARY_CONVERSIONS
+//! \brief Max number of conversions with arguments in a recorded format
+//! string.
+#define MAX_BINARY_CONVERSIONS 16
+
+//! \def MAX_CONVERSION_LENGTH
+//! \brief Max char length of a conversion specification in a recorded format
+//! string (e.g: "%-08.3lf").
+#define MAX_CONVERSION_LENGTH 32
+
+//! \def MAX_FAST_FORMAT_WIDTH
+//! \brief Max width or precision of a conversion formatted without
+//! vsnprintf().
+#define MAX_FAST_FORMAT_WIDTH 9999
+
+//! \def MAX_FIXED_PRECISION
+//! \brief Max precision of a "%f" conversion formatted without vsnprintf().
+#define MAX_FIXED_PRECISION 17
+
+//! \def MAX_FIXED_FRACTION_BITS
+//! \brief Max number of fraction bits of a double formatted without
+//! vsnprintf().
+//!
+//! Each fraction digit is obtained by multiplying the fraction bits by 10, so
+//! they must leave 4 bits of room in a #FixedFraction.
+#ifdef __SIZEOF_INT128__
+#define MAX_FIXED_FRACTION_BITS 124
+#else
+#define MAX_FIXED_FRACTION_BITS 60
+#endif
+
+//! \def FORMAT_DIGITS_SIZE
+//! \brief Char length of the storage for the digits of a single formatted
+//! number.
+//!
+//! Fits a sign, the 20 digits of the largest integer, the point and
+//! #MAX_FIXED_PRECISION fraction digits.
+#define FORMAT_DIGITS_SIZE 48
+
+//! \def FILE_BUFFER_SIZE
+//! \brief Char length of the text kept by a #FileBuffer before it's written.
+#define FILE_BUFFER_SIZE 8192
+
+//! \def FLIGHT_RECORDER_FLAG
+//! \brief Bit of #logger_enabled_categories set while the flight recorder is
+//! enabled, above the bits of every #MessageCategory.
+#define FLIGHT_RECORDER_FLAG (ALL_MESSAGE_CATEGORIES + 1u)
+
+//! \def LINE_STORAGE_SIZE
+//! \brief Char length of the stack storage used to assemble a message.
+//!
+//! Messages are assembled in text buffers that start with this much storage in
+//! the stack and only grow into the heap for longer messages.
+#define LINE_STORAGE_SIZE 1024
+
+//! \def MAX_SCRATCH_BODY_SIZE
+//! \brief Max char length of the storage a thread keeps to format message
+//! contents.
+//!
+//! Storage grown beyond this by a very long message is freed once the
+//! message is logged, instead of being kept by the thread.
+#define MAX_SCRATCH_BODY_SIZE (256 * 1024)
+
+//! \def TIMESTAMP_CACHE_SIZE
+//! \brief Number of time formats whose timestamps each thread caches.
+//!
+//! The log file and each log sink may use different time formats, so each
+//! thread keeps a few timestamp caches instead of reformatting the timestamp
+//! every time the time format alternates.
+#define TIMESTAMP_CACHE_SIZE 4
+
+//! \def CATEGORY_NEEDED(category)
+//! \brief Whether messages of a #MessageCategory must be handled, either
+//! because the category is enabled or because the flight recorder keeps every
+//! message.
+//!
+//! The flight recorder's flag shares #logger_enabled_categories with the
+//! categories, so calls of disabled categories cost a single relaxed load. It
+//! is enough, since the mask is only a filter and doesn't protect any other
+//! data.
+#define CATEGORY_NEEDED(category) (                                           \
+  atomic_load_explicit(&logger_enabled_categories, memory_order_relaxed) &     \
+  (CATEGORY_MASK(category) | FLIGHT_RECORDER_FLAG)                             \
+)
+
+//! \def CRASH_SIGNAL_STACK_SIZE
+//! \brief Char length of the alternate stack used by the crash handlers.
+//!
+//! A crash caused by a stack overflow can only be handled on another stack.
+#define CRASH_SIGNAL_STACK_SIZE (64 * 1024)
+
+//! \def CRASH_LOCK_ATTEMPTS
+//! \brief Number of times a crash handler tries to take a crash lock, a
+//! millisecond apart, before skipping the text it protects.
+//!
+//! The crashing thread itself may hold the lock, so it's never waited for
+//! indefinitely.
+#define CRASH_LOCK_ATTEMPTS 10
+
+//! \def NUM_OF_CRASH_SIGNALS
+//! \brief Number of fatal signals handled by the crash handlers.
+#define NUM_OF_CRASH_SIGNALS 5
+
+//! \def DISPLAY_PREFIX_SIZE
+//! \brief Char length of the storage for a DisplayPrefix's text.
+//!
+//! The longest prefix is made of the longest text color escape code, the
+//! longest background color escape code and the clear line escape code.
+#define DISPLAY_PREFIX_SIZE 32
+
+//! \def ESCAPE_CODE(code)
+//! \brief Initializes an EscapeCode with a string literal and it's length.
+#define ESCAPE_CODE(code) { .text = code, .length = sizeof(code) - 1 }
+
+// Private type definitions:
+
+//! \enum ArgumentType
+//! \brief Type of the argument consumed by a printf conversion.
+//!
+//! Determines how a conversion's argument is read from a va_list and stored
+//! in a binary log file. Integer arguments are stored with 64 bits and cast
+//! back to their original type when decoded.
+typedef enum {
+  NO_ARGUMENT,            //!< No argument (e.g: "%%").
+  INT_ARGUMENT,           //!< int, or a smaller integer promoted to int.
+  LONG_ARGUMENT,          //!< long or unsigned long.
+  LONG_LONG_ARGUMENT,     //!< long long or unsigned long long.
+  INTMAX_ARGUMENT,        //!< intmax_t or uintmax_t.
+  SIZE_ARGUMENT,          //!< size_t.
+  PTRDIFF_ARGUMENT,       //!< ptrdiff_t.
+  DOUBLE_ARGUMENT,        //!< double, or a float promoted to double.
+  LONG_DOUBLE_ARGUMENT,   //!< long double.
+  STRING_ARGUMENT,        //!< Null terminated string.
+  POINTER_ARGUMENT,       //!< Pointer printed with "%p".
+  UNSUPPORTED_ARGUMENT    //!< Conversion that can't be recorded.
+} ArgumentType;
+
+//! \enum BinaryRecordKind
+//! \brief Kind of a record in a binary log file, stored in it's first byte.
+typedef enum {
+  FORMAT_RECORD = 1,      //!< Format string and it's identifier.
+  TIME_FORMAT_RECORD,     //!< Time format of the following messages.
+  MESSAGE_RECORD,         //!< Message with a format identifier and arguments.
+  TEXT_RECORD             //!< Message with already formatted contents.
+} BinaryRecordKind;
+
+//! \enum SinkTimestamp
+//! \brief Timestamp written before each message by a log sink.
+typedef enum {
+  NO_TIMESTAMP,           //!< No timestamp.
+  LOGGER_TIMESTAMP,       //!< Timestamp in the Message Logger's time format.
+  CUSTOM_TIMESTAMP        //!< Timestamp in the sink's own time format.
+} SinkTimestamp;
+
+//! \typedef JsonEscapeScanner
+//! \brief Function that finds the first char of a text that must be escaped
+//! in a JSON string.
+//!
+//! Receives the text and it's char length and returns the position of the
+//! first quote, backslash or control character, or the text's length if there
+//! is none. The fastest implementation supported by the processor is chosen by
+//! select_json_escape_scanner().
+typedef size_t (*JsonEscapeScanner)(const char* text, size_t text_length);
+
+//! \struct AsyncRecordSlot
+//! \brief A slot of the asynchronous logging ring buffer.
+//!
+//! Each slot stores a copy of a message's context and contents, along with
+//! the information needed by the writer thread to display and log it. The
+//! sequence number implements the ring buffer's protocol: a slot can be
+//! claimed by a producer when it's sequence equals the producer's position
+//! and can be consumed by the writer thread when it's sequence equals the
+//! writer's position plus one.
+typedef struct {
+  atomic_size_t sequence;         //!< Sequence number of the slot.
+  MessageCategory category;       //!< Category of the stored message.
+  struct timespec timestamp;      //!< Time when the message was logged.
+  int has_context;                //!< Whether the message has a context.
+  size_t context_length;          //!< Char length of the stored context.
+  size_t fields_length;           //!< Char length of the stored fields.
+  size_t body_length;             //!< Char length of the stored contents.
+  //! Message's context immediately followed by the message's fields, as a
+  //! JSON object, and contents.
+  char contents[ASYNC_RECORD_SIZE];
+} AsyncRecordSlot;
+
+//! \struct FormatConversion
+//! \brief A parsed printf conversion specification.
+//!
+//! Stores what is needed to copy a conversion's arguments from a va_list: the
+//! type of it's argument, whether it's width and precision are given as
+//! additional int arguments ("*") and it's literal precision, which limits the
+//! chars copied from string arguments.
+typedef struct {
+  unsigned char type;             //!< #ArgumentType of the conversion.
+  unsigned char star_width;       //!< Whether the width is an argument.
+  unsigned char star_precision;   //!< Whether the precision is an argument.
+  int precision;                  //!< Literal precision. -1 if there is none.
+} FormatConversion;
+
+//! \struct BinaryFormat
+//! \brief A format string recorded in the binary log file.
+//!
+//! The binary log file keeps an open addressing hash table of these entries,
+//! indexed by a hash of the format strings' contents, so each format string
+//! is parsed and written to the file only once. Format strings are compared
+//! by their contents, not their addresses, since a buffer reused for another
+//! format string must not reuse it's conversions. Only conversions with
+//! arguments are stored.
+typedef struct {
+  char *format;                   //!< Copy of the format string, or NULL.
+  size_t length;                  //!< Char length of the format string.
+  uint32_t hash;                  //!< Hash of the format string's contents.
+  uint32_t id;                    //!< Identifier of the format string.
+  //! Number of conversions with arguments. -1 if the format can't be recorded.
+  int num_of_conversions;
+  //! Conversions with arguments, in order.
+  FormatConversion conversions[MAX_BINARY_CONVERSIONS];
+} BinaryFormat;
+
+//! \typedef FixedFraction
+//! \brief Unsigned integer that holds the fraction bits of a double while it's
+//! fraction digits are computed.
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 FixedFraction;
+#else
+typedef uint64_t FixedFraction;
+#endif
+
+//! \struct FormattedText
+//! \brief Text written by format_message_text() into a caller's storage.
+//!
+//! Like vsnprintf(), chars that don't fit the storage are dropped but still
+//! counted, so the caller learns the whole text's length.
+typedef struct {
+  char *data;                     //!< Storage of the text.
+  size_t size;                    //!< Char size of the storage.
+  size_t length;                  //!< Char length of the whole text.
+} FormattedText;
+
+//! \struct DisplayPrefix
+//! \brief The escape codes that apply some display colors, rendered once.
+//!
+//! Every message and tag is preceded by the escape codes that apply it's
+//! display colors. A %DisplayPrefix stores those escape codes already
+//! concatenated, so they can be copied at once to each message.
+typedef struct {
+  size_t length;                  //!< Char length of the prefix.
+  char text[DISPLAY_PREFIX_SIZE]; //!< Prefix text. NOT null terminated.
+} DisplayPrefix;
+
+//! \struct EscapeCode
+//! \brief An ANSI escape code and it's length.
+typedef struct {
+  const char *text;               //!< Escape code text.
+  size_t length;                  //!< Char length of the escape code.
+} EscapeCode;
+
+//! \struct FileBuffer
+//! \brief Text written to a log file but not handed to the C library yet.
+//!
+//! The log files' streams are unbuffered and the Message Logger buffers their
+//! text itself, since a crash handler can't reach the C library's buffers
+//! portably. The buffer's crash lock is held while it's changed, so a crash
+//! handler that takes it can write the pending text with write().
+typedef struct {
+  atomic_flag crash_lock;         //!< Held while the buffer is changed.
+  int descriptor;                 //!< File's descriptor. -1 if none.
+  size_t length;                  //!< Char length of the pending text.
+  char data[FILE_BUFFER_SIZE];    //!< Pending text.
+} FileBuffer;
+
+//! \struct LogArchiveJob
+//! \brief A rotated log file waiting to be archived.
+//!
+//! With the logger lock held, rotate_log_file() only renames the log file to a
+//! staging name and opens a new one. The rest of the rotation, which may
+//! rename and delete many files, is described by a %LogArchiveJob and done by
+//! the archive thread. The jobs are queued in a singly linked list.
+typedef struct LogArchiveJob {
+  FILE *file;                     //!< Rotated log file, still open.
+  int sync;                       //!< Whether the file must be synced.
+  time_t time;                    //!< Time of the rotation.
+  LogRotationPolicy policy;       //!< Rotation policy when it was rotated.
+  char file_name[PATH_MAX];       //!< Name of the log file.
+  char staged_name[PATH_MAX + 32]; //!< Name the log file was renamed to.
+  struct LogArchiveJob *next;     //!< Next job in the queue.
+} LogArchiveJob;
+
+//! \struct FlightRecord
+//! \brief A message kept by the flight recorder.
+//!
+//! Stores a copy of a message's context and contents, like an
+//! #AsyncRecordSlot, and whether the message was also written to the log file
+//! when it was logged, so dumping the flight recorder doesn't repeat it. The
+//! sequence number is 0 while the record is written and the record's position
+//! plus one afterwards, so a dump can tell a record overwritten while it was
+//! read, like a sequence lock.
+typedef struct {
+  atomic_size_t sequence;         //!< Sequence number of the record.
+  MessageCategory category;       //!< Category of the stored message.
+  struct timespec timestamp;      //!< Time when the message was logged.
+  int has_context;                //!< Whether the message has a context.
+  int logged;                     //!< Whether the message is in the log file.
+  size_t context_length;          //!< Char length of the stored context.
+  size_t fields_length;           //!< Char length of the stored fields.
+  size_t body_length;             //!< Char length of the stored contents.
+  //! Message's context immediately followed by the message's fields, as a
+  //! JSON object, and contents.
+  char contents[FLIGHT_RECORD_SIZE];
+} FlightRecord;
+
+//! \struct FlightRecorder
+//! \brief The flight recorder's ring buffer of a thread.
+//!
+//! Each thread keeps it's messages in it's own %FlightRecorder, which only it
+//! writes, so keeping a message takes no lock. The recorders are kept in a
+//! push-only list, which dumps walk to merge their messages, and are reused by
+//! new threads once their threads exit, so the messages of exited threads can
+//! still be dumped. The dump positions are only used with the logger lock
+//! held.
+typedef struct FlightRecorder {
+  atomic_size_t position;         //!< Position of the next record written.
+  size_t dump_position;           //!< Position of the next record dumped.
+  size_t dump_end;                //!< Position where the dump stops.
+  atomic_int claimed;             //!< Whether a thread uses the recorder.
+  struct FlightRecorder *next;    //!< Next recorder in the list.
+  FlightRecord records[];         //!< Ring buffer of records.
+} FlightRecorder;
+
+//! \struct LoggerConfiguration
+//! \brief An immutable snapshot of the Message Logger's display
+//! configurations.
+//!
+//! The color pallet, the display prefixes rendered from it and the time format
+//! are read by every logged message, but rarely change. They are kept in a
+//! %LoggerConfiguration that is never modified after it is published through
+//! #logger_configuration, so readers never wait for writers. Setters copy the
+//! current snapshot, modify the copy and publish it in place of the current
+//! one. Since a reader may still be using them, replaced snapshots are kept in
+//! a list until no #ConfigurationReader holds them.
+typedef struct LoggerConfiguration {
+  //! Display colors for messages and tags.
+  LoggerColorPallet color_pallet;
+  //! Display prefixes rendered for each #MessageCategory.
+  DisplayPrefix msg_prefixes[NUM_OF_MESSAGE_CATEGORIES];
+  //! Display prefixes rendered for each #TagCategory.
+  DisplayPrefix tag_prefixes[NUM_OF_TAG_CATEGORIES];
+  //! Time format for log file timestamps.
+  TimeFormat time_format;
+  //! Next replaced snapshot waiting to be freed.
+  struct LoggerConfiguration *retired_next;
+} LoggerConfiguration;
+
+//! \struct ConfigurationReader
+//! \brief The configuration snapshot used by a thread.
+//!
+//! Each thread that reads the Message Logger's configuration publishes the
+//! snapshot it uses in it's own %ConfigurationReader, like a hazard pointer,
+//! so publish_configuration() can free the replaced snapshots no thread uses.
+//! The readers are kept in a list that only grows, and the reader of an
+//! exited thread is reused by the next thread that needs one.
+typedef struct ConfigurationReader {
+  //! Snapshot used by the thread. NULL while it uses none.
+  _Atomic(const LoggerConfiguration*) snapshot;
+  atomic_int claimed;             //!< Whether a thread owns the reader.
+  struct ConfigurationReader *next; //!< Next reader in the list.
+} ConfigurationReader;
+
+//! \struct LogRecord
+//! \brief A message whose contents were already formatted.
+//!
+//! A %LogRecord references all the information needed to display a message
+//! on the terminal or to write it to a log file. The strings referenced are
+//! NOT null terminated and must be used with their respective lengths.
+typedef struct {
+  MessageCategory category;       //!< Category of the message.
+  struct timespec timestamp;      //!< Time when the message was logged.
+  const char *context;            //!< Message's context. May be NULL.
+  size_t context_length;          //!< Char length of the message's context.
+  const char *body;               //!< Message's formatted contents.
+  size_t body_length;             //!< Char length of the message's contents.
+  const char *fields;             //!< Message's fields as JSON. May be NULL.
+  size_t fields_length;           //!< Char length of the message's fields.
+} LogRecord;
+
+//! \struct LogSink
+//! \brief A log sink attached with add_log_sink().
+//!
+//! A sink either writes messages to a stream or passes them to a callback.
+//! Sinks that render messages the same way, with the same colors and
+//! timestamp, share a variant: the index of the first of those sinks. Each
+//! message is rendered once per variant and the text is written to every sink
+//! of that variant.
+typedef struct {
+  int attached;                   //!< Whether the sink is attached.
+  FILE *stream;                   //!< Stream written to. NULL for callbacks.
+  int owns_stream;                //!< Whether the stream is closed on removal.
+  LogRecordCallback callback;     //!< Function called instead of writing.
+  void *user_data;                //!< User's pointer passed to the callback.
+  unsigned int category_mask;     //!< Mask of the categories written.
+  int colors;                     //!< Whether display colors are written.
+  SinkTimestamp timestamp;        //!< Timestamp written before each message.
+  TimeFormat time_format;         //!< Time format of custom timestamps.
+  int variant;                    //!< First sink that renders messages alike.
+} LogSink;
+
+//! \struct TextBuffer
+//! \brief A text buffer that grows on demand.
+//!
+//! A %TextBuffer starts with storage provided by the user (e.g: an array in
+//! the stack) and only allocates memory in the heap if that storage is not
+//! large enough for the text appended to it. If an allocation fails, the text
+//! appended is truncated to the available storage.
+typedef struct {
+  char *data;                     //!< Text stored. NOT null terminated.
+  size_t length;                  //!< Char length of the text stored.
+  size_t capacity;                //!< Char length of the available storage.
+  int heap_allocated;             //!< Whether the storage is in the heap.
+} TextBuffer;
+
+//! \struct ThreadBuffer
+//! \brief Messages buffered by a thread until they are written at once.
+//!
+//! When thread buffering is enabled, each thread assembles it's messages in
+//! it's own %ThreadBuffer, which is only shared with logger_module_clean_up()
+//! and the crash handlers. The buffers of every thread are kept in a doubly
+//! linked list so they can be flushed when the module is cleaned up.
+typedef struct ThreadBuffer {
+  TextBuffer console;             //!< Messages buffered for the terminal.
+  TextBuffer file;                //!< Messages buffered for the log file.
+  time_t last_message_time;       //!< Time of the last message buffered.
+  struct timespec flush_time;     //!< Time of the last flush.
+  pthread_mutex_t mutex;          //!< Protects the buffer from clean ups.
+  atomic_flag crash_lock;         //!< Held while the buffer is changed.
+  struct ThreadBuffer *next;      //!< Next buffer in the list.
+  struct ThreadBuffer *previous;  //!< Previous buffer in the list.
+  char console_storage[LINE_STORAGE_SIZE]; //!< Initial terminal storage.
+  char file_storage[LINE_STORAGE_SIZE];    //!< Initial log file storage.
+} ThreadBuffer;
+
+//! \struct TimestampCache
+//! \brief A timestamp formatted for the current second.
+//!
+//! Formatting a timestamp requires converting the time to the local time zone
+//! and parsing the time format, which is wasteful when many messages are
+//! logged in the same second. A %TimestampCache keeps the timestamp text of
+//! the last second formatted, along with the position of it's sub-second
+//! digits, so only those digits are rewritten for messages logged in the same
+//! second.
+typedef struct {
+  time_t second;                  //!< Second the timestamp was formatted for.
+  const TimeFormat *time_format;  //!< Time format used for the timestamp.
+  unsigned int generation;        //!< Time format generation when formatted.
+  size_t fraction_offset;         //!< Position of the sub-second digits.
+  int fraction_digits;            //!< Number of sub-second digits. May be 0.
+  size_t length;                  //!< Char length of the timestamp text.
+  char text[TIME_FMT_SIZE];       //!< Timestamp text. NOT null terminated.
+} TimestampCache;
+
 // Private constants:
 
 //! \brief Default logger color pallet configuration.
@@ -21,27 +532,500 @@ const static LoggerColorPallet default_color_pallet = {
   .tag_colors = DEFAULT_LOGGER_TAG_COLORS
 };
 
+//! \brief Char length of the batches written at once by the async writer.
+const static size_t async_batch_size = 64 * 1024;
+
+//! \brief Time the async writer sleeps for when there are no messages.
+const static struct timespec async_writer_idle_time = {
+  .tv_sec = 0,
+  .tv_nsec = 1000000
+};
+
+//! \brief ANSI escape codes that apply a #Color to the text's background.
+const static EscapeCode background_color_escapes[] = {
+  [BLA] = ESCAPE_CODE("\x1B[48;5;0m"),
+  [RED] = ESCAPE_CODE("\x1B[48;5;1m"),
+  [GRN] = ESCAPE_CODE("\x1B[48;5;2m"),
+  [YEL] = ESCAPE_CODE("\x1B[48;5;3m"),
+  [BLU] = ESCAPE_CODE("\x1B[48;5;4m"),
+  [MAG] = ESCAPE_CODE("\x1B[48;5;5m"),
+  [CYN] = ESCAPE_CODE("\x1B[48;5;6m"),
+  [WHT] = ESCAPE_CODE("\x1B[48;5;7m"),
+  [B_BLA] = ESCAPE_CODE("\x1B[48;5;8m"),
+  [B_RED] = ESCAPE_CODE("\x1B[48;5;9m"),
+  [B_GRN] = ESCAPE_CODE("\x1B[48;5;10m"),
+  [B_YEL] = ESCAPE_CODE("\x1B[48;5;11m"),
+  [B_BLU] = ESCAPE_CODE("\x1B[48;5;12m"),
+  [B_MAG] = ESCAPE_CODE("\x1B[48;5;13m"),
+  [B_CYN] = ESCAPE_CODE("\x1B[48;5;14m"),
+  [B_WHT] = ESCAPE_CODE("\x1B[48;5;15m"),
+  [DFLT] = ESCAPE_CODE("\x1B[49m")
+};
+
+//! \brief ANSI escape code that clears the text background past the cursor.
+const static EscapeCode clear_line_escape = ESCAPE_CODE("\x1B[K");
+
+//! \brief Fatal signals handled by the crash handlers.
+const static int crash_signals[NUM_OF_CRASH_SIGNALS] = {
+  SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV
+};
+
+//! \brief Decimal digits of every number from 0 to 99, so integers are
+//! formatted two digits at a time.
+const static char decimal_digit_pairs[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+//! \brief Tag categories used to display each #MessageCategory's tag.
+const static TagCategory message_tag_categories[NUM_OF_MESSAGE_CATEGORIES] = {
+  [DEFAULT_MSG] = CONTEXT_TAG,
+  [ERROR_MSG] = ERROR_TAG,
+  [INFO_MSG] = INFO_TAG,
+  [SUCCESS_MSG] = SUCCESS_TAG,
+  [WARNING_MSG] = WARNING_TAG
+};
+
+//! \brief Names that identify each #MessageCategory in JSON Lines log files.
+const static char *const message_category_names[NUM_OF_MESSAGE_CATEGORIES] = {
+  [DEFAULT_MSG] = "message",
+  [ERROR_MSG] = "error",
+  [INFO_MSG] = "info",
+  [SUCCESS_MSG] = "success",
+  [WARNING_MSG] = "warning"
+};
+
+//! \brief Tags that identify each #MessageCategory. Default messages have no
+//! tag.
+const static char *const message_tags[NUM_OF_MESSAGE_CATEGORIES] = {
+  [DEFAULT_MSG] = NULL,
+  [ERROR_MSG] = "(Error)",
+  [INFO_MSG] = "(Info)",
+  [SUCCESS_MSG] = "(Success)",
+  [WARNING_MSG] = "(Warning)"
+};
+
+//! \brief ANSI escape code that resets all the text's attributes.
+const static EscapeCode reset_attributes_escape = ESCAPE_CODE("\x1B[0m");
+
+//! \brief ANSI escape codes that apply a #Color to the text's font.
+const static EscapeCode text_color_escapes[] = {
+  [BLA] = ESCAPE_CODE("\x1B[22;38;5;0m"),
+  [RED] = ESCAPE_CODE("\x1B[22;38;5;1m"),
+  [GRN] = ESCAPE_CODE("\x1B[22;38;5;2m"),
+  [YEL] = ESCAPE_CODE("\x1B[22;38;5;3m"),
+  [BLU] = ESCAPE_CODE("\x1B[22;38;5;4m"),
+  [MAG] = ESCAPE_CODE("\x1B[22;38;5;5m"),
+  [CYN] = ESCAPE_CODE("\x1B[22;38;5;6m"),
+  [WHT] = ESCAPE_CODE("\x1B[22;38;5;7m"),
+  [B_BLA] = ESCAPE_CODE("\x1B[1;38;5;8m"),
+  [B_RED] = ESCAPE_CODE("\x1B[1;38;5;9m"),
+  [B_GRN] = ESCAPE_CODE("\x1B[1;38;5;10m"),
+  [B_YEL] = ESCAPE_CODE("\x1B[1;38;5;11m"),
+  [B_BLU] = ESCAPE_CODE("\x1B[1;38;5;12m"),
+  [B_MAG] = ESCAPE_CODE("\x1B[1;38;5;13m"),
+  [B_CYN] = ESCAPE_CODE("\x1B[1;38;5;14m"),
+  [B_WHT] = ESCAPE_CODE("\x1B[1;38;5;15m"),
+  [DFLT] = ESCAPE_CODE("\x1B[22;39m")
+};
+
 // Private variables:
 
-//! \brief Message Logger's file pointer for any configured log file.
-static FILE *log_file = NULL;
+//! \brief Position of the next slot consumed by the async writer thread. Only
+//! changed with the logger lock held, but read by the crash handlers.
+static atomic_size_t async_dequeue_position = 0;
 
-//! \brief Message Logger's color pallet for messages and tags.
-static LoggerColorPallet logger_color_pallet = {
-  .message_colors = DEFAULT_LOGGER_MESSAGE_COLORS,
-  .tag_colors = DEFAULT_LOGGER_TAG_COLORS
+//! \brief Position of the next slot claimed by a message producer.
+static atomic_size_t async_enqueue_position = 0;
+
+//! \brief Whether messages are handed over to the async writer thread.
+static atomic_int async_logging_enabled = 0;
+
+//! \brief Ring buffer of messages pending for the async writer thread.
+static AsyncRecordSlot *async_ring = NULL;
+
+//! \brief Mask applied to a position to obtain it's async ring buffer slot.
+static size_t async_ring_mask = 0;
+
+//! \brief Whether the async writer thread should keep waiting for messages.
+static atomic_int async_writer_running = 0;
+
+//! \brief Thread that writes asynchronously logged messages.
+static pthread_t async_writer_thread;
+
+//! \brief Format strings recorded in the binary log file.
+static BinaryFormat binary_formats[BINARY_FORMAT_CACHE_SIZE];
+
+//! \brief Number of format strings recorded in the binary log file.
+static uint32_t binary_formats_recorded = 0;
+
+//! \brief Message Logger's file pointer for a binary log file, if one is
+//! configured.
+static FILE *binary_log_file = NULL;
+
+//! \brief Text pending for the binary log file.
+static FileBuffer binary_log_file_buffer = {
+  .crash_lock = ATOMIC_FLAG_INIT,
+  .descriptor = -1
+};
+
+//! \brief Time format generation last recorded in the binary log file. Is -1
+//! if no time format was recorded yet.
+static long binary_log_time_fmt_generation = -1;
+
+//! \brief Whether the logging functions write messages to the terminal.
+static atomic_int console_output_enabled = 1;
+
+//! \brief Whether the crash handlers are installed.
+static int crash_handlers_installed = 0;
+
+//! \brief Set by the first crash handler that runs, so pending messages are
+//! only written once.
+static atomic_flag crash_handler_running = ATOMIC_FLAG_INIT;
+
+//! \brief Alternate stack used by the crash handlers of the thread that
+//! installed them.
+static char crash_signal_stack[CRASH_SIGNAL_STACK_SIZE];
+
+//! \brief Signal actions replaced by the crash handlers, indexed like
+//! #crash_signals.
+static struct sigaction previous_crash_actions[NUM_OF_CRASH_SIGNALS];
+
+//! \brief Key whose destructor releases the #FlightRecorder of each thread
+//! when the thread exits.
+static pthread_key_t flight_recorder_key;
+
+//! \brief Mask applied to a position to obtain it's flight recorder record.
+static size_t flight_recorder_mask = 0;
+
+//! \brief List of the flight recorders of every thread. Recorders are only
+//! pushed onto it until the module is cleaned up.
+static _Atomic(FlightRecorder*) flight_recorders = NULL;
+
+//! \brief Scanner used to find the chars escaped in JSON strings. NULL until
+//! the first JSON string is escaped.
+static _Atomic(JsonEscapeScanner) json_escape_scanner = NULL;
+
+//! \brief Message Logger's file pointer for any configured log file. Only
+//! changed with the logger lock held, but loaded without it by the logging
+//! functions to skip the work the log file needs.
+static _Atomic(FILE*) log_file = NULL;
+
+//! \brief Text pending for the log file.
+static FileBuffer log_file_buffer = {
+  .crash_lock = ATOMIC_FLAG_INIT,
+  .descriptor = -1
+};
+
+//! \brief Registers flush_file_buffers() to run at exit once.
+static pthread_once_t file_buffers_exit_once = PTHREAD_ONCE_INIT;
+
+//! \brief Format in which messages are written to the log file. Holds a
+//! #LogFileFormat.
+static atomic_int log_file_format = TEXT_LOG_FILE;
+
+//! \brief Name of the configured log file, used to rotate it.
+static char log_file_name[PATH_MAX];
+
+//! \brief Time at which the log file must be rotated, if it is rotated
+//! periodically.
+static time_t log_file_rotation_time = 0;
+
+//! \brief Char length of the text written to the log file.
+static size_t log_file_size = 0;
+
+//! \brief Memory mapping of the memory mapped log file, if one is configured.
+//! Only changed with #mapped_log_file_lock write locked.
+static _Atomic(char*) mapped_log_file = NULL;
+
+//! \brief Lock that keeps the memory mapped log file mapped while texts are
+//! copied into it. Texts are copied with it read locked and the file is only
+//! mapped or unmapped with it write locked. Writers are preferred when
+//! supported, so messages logged continuously don't keep the file open.
+#ifdef PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP
+static pthread_rwlock_t mapped_log_file_lock =
+  PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP;
+#else
+static pthread_rwlock_t mapped_log_file_lock = PTHREAD_RWLOCK_INITIALIZER;
+#endif
+
+//! \brief Char length of the memory mapped log file allocated on disk.
+static atomic_size_t mapped_log_file_allocated = 0;
+
+//! \brief File descriptor of the memory mapped log file.
+static int mapped_log_file_descriptor = -1;
+
+//! \brief Char length by which the memory mapped log file grows at once.
+static size_t mapped_log_file_extent = 0;
+
+//! \brief Mutex that serializes the growth of the memory mapped log file.
+static pthread_mutex_t mapped_log_file_growth_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! \brief Char length reserved by messages in the memory mapped log file.
+static atomic_size_t mapped_log_file_offset = 0;
+
+//! \brief Message Logger's durability policy for the log file.
+static LogDurabilityPolicy log_durability_policy = {
+  .sync_interval = 0,
+  .sync_size = 0,
+  .sync_errors = 0
 };
 
-//! \brief Message Logger's recursive mutex used to ensure thread safety.
-static pthread_mutex_t *logger_recursive_mutex = NULL;
+//! \brief Char length written to the log file since it was last synced.
+static size_t log_file_unsynced_size = 0;
+
+//! \brief Condition that wakes the log file's sync thread up.
+static pthread_cond_t log_sync_condition = PTHREAD_COND_INITIALIZER;
+
+//! \brief Mutex that protects #log_sync_requested and #log_sync_condition.
+static pthread_mutex_t log_sync_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! \brief Whether a sync was requested from the sync thread, because
+//! #log_file_unsynced_size reached the policy's sync size. Only set with
+//! #log_sync_mutex locked, but may be checked without it.
+static atomic_int log_sync_requested = 0;
+
+//! \brief Whether the log file's sync thread is running.
+static atomic_int log_sync_running = 0;
+
+//! \brief Thread that periodically syncs the log file.
+static pthread_t log_sync_thread;
+
+//! \brief Condition that wakes the log file's archive thread up.
+static pthread_cond_t log_archive_condition = PTHREAD_COND_INITIALIZER;
+
+//! \brief Mutex that protects the archive queue, #log_archive_running and
+//! #log_archive_condition.
+static pthread_mutex_t log_archive_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-//! \brief Message Logger's time format for log file timestamps.
-static TimeFormat logger_time_fmt = {
-  .string_representation = "%H:%M:%S %d-%m-%Y"
+//! \brief First rotated log file waiting to be archived. NULL if none is.
+static LogArchiveJob *log_archive_queue = NULL;
+
+//! \brief Last rotated log file waiting to be archived.
+static LogArchiveJob *log_archive_queue_tail = NULL;
+
+//! \brief Whether the log file's archive thread is running.
+static int log_archive_running = 0;
+
+//! \brief Thread that archives the rotated log files.
+static pthread_t log_archive_thread;
+
+//! \brief Number of log file rotations, which makes each staging name unique.
+static unsigned long log_rotation_count = 0;
+
+//! \brief Message Logger's rotation policy for the log file.
+static LogRotationPolicy log_rotation_policy = {
+  .max_file_size = 0,
+  .rotation_interval = 0,
+  .max_archives = 0,
+  .archive_naming = NUMBERED_ARCHIVES
+};
+
+//! \brief Log sinks attached with add_log_sink(), indexed by their identifier.
+static LogSink log_sinks[MAX_LOG_SINKS];
+
+//! \brief Number of log sinks attached. Only changed with the logger lock
+//! held, but loaded without it by the logging functions.
+static atomic_int num_of_log_sinks = 0;
+
+//! \brief Message Logger's current configuration snapshot. Is NULL until
+//! the default configuration is published on first use.
+static _Atomic(const LoggerConfiguration*) logger_configuration = NULL;
+
+//! \brief Mutex that serializes the changes to the Message Logger's
+//! configuration snapshot.
+static pthread_mutex_t logger_configuration_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! \brief Ensures the default configuration is only published once.
+static pthread_once_t logger_configuration_once = PTHREAD_ONCE_INIT;
+
+//! \brief Message Logger's default configuration snapshot.
+static LoggerConfiguration logger_default_configuration = {
+  .color_pallet = {
+    .message_colors = DEFAULT_LOGGER_MESSAGE_COLORS,
+    .tag_colors = DEFAULT_LOGGER_TAG_COLORS
+  },
+  .time_format = {
+    .string_representation = "%H:%M:%S %d-%m-%Y"
+  },
+  .retired_next = NULL
 };
 
+//! \brief Whether the Message Logger displays colors on the terminal. Is -1
+//! while the default #AUTO_COLORS mode is not resolved.
+static atomic_int logger_colors_enabled = -1;
+
+//! \brief Mask of the message categories enabled in the Message Logger, plus
+//! #FLIGHT_RECORDER_FLAG while the flight recorder is enabled.
+static atomic_uint logger_enabled_categories = ALL_MESSAGE_CATEGORIES;
+
+//! \brief Number of times the current thread acquired the logger lock without
+//! releasing it, so it is only locked once by nested calls.
+static _Thread_local unsigned int logger_lock_depth = 0;
+
+//! \brief Whether the current thread holds #logger_mutex.
+static _Thread_local int logger_lock_held = 0;
+
+//! \brief Message Logger's mutex used to ensure thread safety. Nested locking
+//! is handled by lock_logger(), so it doesn't need to be recursive. Where
+//! available, an adaptive mutex spins briefly before sleeping, since the lock
+//! is only held to write a message.
+#ifdef PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+static pthread_mutex_t logger_mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+#else
+static pthread_mutex_t logger_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+//! \brief Whether thread safety was enabled with enable_thread_safety().
+static atomic_int logger_thread_safety_enabled = 0;
+
+//! \brief Configuration snapshots replaced but still used by a reader,
+//! waiting to be freed.
+static LoggerConfiguration *logger_retired_configurations = NULL;
+
+//! \brief Readers of the configuration snapshots of every thread.
+static _Atomic(ConfigurationReader*) configuration_readers = NULL;
+
+//! \brief Key whose destructor releases the #ConfigurationReader of each
+//! thread that claimed one.
+static pthread_key_t configuration_reader_key;
+
+//! \brief Whether #configuration_reader_key was created.
+static int configuration_reader_key_created = 0;
+
+//! \brief Creates #configuration_reader_key once.
+static pthread_once_t configuration_reader_key_once = PTHREAD_ONCE_INIT;
+
+//! \brief Configuration snapshot acquired by the current thread.
+static _Thread_local const LoggerConfiguration *thread_configuration = NULL;
+
+//! \brief Number of times the current thread acquired
+//! #thread_configuration without releasing it.
+static _Thread_local unsigned int thread_configuration_depth = 0;
+
+//! \brief The current thread's #ConfigurationReader. NULL until it's claimed.
+static _Thread_local ConfigurationReader *thread_configuration_reader = NULL;
+
+//! \brief Number of changes made to the Message Logger's time format or to
+//! the time formats of the log sinks. Invalidates the timestamp caches.
+static atomic_uint logger_time_fmt_generation = 0;
+
+//! \brief Key whose destructor frees the scratch body of each thread that
+//! grew it into the heap.
+static pthread_key_t scratch_body_key;
+
+//! \brief Whether #scratch_body_key was created.
+static int scratch_body_key_created = 0;
+
+//! \brief Creates #scratch_body_key once.
+static pthread_once_t scratch_body_key_once = PTHREAD_ONCE_INIT;
+
+//! \brief Max milliseconds a thread keeps messages buffered. 0 = no limit.
+static unsigned int thread_buffer_flush_interval = 0;
+
+//! \brief Key of each thread's ThreadBuffer, whose destructor flushes it when
+//! the thread exits.
+static pthread_key_t thread_buffer_key;
+
+//! \brief Char length of the messages a thread buffers before writing them.
+static size_t thread_buffer_size = 0;
+
+//! \brief Whether each thread buffers it's messages.
+static atomic_int thread_buffering_enabled = 0;
+
+//! \brief List of the buffers of every thread.
+static ThreadBuffer *thread_buffers = NULL;
+
+//! \brief Held while the list of thread buffers is changed, so a crash
+//! handler that takes it can walk the list.
+static atomic_flag thread_buffers_crash_lock = ATOMIC_FLAG_INIT;
+
+//! \brief Mutex that protects the list of thread buffers.
+static pthread_mutex_t thread_buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! \brief Text buffer where the current thread formats the contents of it's
+//! messages. It keeps it's storage between messages, so long messages are
+//! only formatted once and don't allocate memory each time.
+static _Thread_local TextBuffer thread_scratch_body;
+
+//! \brief Whether the current thread's scratch body holds the contents of a
+//! message being logged.
+static _Thread_local int thread_scratch_body_in_use = 0;
+
+//! \brief Initial storage of the current thread's scratch body.
+static _Thread_local char thread_scratch_storage[LINE_STORAGE_SIZE];
+
+//! \brief Timestamp caches of the current thread. Unused caches have a NULL
+//! time format.
+static _Thread_local TimestampCache thread_timestamp_caches[
+  TIMESTAMP_CACHE_SIZE
+];
+
+//! \brief Index of the timestamp cache of the current thread that is replaced
+//! next.
+static _Thread_local unsigned int thread_timestamp_cache_victim = 0;
+
 // Private function prototypes:
 
+//! \fn static void acquire_crash_lock(atomic_flag* lock)
+//! \brief Takes a crash lock before changing the text it protects.
+//! \param lock Crash lock to be taken.
+//!
+//! A crash lock protects text written by the crash handlers. Whoever changes
+//! the text is already serialized by another lock, so only a crash handler
+//! may hold it meanwhile, and this function yields until it's released.
+//!
+//! \par Usage example
+//! \code
+//! acquire_crash_lock(&buffer->crash_lock);
+//! buffer->length = 0;
+//! release_crash_lock(&buffer->crash_lock);
+//! \endcode
+static void acquire_crash_lock(atomic_flag* lock);
+
+//! \fn static const LoggerConfiguration* acquire_configuration()
+//! \brief Returns the current configuration snapshot, protecting it from
+//! being freed until release_configuration() is called.
+//! \return Returns the current configuration snapshot. Never NULL.
+//!
+//! This function publishes the snapshot in the thread's #ConfigurationReader
+//! and checks it's still the current one, so a setter that replaces it
+//! afterwards finds it in use. Nested calls return the snapshot acquired by
+//! the outermost one. If a reader can't be claimed, #logger_configuration_mutex
+//! is locked instead until the snapshot is released.
+//!
+//! \par Usage example
+//! \code
+//! const LoggerConfiguration *configuration = acquire_configuration();
+//! prefix = &configuration->tag_prefixes[CONTEXT_TAG];
+//! release_configuration();
+//! \endcode
+static const LoggerConfiguration* acquire_configuration();
+
+//! \fn static TextBuffer* acquire_scratch_body()
+//! \brief Acquires the current thread's scratch body to format a message's
+//! contents.
+//! \return Returns the empty scratch body, or NULL if it is already holding
+//! the contents of another message.
+//!
+//! A message logged while another one is being written by the same thread,
+//! such as one logged by a log sink's callback, can't reuse the scratch body
+//! and must format it's contents in it's own storage.
+//!
+//! \par Usage example
+//! \code
+//! TextBuffer *body = acquire_scratch_body();
+//!
+//! if(body != NULL) {
+//!   text_buffer_append_formatted(body, format, args);
+//!   // Write the message contents...
+//!   release_scratch_body(body);
+//! }
+//! \endcode
+static TextBuffer* acquire_scratch_body();
+
 //! \fn static void apply_all_default_attributes()
 //! \brief Reset all the terminal's colors and text attributes to their
 //! defaults.
@@ -58,6 +1042,150 @@ static TimeFormat logger_time_fmt = {
 //! \endcode
 static void apply_all_default_attributes();
 
+//! \fn static void archive_log_file(LogArchiveJob* job)
+//! \brief Finishes the rotation of a log file and frees it's job.
+//! \param job Job queued by rotate_log_file().
+//!
+//! This function syncs, if required, and closes the rotated log file and then
+//! renames it from it's staging name to an archive according to the job's
+//! rotation policy, shifting or deleting the older archives. Without
+//! archives, the rotated log file is deleted. Archive names that don't fit
+//! their buffers are never used, the rotated log file keeping it's staging
+//! name instead.
+//!
+//! \warning This function doesn't need the logger lock and doesn't print
+//! error messages, since it's called by the archive thread.
+//!
+//! \par Usage example
+//! \code
+//! archive_log_file(job);
+//! \endcode
+static void archive_log_file(LogArchiveJob* job);
+
+//! \fn static void attach_file_buffer(FileBuffer* buffer, FILE* stream)
+//! \brief Makes a #FileBuffer buffer the text of a newly opened log file.
+//! \param buffer Empty file buffer of the log file.
+//! \param stream Stream of the log file.
+//!
+//! This function turns the C library's buffering of the stream off and
+//! stores it's descriptor for the crash handlers. The first time, it also
+//! registers flush_file_buffers() to run at exit.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! log_file = fopen(log_file_name, "w");
+//! attach_file_buffer(&log_file_buffer, log_file);
+//! \endcode
+static void attach_file_buffer(FileBuffer* buffer, FILE* stream);
+
+//! \fn static void* async_writer_routine(void* args)
+//! \brief Routine executed by the async writer thread.
+//! \param args Unused.
+//! \return Always returns NULL.
+//!
+//! This function repeatedly drains the \link #async_ring async ring buffer
+//! \endlink, writing the pending messages to the terminal and to the log
+//! file in batches. When there are no pending messages, the writer thread
+//! sleeps for a short while before checking the ring buffer again. The
+//! routine returns once #async_writer_running is cleared and every pending
+//! message was written.
+//!
+//! \par Usage example
+//! \code
+//! atomic_store(&async_writer_running, 1);
+//! pthread_create(&async_writer_thread, NULL, async_writer_routine, NULL);
+//! \endcode
+static void* async_writer_routine(void* args);
+
+//! \fn static LoggerConfiguration* begin_configuration_update()
+//! \brief Starts a change to the Message Logger's configuration snapshot.
+//! \return Returns a modifiable copy of the current configuration snapshot,
+//! or NULL if it can't be allocated.
+//!
+//! This function locks #logger_configuration_mutex, so configuration changes
+//! are serialized, and returns a copy of the current snapshot. The change must
+//! be finished with publish_configuration(), which releases the mutex. If the
+//! copy can't be allocated, the mutex is released and an error message is
+//! printed.
+//!
+//! \par Usage example
+//! \code
+//! LoggerConfiguration *configuration = begin_configuration_update();
+//! if(configuration != NULL) {
+//!   // Modify the configuration...
+//!   publish_configuration(configuration);
+//! }
+//! \endcode
+static LoggerConfiguration* begin_configuration_update();
+
+//! \fn static FlightRecord* begin_flight_record(FlightRecorder* recorder)
+//! \brief Starts writing the next record of a thread's flight recorder.
+//! \param recorder Flight recorder of the calling thread.
+//! \return Returns the record to be overwritten, marked as being written.
+//!
+//! \warning This function must only be called by the recorder's thread,
+//! which then calls end_flight_record().
+//!
+//! \par Usage example
+//! \code
+//! flight_record = begin_flight_record(recorder);
+//! flight_record->category = category;
+//! end_flight_record(recorder, flight_record);
+//! \endcode
+static FlightRecord* begin_flight_record(FlightRecorder* recorder);
+
+//! \fn static int buffer_thread_record(const LogRecord* record, int console)
+//! \brief Appends a message to the current thread's buffer.
+//! \param record Message to be buffered.
+//! \param console Whether the message is written to the terminal.
+//! \return Returns 0 when the message is buffered and -1 if the thread has no
+//! buffer, in which case the message must be written directly.
+//!
+//! This function renders a message into the current thread's ThreadBuffer
+//! without taking the logger lock. The buffer is flushed afterwards
+//! if it reached #thread_buffer_size chars, if #thread_buffer_flush_interval
+//! milliseconds passed since it's last flush or if the message is an error
+//! message.
+//!
+//! \par Usage example
+//! \code
+//! if(buffer_thread_record(&record, 1) == 0)
+//!   return;
+//! \endcode
+static int buffer_thread_record(const LogRecord* record, int console);
+
+//! \fn static ConfigurationReader* claim_configuration_reader()
+//! \brief Claims a #ConfigurationReader for the current thread.
+//! \return Returns the claimed reader, or NULL if memory can't be allocated.
+//!
+//! This function reuses an unclaimed reader from #configuration_readers or
+//! pushes a new one onto it, and stores it in #thread_configuration_reader.
+//!
+//! \par Usage example
+//! \code
+//! if(thread_configuration_reader == NULL)
+//!   claim_configuration_reader();
+//! \endcode
+static ConfigurationReader* claim_configuration_reader();
+
+//! \fn static FlightRecorder* claim_flight_recorder()
+//! \brief Returns the calling thread's #FlightRecorder, claiming one first if
+//! the thread has none.
+//! \return Returns the thread's recorder or NULL if it could not be
+//! allocated.
+//!
+//! This function reuses a recorder released by an exited thread from
+//! #flight_recorders or pushes a new one onto it.
+//!
+//! \par Usage example
+//! \code
+//! recorder = claim_flight_recorder();
+//! \endcode
+static FlightRecorder* claim_flight_recorder();
+
 //! \fn static void clear_line_text_background_past_cursor()
 //! \brief Clears the existing colored text background past the cursor in the
 //! current line.
@@ -77,6 +1205,79 @@ static void apply_all_default_attributes();
 //! \endcode
 static void clear_line_text_background_past_cursor();
 
+//! \fn static int colors_enabled()
+//! \brief Checks whether colors are displayed on the terminal.
+//! \return Returns 1 if colors are displayed and 0 otherwise.
+//!
+//! This function returns the value of #logger_colors_enabled. If the default
+//! #AUTO_COLORS mode wasn't resolved yet, it is resolved by checking if the
+//! standard output is a terminal, so that check only happens once.
+//!
+//! \par Usage example
+//! \code
+//! if(colors_enabled())
+//!   printf("\x1B[0m");
+//! \endcode
+static int colors_enabled();
+
+//! \fn static void close_binary_log_file()
+//! \brief Closes the binary log file, if one is configured.
+//!
+//! This function closes the binary log file and forgets the format strings
+//! recorded in it, so they are recorded again in the next binary log file.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! close_binary_log_file();
+//! \endcode
+static void close_binary_log_file();
+
+//! \fn static void close_buffered_file(FileBuffer* buffer, FILE* stream)
+//! \brief Writes the text pending for a log file and closes it.
+//! \param buffer File buffer of the log file.
+//! \param stream Stream of the log file.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! close_buffered_file(&log_file_buffer, log_file);
+//! log_file = NULL;
+//! \endcode
+static void close_buffered_file(FileBuffer* buffer, FILE* stream);
+
+//! \fn static void close_log_sink(LogSink* sink)
+//! \brief Closes a log sink's file or flushes it's stream, marking it unused.
+//! \param sink Log sink to be closed. May be unused already.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! close_log_sink(&log_sinks[sink_id]);
+//! update_log_sink_variants();
+//! \endcode
+static void close_log_sink(LogSink* sink);
+
+//! \fn static void close_mapped_log_file()
+//! \brief Closes the memory mapped log file, if one is configured.
+//!
+//! This function unmaps the memory mapped log file and truncates it to the
+//! length of the messages written to it, discarding the unused part of it's
+//! last extent. It write locks #mapped_log_file_lock, so it waits for the
+//! texts being copied into the file.
+//!
+//! \par Usage example
+//! \code
+//! close_mapped_log_file();
+//! \endcode
+static void close_mapped_log_file();
+
 //! \fn static void copy_display_colors(
 //!   DisplayColors* destination,
 //!   const DisplayColors* origin
@@ -112,22 +1313,37 @@ static void copy_display_colors(
   const DisplayColors* origin
 );
 
-//! \fn static void log_formatted_text_content(
-//!   FILE* log_file,
-//!   const char* text_format,
-//!   va_list text_args
+//! \fn static size_t copy_record_contents(
+//!   char* contents,
+//!   size_t contents_size,
+//!   const char* context,
+//!   const char* fields,
+//!   const char* format,
+//!   va_list args,
+//!   size_t* context_length,
+//!   size_t* fields_length
 //! )
-//! \brief Writes a formatted text with it's arguments to a log file. Log file
-//! pointer must NOT be NULL.
-//! \param log_file Log file where text will be logged. Must NOT be NULL.
-//! \param text_format String formatting for the text's contents before
-//! argument substitution takes place.
-//! \param text_args Arguments used to substitute placeholders in the text's
-//! contents.
+//! \brief Copies a message's context, fields and formatted contents to a fixed
+//! size record.
+//! \param contents Record's storage, where the context is copied immediately
+//! followed by the fields and the formatted contents. Is NOT null terminated.
+//! \param contents_size Char length of the record's storage.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Message's fields, as a JSON object. Pass a NULL pointer for a
+//! message without fields.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//! \param context_length Pointer to where the context's char length is
+//! stored.
+//! \param fields_length Pointer to the fields' char length, which is set to 0
+//! if the fields don't fit in the record.
+//! \return Returns the char length of the formatted contents.
 //!
-//! This function writes a formatted text to a log file, utilizing the
-//! arguments provided to substitute any placeholders in the text's initial
-//! format.
+//! The context may take at most half of the record and the fields at most half
+//! of the rest, leaving room for the message's contents. Contents that don't
+//! fit are truncated, while fields that don't fit are dropped, since a
+//! truncated JSON object can't be read.
 //!
 //! \note The va_list provided as an argument for this function is NOT rendered
 //! unusable by this function! A local copy of the va_list argument is made,
@@ -135,1083 +1351,8020 @@ static void copy_display_colors(
 //! cleaning for the va_list achieved with va_end() is a task that this
 //! function does NOT handle!
 //!
-//! \warning This functions does not check if the file pointer is valid! Do NOT
-//! call this function with a NULL file pointer.
-//!
 //! \par Usage example
 //! \code
-//! FILE *log_file;
+//! slot->fields_length = fields_length;
+//! slot->body_length = copy_record_contents(
+//!   slot->contents,
+//!   ASYNC_RECORD_SIZE,
+//!   context,
+//!   fields,
+//!   format,
+//!   args,
+//!   &slot->context_length,
+//!   &slot->fields_length
+//! );
+//! \endcode
+static size_t copy_record_contents(
+  char* contents,
+  size_t contents_size,
+  const char* context,
+  const char* fields,
+  const char* format,
+  va_list args,
+  size_t* context_length,
+  size_t* fields_length
+);
+
+//! \fn static void crash_signal_handler(int signal_number)
+//! \brief Writes the pending messages when the program crashes.
+//! \param signal_number Fatal signal received.
 //!
-//! void question(const char* text_format, ...) {
-//!   va_list text_args;
-//!   va_start(text_args, text_format);
-//!   log_formatted_text_content(
-//!     log_file,
-//!     text_format,
-//!     text_args
-//!   );
-//!   va_end(text_args);
+//! This function is the handler installed by install_crash_handlers(). It
+//! restores the signal actions it replaced and, only in the first thread that
+//! crashes, writes the messages still pending in the log files' #FileBuffer,
+//! in the async logging ring buffer and in the thread buffers, using only
+//! write() on the outputs' descriptors. Then it raises the signal again, so
+//! the replaced action (e.g: the default core dump) takes place.
+//!
+//! Pending messages are written on a best effort basis: the Message Logger's
+//! lock is NOT taken, since the crashing thread may hold it. Instead, the
+//! file buffers, the list of thread buffers and each thread buffer are only
+//! read after taking their crash lock with try_crash_lock(), and ring buffer
+//! slots are only written if they weren't consumed while being rendered. The
+//! C library's buffers, like the terminal's and those of log sink streams,
+//! are NOT touched.
+//!
+//! \par Usage example
+//! \code
+//! crash_action.sa_handler = crash_signal_handler;
+//! sigaction(SIGSEGV, &crash_action, &previous_crash_actions[i]);
+//! \endcode
+static void crash_signal_handler(int signal_number);
+
+//! \fn static void create_configuration_reader_key()
+//! \brief Creates #configuration_reader_key, which releases the
+//! #ConfigurationReader of each thread when the thread exits.
+//!
+//! \par Usage example
+//! \code
+//! pthread_once(
+//!   &configuration_reader_key_once,
+//!   create_configuration_reader_key
+//! );
+//! \endcode
+static void create_configuration_reader_key();
+
+//! \fn static void create_scratch_body_key()
+//! \brief Creates #scratch_body_key, which frees the heap storage of each
+//! thread's scratch body when the thread exits.
+//!
+//! \par Usage example
+//! \code
+//! pthread_once(&scratch_body_key_once, create_scratch_body_key);
+//! \endcode
+static void create_scratch_body_key();
+
+//! \fn static int decode_binary_arguments(
+//!   FILE* file,
+//!   const char* format,
+//!   TextBuffer* body
+//! )
+//! \brief Formats a message's contents with arguments read from a binary log
+//! file.
+//! \param file Binary log file, positioned at the message's arguments.
+//! \param format Message's text format, as recorded in the binary log file.
+//! \param body Text buffer where the formatted contents are appended.
+//! \return Returns 0 when successfully executed and -1 if the arguments can't
+//! be read.
+//!
+//! This function walks the conversions of a format string, reading the
+//! arguments that write_binary_record() stored for each of them and formatting
+//! each conversion separately. Arguments given by "*" are substituted into the
+//! conversion's text before it is formatted.
+//!
+//! \par Usage example
+//! \code
+//! if(decode_binary_arguments(file, formats[id], &body) != 0)
+//!   return -1;
+//! \endcode
+static int decode_binary_arguments(
+  FILE* file,
+  const char* format,
+  TextBuffer* body
+);
+
+//! \fn static size_t drain_async_ring(
+//!   TextBuffer* console_batch,
+//!   TextBuffer* file_batch
+//! )
+//! \brief Writes a batch of pending asynchronous messages.
+//! \param console_batch Text buffer used to batch the terminal output.
+//! \param file_batch Text buffer used to batch the log file output.
+//! \return Returns the number of messages written.
+//!
+//! This function consumes pending messages from the \link #async_ring async
+//! ring buffer \endlink until it's empty or until a batch of
+//! #async_batch_size chars is assembled. The batch is then written to the
+//! terminal and to the log file with a single call for each of them. Both text
+//! buffers are emptied before this function returns.
+//!
+//! \warning The messages are consumed while holding the logger lock, so this
+//! function must only be called by the async writer thread or by a thread
+//! that holds the logger lock (e.g: a producer that finds the ring buffer
+//! full or a flight recorder dump).
+//!
+//! \par Usage example
+//! \code
+//! while(drain_async_ring(&console_batch, &file_batch) > 0);
+//! \endcode
+static size_t drain_async_ring(
+  TextBuffer* console_batch,
+  TextBuffer* file_batch
+);
+
+//! \fn static void end_flight_record(
+//!   FlightRecorder* recorder,
+//!   FlightRecord* record
+//! )
+//! \brief Publishes a record started by begin_flight_record().
+//! \param recorder Flight recorder of the calling thread.
+//! \param record Record that was written.
+//!
+//! \par Usage example
+//! \code
+//! flight_record = begin_flight_record(recorder);
+//! flight_record->category = category;
+//! end_flight_record(recorder, flight_record);
+//! \endcode
+static void end_flight_record(FlightRecorder* recorder, FlightRecord* record);
+
+//! \fn static void enqueue_async_record(
+//!   MessageCategory category,
+//!   const char* context,
+//!   const char* fields,
+//!   size_t fields_length,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Formats a message and hands it over to the async writer thread.
+//! \param category Category of the message.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Message's fields, as a JSON object. Pass a NULL pointer for a
+//! message without fields.
+//! \param fields_length Char length of the message's fields.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function claims a slot in the \link #async_ring async ring buffer
+//! \endlink, copies the message's context, fields and formatted contents to
+//! it and publishes the slot to the async writer thread. If the ring buffer is
+//! full, this function yields the processor until the writer thread frees a
+//! slot. A thread that holds the logger lock, such as one inside a batch
+//! started by begin_logger_batch(), can't wait for the writer thread, which
+//! needs that lock to drain the ring buffer, so it drains a batch itself.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
+//!
+//! \par Usage example
+//! \code
+//! void question(const char* context, const char* text_format, ...) {
+//!   va_list text_args;
+//!   va_start(text_args, text_format);
+//!   enqueue_async_record(INFO_MSG, context, NULL, 0, text_format, text_args);
+//!   va_end(text_args);
 //! }
+//! \endcode
+static void enqueue_async_record(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+);
+
+//! \fn static const BinaryFormat* find_binary_format(const char* format)
+//! \brief Finds the binary log file's entry for a format string, recording it
+//! if needed.
+//! \param format Message's text format.
+//! \return Returns the format string's entry, or NULL if there is no room to
+//! record it.
+//!
+//! This function looks up a format string by it's contents in
+//! #binary_formats, comparing the whole string when the length and hash of an
+//! entry match. The first time a format string is looked up, it is copied,
+//! parsed, given the next identifier and written to the binary log file in a
+//! format record, so it precedes every message that uses it.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled, and with a binary log file configured.
+//!
+//! \par Usage example
+//! \code
+//! const BinaryFormat *entry = find_binary_format(format);
+//! \endcode
+static const BinaryFormat* find_binary_format(const char* format);
+
+#ifdef LOGGER_USES_X86_SIMD
+//! \fn static size_t find_json_escape_avx2(
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Finds the first char of a text that must be escaped in a JSON
+//! string, 32 chars at a time.
+//! \param text Text to be scanned. Does NOT need to be null terminated.
+//! \param text_length Char length of the text.
+//! \return Returns the position of the first char to be escaped, or the text's
+//! length if there is none.
+//!
+//! AVX2 implementation of a #JsonEscapeScanner. Each block of 32 chars is
+//! compared against the quote, the backslash and the control characters at
+//! once, and the position is taken from the resulting bit mask. The last
+//! chars are scanned by find_json_escape_sse2().
+//!
+//! \warning Must only be called if the processor supports AVX2.
+//!
+//! \par Usage example
+//! \code
+//! if(__builtin_cpu_supports("avx2"))
+//!   scanner = find_json_escape_avx2;
+//! \endcode
+__attribute__((target("avx2")))
+static size_t find_json_escape_avx2(const char* text, size_t text_length);
+#endif
+
+//! \fn static size_t find_json_escape_scalar(
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Finds the first char of a text that must be escaped in a JSON
+//! string, one char at a time.
+//! \param text Text to be scanned. Does NOT need to be null terminated.
+//! \param text_length Char length of the text.
+//! \return Returns the position of the first char to be escaped, or the text's
+//! length if there is none.
+//!
+//! Portable implementation of a #JsonEscapeScanner, used when the processor
+//! has no supported vector instructions and for the last chars of a text
+//! scanned by the vector implementations.
+//!
+//! \par Usage example
+//! \code
+//! length = find_json_escape_scalar(key, strlen(key));
+//! \endcode
+static size_t find_json_escape_scalar(const char* text, size_t text_length);
+
+#ifdef LOGGER_USES_X86_SIMD
+//! \fn static size_t find_json_escape_sse2(
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Finds the first char of a text that must be escaped in a JSON
+//! string, 16 chars at a time.
+//! \param text Text to be scanned. Does NOT need to be null terminated.
+//! \param text_length Char length of the text.
+//! \return Returns the position of the first char to be escaped, or the text's
+//! length if there is none.
+//!
+//! SSE2 implementation of a #JsonEscapeScanner, like find_json_escape_avx2()
+//! with half the block size. The last chars are scanned by
+//! find_json_escape_scalar().
+//!
+//! \warning Must only be called if the processor supports SSE2.
+//!
+//! \par Usage example
+//! \code
+//! position = find_json_escape_sse2(text, text_length);
+//! \endcode
+__attribute__((target("sse2")))
+static size_t find_json_escape_sse2(const char* text, size_t text_length);
+#endif
+
+//! \fn static void flush_file_buffer(FileBuffer* buffer, FILE* stream)
+//! \brief Writes the text pending in a #FileBuffer to it's log file.
+//! \param buffer File buffer of the log file.
+//! \param stream Stream of the log file. May be NULL if there is none.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! flush_file_buffer(&log_file_buffer, log_file);
+//! fdatasync(fileno(log_file));
+//! \endcode
+static void flush_file_buffer(FileBuffer* buffer, FILE* stream);
+
+//! \fn static void flush_file_buffers()
+//! \brief Writes the text pending for the log files when the program exits.
+//!
+//! Without it, the text the C library would have flushed at exit would be
+//! lost by programs that don't call logger_module_clean_up().
+//!
+//! \par Usage example
+//! \code
+//! atexit(flush_file_buffers);
+//! \endcode
+static void flush_file_buffers();
+
+//! \fn static void flush_thread_buffer(ThreadBuffer* buffer)
+//! \brief Writes the messages of a thread buffer to the terminal and log file.
+//! \param buffer Thread buffer to be flushed.
+//!
+//! This function writes every message buffered by a thread with a single call
+//! for the terminal and another for the log file, holding the logger lock
+//! only while doing so. The buffer is emptied afterwards.
+//!
+//! \warning This function must be called with the buffer's mutex held.
+//!
+//! \par Usage example
+//! \code
+//! pthread_mutex_lock(&buffer->mutex);
+//! flush_thread_buffer(buffer);
+//! pthread_mutex_unlock(&buffer->mutex);
+//! \endcode
+static void flush_thread_buffer(ThreadBuffer* buffer);
+
+//! \fn static int format_fixed_double(char* text, double value, int precision)
+//! \brief Formats the magnitude of a double like a "%.<precision>f"
+//! conversion.
+//! \param text Storage for the formatted digits, with at least
+//! #FORMAT_DIGITS_SIZE chars. The digits are NOT null terminated.
+//! \param value Double whose magnitude is formatted. It's sign is ignored.
+//! \param precision Number of fraction digits.
+//! \return Returns the char length of the formatted digits, or -1 if the
+//! double can't be formatted without vsnprintf().
+//!
+//! This function computes the digits from the exact binary value of the
+//! double, with integer arithmetic, and rounds the last digit to the nearest,
+//! ties to even, giving the same digits as the C library. Infinite and NaN
+//! doubles, integer parts above 64 bits and precisions above
+//! #MAX_FIXED_PRECISION are left to vsnprintf().
+//!
+//! \par Usage example
+//! \code
+//! char digits[FORMAT_DIGITS_SIZE];
+//! int length = format_fixed_double(digits, 3.14159, 2);
+//! \endcode
+static int format_fixed_double(char* text, double value, int precision);
+
+//! \fn static int format_message_text(
+//!   char* text,
+//!   size_t text_size,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Formats a text with it's arguments, like vsnprintf().
+//! \param text Storage where the text is written. May be NULL if text_size is
+//! 0.
+//! \param text_size Char size of the storage, including the null char.
+//! \param format String formatting for the text's contents before argument
+//! substitution takes place.
+//! \param args Arguments used to substitute placeholders in the text's
+//! contents.
+//! \return Returns the char length of the whole formatted text, even if it
+//! was truncated, or a negative value on error.
+//!
+//! This function formats the conversions most used in messages ("%d", "%i",
+//! "%u", "%x", "%X", "%c", "%s", "%p", "%f" and "%%", with the "l", "ll" and
+//! "z" length modifiers, the "-" and "0" flags, a literal width and a literal
+//! precision for "%s" and "%f") without going through the C library's stream
+//! machinery, writing integers two digits at a time. Format strings with any
+//! other conversion, as well as NULL strings and doubles that
+//! format_fixed_double() can't format, are formatted by vsnprintf() instead,
+//! so the text is always the same as the C library's.
+//!
+//! \note Like vsnprintf(), this function renders the va_list unusable.
+//!
+//! \par Usage example
+//! \code
+//! char text[64];
+//! va_list args_copy;
+//!
+//! va_copy(args_copy, args);
+//! format_message_text(text, sizeof(text), format, args_copy);
+//! va_end(args_copy);
+//! \endcode
+static int format_message_text(
+  char* text,
+  size_t text_size,
+  const char* format,
+  va_list args
+);
+
+//! \fn static char* format_unsigned_digits(
+//!   char* end,
+//!   unsigned long long value,
+//!   unsigned base,
+//!   int uppercase
+//! )
+//! \brief Formats the digits of an unsigned integer backwards from the end of
+//! some storage.
+//! \param end Pointer past the storage's last char. The storage must fit the
+//! integer's digits.
+//! \param value Integer to be formatted.
+//! \param base Base of the digits, either 10 or 16.
+//! \param uppercase Whether hexadecimal digits are written in uppercase.
+//! \return Returns a pointer to the first digit.
+//!
+//! Decimal digits are written two at a time, from #decimal_digit_pairs, which
+//! halves the number of divisions.
+//!
+//! \par Usage example
+//! \code
+//! char digits[20], *first = format_unsigned_digits(digits + 20, 42, 10, 0);
+//! fwrite(first, 1, digits + 20 - first, stdout);
+//! \endcode
+static char* format_unsigned_digits(
+  char* end,
+  unsigned long long value,
+  unsigned base,
+  int uppercase
+);
+
+//! \fn static void formatted_text_append(
+//!   FormattedText* text,
+//!   const char* chars,
+//!   size_t chars_length
+//! )
+//! \brief Appends chars to a formatted text, dropping those past it's
+//! storage.
+//! \param text Formatted text where the chars are appended.
+//! \param chars Chars to be appended.
+//! \param chars_length Number of chars to be appended.
+//!
+//! \par Usage example
+//! \code
+//! formatted_text_append(&text, "0x", 2);
+//! \endcode
+static void formatted_text_append(
+  FormattedText* text,
+  const char* chars,
+  size_t chars_length
+);
+
+//! \fn static void formatted_text_pad(
+//!   FormattedText* text,
+//!   char padding,
+//!   size_t padding_length
+//! )
+//! \brief Appends a char repeatedly to a formatted text, dropping those past
+//! it's storage.
+//! \param text Formatted text where the padding is appended.
+//! \param padding Char to be appended.
+//! \param padding_length Number of times the char is appended.
+//!
+//! \par Usage example
+//! \code
+//! formatted_text_pad(&text, ' ', width - length);
+//! \endcode
+static void formatted_text_pad(
+  FormattedText* text,
+  char padding,
+  size_t padding_length
+);
+
+//! \fn static void free_configuration_reader(void* reader)
+//! \brief Releases an exiting thread's #ConfigurationReader, so another
+//! thread can claim it.
+//! \param reader Configuration reader of the exiting thread.
+//!
+//! This function is the destructor of #configuration_reader_key.
+//!
+//! \par Usage example
+//! \code
+//! pthread_key_create(&configuration_reader_key, free_configuration_reader);
+//! \endcode
+static void free_configuration_reader(void* reader);
+
+//! \fn static void free_scratch_body(void* body)
+//! \brief Frees the heap storage of an exiting thread's scratch body.
+//! \param body Scratch body of the exiting thread.
+//!
+//! This function is the destructor of #scratch_body_key.
+//!
+//! \par Usage example
+//! \code
+//! pthread_key_create(&scratch_body_key, free_scratch_body);
+//! \endcode
+static void free_scratch_body(void* body);
+
+//! \fn static const char* get_cached_timestamp(
+//!   const struct timespec* time,
+//!   const TimeFormat* time_format,
+//!   size_t* timestamp_length
+//! )
+//! \brief Formats a timestamp using the current thread's timestamp cache.
+//! \param time Time to be formatted.
+//! \param time_format Time format used to generate the timestamp.
+//! \param timestamp_length Pointer to where the timestamp's char length is
+//! stored. Must NOT be NULL.
+//! \return Returns the timestamp text. It is NOT null terminated and is only
+//! valid until the next call to this function in the same thread.
+//!
+//! This function returns the timestamp for a time, formatted according to a
+//! time format. The timestamp is only formatted with strftime() when the
+//! second, the time format or the time format's contents change. Otherwise,
+//! the cached timestamp is reused and only it's sub-second digits are
+//! rewritten, if the time format has any.
+//!
+//! Since strftime() has no sub-second conversion, the time format may contain
+//! a single "%N" conversion, which is replaced by the nanoseconds of the time,
+//! or a single "%<digits>N" conversion (e.g: "%3N"), which is replaced by that
+//! many sub-second digits.
+//!
+//! \warning The time format must be protected from changes by the caller
+//! while this function runs.
+//!
+//! \par Usage example
+//! \code
+//! const char *timestamp;
+//! size_t timestamp_length;
+//! struct timespec now;
+//!
+//! clock_gettime(CLOCK_REALTIME, &now);
+//! timestamp = get_cached_timestamp(&now, time_format, &timestamp_length);
+//! fwrite(timestamp, 1, timestamp_length, log_file);
+//! \endcode
+static const char* get_cached_timestamp(
+  const struct timespec* time,
+  const TimeFormat* time_format,
+  size_t* timestamp_length
+);
+
+//! \fn static const LoggerConfiguration* get_configuration()
+//! \brief Returns the Message Logger's current configuration snapshot.
+//! \return Returns the current configuration snapshot. Never NULL.
+//!
+//! This function loads #logger_configuration without any lock. The snapshot
+//! returned is never modified, but may be freed once it's replaced, so it
+//! must only be read between acquire_configuration() and
+//! release_configuration(), or with #logger_configuration_mutex locked. The
+//! default configuration is published the first time this function is called.
+//!
+//! \par Usage example
+//! \code
+//! pthread_mutex_lock(&logger_configuration_mutex);
+//! current = get_configuration();
+//! \endcode
+static const LoggerConfiguration* get_configuration();
+
+//! \fn static ThreadBuffer* get_thread_buffer()
+//! \brief Returns the current thread's buffer, allocating it on first use.
+//! \return Returns the thread's buffer, or NULL if it can't be allocated.
+//!
+//! The first time a thread logs a message with thread buffering enabled, it's
+//! ThreadBuffer is allocated, added to #thread_buffers and associated with
+//! #thread_buffer_key, so it is flushed and released when the thread exits.
+//!
+//! \par Usage example
+//! \code
+//! ThreadBuffer *buffer = get_thread_buffer();
+//! \endcode
+static ThreadBuffer* get_thread_buffer();
+
+//! \fn static int grow_mapped_log_file(size_t required_length)
+//! \brief Allocates disk space for the memory mapped log file.
+//! \param required_length Char length that the file must be able to store.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function allocates as many extents as needed for the memory mapped
+//! log file to store required_length chars. Only one thread grows the file at
+//! a time, and threads that wait for it find the space already allocated.
+//!
+//! \par Usage example
+//! \code
+//! if(offset + length > atomic_load(&mapped_log_file_allocated))
+//!   grow_mapped_log_file(offset + length);
+//! \endcode
+static int grow_mapped_log_file(size_t required_length);
+
+//! \fn static void* log_archive_routine(void* args)
+//! \brief Routine of the thread that archives the rotated log files.
+//! \param args Unused.
+//! \return Returns NULL.
+//!
+//! This function waits for jobs queued by queue_log_archive() and archives
+//! them in order, without holding #log_archive_mutex. When the thread is
+//! stopped, the jobs still queued are archived before it exits.
+//!
+//! \par Usage example
+//! \code
+//! pthread_create(&log_archive_thread, NULL, log_archive_routine, NULL);
+//! \endcode
+static void* log_archive_routine(void* args);
+
+//! \fn static void log_category_message(
+//!   MessageCategory category,
+//!   const char* context,
+//!   const char* fields,
+//!   size_t fields_length,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Logs a message of a given category to the terminal and log file.
+//! \param category Category of the message.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Message's fields, already encoded as a JSON object. Pass a
+//! NULL pointer for a message without fields.
+//! \param fields_length Char length of the message's fields.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function implements the public logging functions (e.g: error()). If
+//! asynchronous logging is enabled, the message is handed over to the async
+//! writer thread. Otherwise, the message's contents are formatted once and the
+//! whole message, including it's escape codes, is assembled in a text buffer
+//! for the terminal and another for the log file. Each of them is then written
+//! with a single call, so the message is never interleaved with other output.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
 //!
-//! int main() {
-//!   int num = 3;
-//!   log_file = fopen("test-logfile.log", "w");
-//!   // Use the question function. The text should be logged correctly.
-//!   question("Number %d: What is the mitochondria?", int);
-//!   fclose(log_file);
-//!   return 0;
+//! \par Usage example
+//! \code
+//! void question(const char* context, const char* text_format, ...) {
+//!   va_list text_args;
+//!   va_start(text_args, text_format);
+//!   log_category_message(INFO_MSG, context, NULL, 0, text_format, text_args);
+//!   va_end(text_args);
 //! }
 //! \endcode
-static void log_formatted_text_content(
-  FILE* log_file,
-  const char* text_format,
-  va_list text_args
+static void log_category_message(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+);
+
+//! \fn static void log_structured_message(
+//!   MessageCategory category,
+//!   const char* context,
+//!   const LogField* fields,
+//!   size_t num_of_fields,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Logs a message of a given category along with it's fields.
+//! \param category Category of the message.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Array of the message's fields.
+//! \param num_of_fields Number of fields in the array.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function implements the structured logging functions (e.g:
+//! error_fields()). The fields are encoded as a JSON object once, in a text
+//! buffer in the stack, and the message is then logged by
+//! log_category_message(), which writes that object to every output.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
+//!
+//! \par Usage example
+//! \code
+//! va_start(arg_list, format);
+//! log_structured_message(ERROR_MSG, context, fields, n, format, arg_list);
+//! va_end(arg_list);
+//! \endcode
+static void log_structured_message(
+  MessageCategory category,
+  const char* context,
+  const LogField* fields,
+  size_t num_of_fields,
+  const char* format,
+  va_list args
+);
+
+//! \fn static void* log_sync_routine(void* args)
+//! \brief Routine of the thread that syncs the log file in the background.
+//! \param args Unused.
+//! \return Returns NULL.
+//!
+//! This function waits for the sync interval of the \link
+//! #log_durability_policy durability policy \endlink to elapse, or for a sync
+//! requested by write_log_file(), and then flushes the log file with the
+//! logger lock held. The log file's descriptor is duplicated, so it can be
+//! synced after the lock is released, even if the log file is closed or
+//! rotated meanwhile.
+//!
+//! \par Usage example
+//! \code
+//! pthread_create(&log_sync_thread, NULL, log_sync_routine, NULL);
+//! \endcode
+static void* log_sync_routine(void* args);
+
+//! \fn static size_t parse_format_conversion(
+//!   const char* text,
+//!   FormatConversion* conversion
+//! )
+//! \brief Parses a printf conversion specification.
+//! \param text Text starting with the conversion's "%" character.
+//! \param conversion Pointer to where the parsed conversion is stored.
+//! \return Returns the char length of the conversion specification.
+//!
+//! This function parses the flags, width, precision, length modifier and
+//! conversion character of a conversion specification. Conversions that can't
+//! be stored in a binary log file, such as "%n", wide characters, positional
+//! arguments or specifications longer than #MAX_CONVERSION_LENGTH, have the
+//! #UNSUPPORTED_ARGUMENT type.
+//!
+//! \par Usage example
+//! \code
+//! FormatConversion conversion;
+//! size_t length = parse_format_conversion("%-5.2lf", &conversion);
+//! \endcode
+static size_t parse_format_conversion(
+  const char* text,
+  FormatConversion* conversion
+);
+
+//! \fn static void lock_logger()
+//! \brief Acquires the logger lock if thread safety is enabled.
+//!
+//! This function locks #logger_mutex the first time it is called by a thread
+//! and only counts the nested calls afterwards, in #logger_lock_depth. This
+//! lets a thread that holds the lock, such as one in a batch started by
+//! begin_logger_batch(), log messages without locking the mutex again, while
+//! the mutex itself doesn't need to be recursive. The mutex is only locked if
+//! logger_lock_needed() says so, which is also checked by nested calls in case
+//! a thread was created meanwhile.
+//!
+//! \par Usage example
+//! \code
+//! lock_logger();
+//! // Access the Message Logger's shared state...
+//! unlock_logger();
+//! \endcode
+static void lock_logger();
+
+//! \fn static int logger_lock_needed()
+//! \brief Checks whether the logger lock must be taken.
+//! \return Returns 1 if the lock must be taken and 0 otherwise.
+//!
+//! The lock is needed once thread safety is enabled and, where the C library
+//! tracks it, as soon as the program creates it's first thread, so the
+//! Message Logger is safe even if enable_thread_safety() is never called.
+//! Single-threaded programs only pay for two loads.
+//!
+//! \par Usage example
+//! \code
+//! if(logger_lock_needed())
+//!   pthread_mutex_lock(&logger_mutex);
+//! \endcode
+static int logger_lock_needed();
+
+//! \fn static void prune_timestamped_archives(
+//!   const char* file_name,
+//!   unsigned int max_archives
+//! )
+//! \brief Deletes the oldest timestamped archives of a log file.
+//! \param file_name Name of the log file.
+//! \param max_archives Max number of archives kept.
+//!
+//! This function lists the timestamped archives of the log file and deletes
+//! the oldest ones until at most max_archives remain. Since the archives'
+//! timestamps start with the year, the alphabetical order of their names is
+//! also their chronological order.
+//!
+//! \par Usage example
+//! \code
+//! rename(staged_name, "logger-test.log.20191231-235959");
+//! prune_timestamped_archives("logger-test.log", 7);
+//! \endcode
+static void prune_timestamped_archives(
+  const char* file_name,
+  unsigned int max_archives
 );
 
-//! \fn static void log_message(
-//!   FILE* log_file,
-//!   TimeFormat* time_format,
-//!   const char* msg_context,
-//!   const char* msg_type,
-//!   const char* msg_format,
-//!   va_list msg_args
-//! )
-//! \brief Writes a text message with it's timestamp information to a log file.
-//! Log file pointer must NOT be NULL.
-//! \param log_file File where message will be logged. Must NOT be NULL.
-//! \param time_format Time format used to generate timestamp in the log file.
-//! \param msg_context Text containing the message's caller context. Pass a
-//! NULL pointer to log a message without context.
-//! \param msg_type Text that identifies the type of message logged.
-//! \param msg_format Message's text format without substitution arguments.
-//! \param msg_args Arguments to substitute in message's text format.
-//!
-//! This function writes a timestamped message to a log file. The timestamp
-//! formatting and contents is determined by the time_format argument. To log a
-//! message, the conventional structure of context, type and format is
-//! required, as this structure is used by all default message types provided
-//! by the Message Logger module.
-//!
-//! If we indicate the contents of a variable by "${VARIABLE}", we can state
-//! that a typical message logged will appear like so:
-//! \verbatim [${TIMESTAMP}] ${CONTEXT}: ${TYPE} ${MESSAGE_TEXT} \endverbatim
-//!
-//! An example of a logged message in the sample file appears below:
-//! \verbatim [23:17:15] Main: (Success) Thread 1 finished! \endverbatim
-//!
-//! \note The va_list provided as an argument for this function is NOT rendered
-//! unusable by this function! All functions called by this function and that
-//! utilize the va_list argument should make a local copy of it, allowing other
-//! functions to reuse it. However, this implies that the memory cleaning for
-//! the va_list achieved with va_end() is a task that this function does NOT
-//! handle!
-//!
-//! \warning This function should receive a log_file pointer that is NOT NULL
-//! to work as expected. Otherwise, it will have NO EFFECT!
-//!
-//! \par Usage example
-//! \code
-//! FILE *log_file;
-//! TimeFormat time_format = {
-//!   .string_representation = "%H:%M:%S"
-//! };
-//!
-//! void question(const char* context, const char* text_format, ...) {
-//!   va_list text_args;
-//!   va_start(text_args, text_format);
-//!   log_message(
-//!     log_file,
-//!     &time_format,
-//!     context,
-//!     "(Question)",
-//!     text_format,
-//!     text_args
-//!   );
-//!   va_end(text_args);
-//! }
-//!
-//! int main() {
-//!   int num = 3;
-//!   log_file = fopen("test-logfile.log", "w");
-//!   // Use the question function. The question should be logged correctly in
-//!   // the expected message format and with a timestamp.
-//!   question("Biology test", "Number %d: What is the mitochondria?", int);
-//!   fclose(log_file);
-//!   return 0;
-//! }
-//! \endcode
-static void log_message(
-  FILE* log_file,
-  TimeFormat* time_format,
-  const char* msg_context,
-  const char* msg_type,
-  const char* msg_format,
-  va_list msg_args
-);
+//! \fn static void queue_log_archive(LogArchiveJob* job)
+//! \brief Hands a rotated log file over to the archive thread.
+//! \param job Job describing the rotated log file.
+//!
+//! This function appends the job to the archive queue and wakes the archive
+//! thread up, starting it when the first log file is rotated. If the thread
+//! can't be started, the log file is archived by the calling thread.
+//!
+//! \par Usage example
+//! \code
+//! queue_log_archive(job);
+//! \endcode
+static void queue_log_archive(LogArchiveJob* job);
+
+//! \fn static void register_file_buffers_flush()
+//! \brief Registers flush_file_buffers() to run at exit.
+//!
+//! \par Usage example
+//! \code
+//! pthread_once(&file_buffers_exit_once, register_file_buffers_flush);
+//! \endcode
+static void register_file_buffers_flush();
+
+//! \fn static void release_configuration()
+//! \brief Releases the snapshot returned by acquire_configuration().
+//!
+//! \par Usage example
+//! \code
+//! release_configuration();
+//! \endcode
+static void release_configuration();
+
+//! \fn static void publish_configuration(LoggerConfiguration* configuration)
+//! \brief Finishes a change to the Message Logger's configuration snapshot.
+//! \param configuration Modified copy returned by begin_configuration_update().
+//!
+//! This function publishes the modified snapshot, so readers that load it also
+//! see it's contents, moves the replaced snapshot to
+//! #logger_retired_configurations, frees the replaced snapshots that no
+//! #ConfigurationReader holds and releases #logger_configuration_mutex.
+//!
+//! \par Usage example
+//! \code
+//! publish_configuration(configuration);
+//! \endcode
+static void publish_configuration(LoggerConfiguration* configuration);
+
+//! \fn static void publish_default_configuration()
+//! \brief Renders and publishes the default configuration snapshot.
+//!
+//! This function is run once, through #logger_configuration_once, the first
+//! time the configuration is used.
+//!
+//! \par Usage example
+//! \code
+//! pthread_once(&logger_configuration_once, publish_default_configuration);
+//! \endcode
+static void publish_default_configuration();
+
+//! \fn static int read_binary_log(FILE* file, void* data, size_t length)
+//! \brief Reads some bytes from a binary log file.
+//! \param file Binary log file.
+//! \param data Pointer to where the bytes are stored.
+//! \param length Number of bytes to be read.
+//! \return Returns 0 when successfully executed and -1 if the file ends
+//! before the bytes are read.
+//!
+//! \par Usage example
+//! \code
+//! uint32_t id;
+//! read_binary_log(file, &id, sizeof(id));
+//! \endcode
+static int read_binary_log(FILE* file, void* data, size_t length);
+
+//! \fn static int read_binary_text(
+//!   FILE* file,
+//!   TextBuffer* buffer,
+//!   uint32_t length
+//! )
+//! \brief Reads a text from a binary log file into a text buffer.
+//! \param file Binary log file.
+//! \param buffer Text buffer where the text is appended.
+//! \param length Char length of the text.
+//! \return Returns 0 when successfully executed and -1 if the text can't be
+//! read.
+//!
+//! The text is followed by a null terminator in the buffer, which is not
+//! counted in the buffer's length.
+//!
+//! \par Usage example
+//! \code
+//! read_binary_text(file, &context, context_length);
+//! \endcode
+static int read_binary_text(FILE* file, TextBuffer* buffer, uint32_t length);
+
+//! \fn static int read_flight_record(
+//!   const FlightRecorder* recorder,
+//!   size_t position,
+//!   FlightRecord* copy
+//! )
+//! \brief Copies a record of another thread's flight recorder.
+//! \param recorder Flight recorder with the record.
+//! \param position Position of the record.
+//! \param copy Storage for the copy.
+//! \return Returns 0 when the record is copied and -1 if it was overwritten.
+//!
+//! The record's sequence number is checked before and after it's copied, so
+//! a record overwritten while it's copied is discarded.
+//!
+//! \par Usage example
+//! \code
+//! if(read_flight_record(recorder, recorder->dump_position, &copy) == 0)
+//!   render_log_file_line(&file_batch, &record, file_format);
+//! \endcode
+static int read_flight_record(
+  const FlightRecorder* recorder,
+  size_t position,
+  FlightRecord* copy
+);
+
+//! \fn static void record_flight_message(
+//!   MessageCategory category,
+//!   const char* context,
+//!   const char* fields,
+//!   size_t fields_length,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Keeps a message that isn't written to the log file in the flight
+//! recorder.
+//! \param category Category of the message.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param fields Message's fields, as a JSON object. Pass a NULL pointer for a
+//! message without fields.
+//! \param fields_length Char length of the message's fields.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function formats the message's contents straight into the oldest
+//! record of the calling thread's #FlightRecorder, without any lock. Messages
+//! longer than #FLIGHT_RECORD_SIZE are truncated.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
+//!
+//! \par Usage example
+//! \code
+//! record_flight_message(INFO_MSG, context, NULL, 0, format, args);
+//! \endcode
+static void record_flight_message(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+);
+
+//! \fn static void record_flight_record(const LogRecord* record, int logged)
+//! \brief Keeps a message already formatted for the other outputs in the
+//! flight recorder.
+//! \param record Message to be kept.
+//! \param logged Whether the message is also written to the log file.
+//!
+//! This function copies the message's text over the oldest record of the
+//! calling thread's #FlightRecorder, without any lock, truncating it like
+//! record_flight_message().
+//!
+//! \par Usage example
+//! \code
+//! record_flight_record(&record, log_file != NULL);
+//! \endcode
+static void record_flight_record(const LogRecord* record, int logged);
+
+//! \fn static void release_crash_lock(atomic_flag* lock)
+//! \brief Releases a crash lock taken by acquire_crash_lock() or
+//! try_crash_lock().
+//! \param lock Crash lock to be released.
+//!
+//! \par Usage example
+//! \code
+//! release_crash_lock(&buffer->crash_lock);
+//! \endcode
+static void release_crash_lock(atomic_flag* lock);
+
+//! \fn static void release_flight_recorder(void* recorder)
+//! \brief Releases an exiting thread's #FlightRecorder, so another thread
+//! can claim it. It's records are kept until they are overwritten.
+//! \param recorder Flight recorder of the exiting thread.
+//!
+//! This function is the destructor of #flight_recorder_key.
+//!
+//! \par Usage example
+//! \code
+//! pthread_key_create(&flight_recorder_key, release_flight_recorder);
+//! \endcode
+static void release_flight_recorder(void* recorder);
+
+//! \fn static void release_scratch_body(TextBuffer* body)
+//! \brief Releases the storage where a message's contents were formatted.
+//! \param body Text buffer with the message's contents, either the scratch
+//! body returned by acquire_scratch_body() or a text buffer of the caller.
+//!
+//! The scratch body keeps it's storage for the thread's next message, unless
+//! it grew beyond #MAX_SCRATCH_BODY_SIZE. Other text buffers are released with
+//! text_buffer_release().
+//!
+//! \par Usage example
+//! \code
+//! release_scratch_body(body);
+//! \endcode
+static void release_scratch_body(TextBuffer* body);
+
+//! \fn static void release_thread_buffer(void* buffer)
+//! \brief Flushes and releases a thread buffer when it's thread exits.
+//! \param buffer Thread buffer to be released.
+//!
+//! This function is the destructor of #thread_buffer_key. It removes the
+//! buffer from #thread_buffers, writes it's remaining messages and frees it.
+//!
+//! \par Usage example
+//! \code
+//! pthread_key_create(&thread_buffer_key, release_thread_buffer);
+//! \endcode
+static void release_thread_buffer(void* buffer);
+
+//! \fn static void render_console_record(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record,
+//!   int colors
+//! )
+//! \brief Appends a message, as displayed on the terminal, to a text buffer.
+//! \param buffer Text buffer where the message is appended.
+//! \param record Message to be appended.
+//! \param colors Whether the display colors' escape codes are appended.
+//!
+//! This function appends to a text buffer the exact same text that the
+//! Message Logger writes to the terminal for a message: the colored context
+//! tag, the colored message tag and the colored message contents, followed by
+//! the escape codes that reset the terminal's colors. The colors used are
+//! taken from the current configuration snapshot's display prefixes.
+//!
+//! \par Usage example
+//! \code
+//! render_console_record(&console_batch, &record, colors_enabled());
+//! fwrite(console_batch.data, 1, console_batch.length, stdout);
+//! \endcode
+static void render_console_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  int colors
+);
+
+//! \fn static size_t render_crash_json_string(
+//!   char* destination,
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Renders a text as a JSON string from a crash handler.
+//! \param destination Array where the JSON string is rendered. Must fit 6
+//! chars for each char of the text, plus 2.
+//! \param text Text to be rendered.
+//! \param text_length Char length of the text.
+//! \return Returns the char length of the rendered JSON string.
+//!
+//! This function escapes the text like text_buffer_append_json_string(), but
+//! into a fixed size array, so it's async-signal-safe.
+//!
+//! \par Usage example
+//! \code
+//! length += render_crash_json_string(json + length, body, body_length);
+//! \endcode
+static size_t render_crash_json_string(
+  char* destination,
+  const char* text,
+  size_t text_length
+);
+
+//! \fn static void render_display_prefixes(
+//!   LoggerConfiguration* configuration
+//! )
+//! \brief Renders the display prefixes for every message and tag category.
+//! \param configuration Configuration snapshot whose prefixes are rendered.
+//!
+//! This function renders the escape codes that apply the display colors of
+//! each message and tag category in a configuration snapshot's color pallet
+//! to it's msg_prefixes and tag_prefixes. It must be called every time the
+//! color pallet changes, before the snapshot is published, so that logging a
+//! message only needs to copy the rendered prefixes instead of looking up and
+//! concatenating escape codes.
+//!
+//! \par Usage example
+//! \code
+//! configuration->color_pallet.tag_colors[INFO_TAG].text_color = B_WHT;
+//! render_display_prefixes(configuration);
+//! publish_configuration(configuration);
+//! \endcode
+static void render_display_prefixes(LoggerConfiguration* configuration);
+
+//! \fn static void render_file_record(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record,
+//!   const TimeFormat* time_format
+//! )
+//! \brief Appends a message, as written to a log file, to a text buffer.
+//! \param buffer Text buffer where the message is appended.
+//! \param record Message to be appended.
+//! \param time_format Time format used to generate the message's timestamp.
+//!
+//! This function appends to a text buffer the text written to a log file for a
+//! message, using the time when the message was logged for it's timestamp. The
+//! timestamp formatting and contents is determined by the time_format
+//! argument.
+//!
+//! If we indicate the contents of a variable by "${VARIABLE}", we can state
+//! that a typical message logged will appear like so:
+//! \verbatim [${TIMESTAMP}] ${CONTEXT}: ${TYPE} ${MESSAGE_TEXT} \endverbatim
+//!
+//! An example of a logged message in the sample file appears below:
+//! \verbatim [23:17:15] Main: (Success) Thread 1 finished! \endverbatim
+//!
+//! \par Usage example
+//! \code
+//! render_file_record(&file_batch, &record, &configuration->time_format);
+//! fwrite(file_batch.data, 1, file_batch.length, log_file);
+//! \endcode
+static void render_file_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  const TimeFormat* time_format
+);
+
+//! \fn static void render_json_record(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record
+//! )
+//! \brief Renders a message as a line of a JSON Lines log file.
+//! \param buffer Text buffer where the line is appended.
+//! \param record Message to be rendered.
+//!
+//! This function renders the message as a JSON object with it's timestamp, in
+//! seconds since the epoch, it's category's name, context, contents and
+//! fields, followed by a newline. A single newline that ends the contents is
+//! left out, since the line already ends with one.
+//!
+//! \par Usage example
+//! \code
+//! render_json_record(&file_line, &record);
+//! \endcode
+static void render_json_record(TextBuffer* buffer, const LogRecord* record);
+
+//! \fn static void render_log_fields(
+//!   TextBuffer* buffer,
+//!   const LogField* fields,
+//!   size_t num_of_fields
+//! )
+//! \brief Encodes a message's fields as a JSON object.
+//! \param buffer Text buffer where the object is appended.
+//! \param fields Array of the message's fields.
+//! \param num_of_fields Number of fields in the array.
+//!
+//! Keys and string values are escaped with text_buffer_append_json_string()
+//! and integers are converted with text_buffer_append_decimal(), so encoding
+//! only allocates memory if the buffer's storage is too small. Floating point
+//! values use the shortest of 15 or 17 significant digits that reads back as
+//! the same value, and non finite values are written as null.
+//!
+//! \par Usage example
+//! \code
+//! render_log_fields(&fields_text, fields, num_of_fields);
+//! \endcode
+static void render_log_fields(
+  TextBuffer* buffer,
+  const LogField* fields,
+  size_t num_of_fields
+);
+
+//! \fn static void render_log_file_line(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record,
+//!   LogFileFormat file_format
+//! )
+//! \brief Renders a message as a line of the log file.
+//! \param buffer Text buffer where the line is appended.
+//! \param record Message to be rendered.
+//! \param file_format Format of the log file.
+//!
+//! Text log files are rendered with render_file_record(), using the Message
+//! Logger's time format, and JSON Lines log files with render_json_record().
+//!
+//! \par Usage example
+//! \code
+//! render_log_file_line(&file_line, &record, TEXT_LOG_FILE);
+//! \endcode
+static void render_log_file_line(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  LogFileFormat file_format
+);
+
+//! \fn static void render_record_body(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record
+//! )
+//! \brief Renders a message's contents and fields as text.
+//! \param buffer Text buffer where the text is appended.
+//! \param record Message to be rendered.
+//!
+//! The fields' JSON object is rendered after the contents, separated by a
+//! space, and before the newline that ends the contents, if there is one.
+//!
+//! \par Usage example
+//! \code
+//! render_record_body(&console_line, &record);
+//! \endcode
+static void render_record_body(TextBuffer* buffer, const LogRecord* record);
+
+//! \fn static void render_sink_record(
+//!   TextBuffer* buffer,
+//!   const LogRecord* record,
+//!   const LogSink* sink
+//! )
+//! \brief Appends a message, as written to a log sink, to a text buffer.
+//! \param buffer Text buffer where the message is appended.
+//! \param record Message to be appended.
+//! \param sink Log sink whose colors and timestamp are used.
+//!
+//! This function appends the sink's timestamp, if it has one, followed by the
+//! message as displayed on the terminal, with or without the sink's colors. A
+//! sink without colors that uses the Message Logger's time format gets the
+//! same text as the log file.
+//!
+//! \par Usage example
+//! \code
+//! render_sink_record(&lines, &record, &log_sinks[i]);
+//! \endcode
+static void render_sink_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  const LogSink* sink
+);
+
+//! \fn static void rotate_log_file(time_t now)
+//! \brief Archives the log file and opens a new one with the same name.
+//! \param now Current time, used to name timestamped archives and to
+//! schedule the next periodic rotation.
+//!
+//! This function renames the log file to a unique staging name and opens a
+//! new, empty log file in it's place. Closing the rotated log file and
+//! archiving it according to the \link #log_rotation_policy log rotation
+//! policy \endlink is left to the archive thread, so messages only wait for
+//! one rename. If the log file can't be renamed, an error message is printed
+//! and messages keep being written to it until it's rotated again. If the new
+//! log file can't be opened, an error message is printed and messages are no
+//! longer written to a log file.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled, and with a log file configured.
+//!
+//! \par Usage example
+//! \code
+//! if(log_file_size + length > log_rotation_policy.max_file_size)
+//!   rotate_log_file(time(NULL));
+//! \endcode
+static void rotate_log_file(time_t now);
+
+//! \fn static JsonEscapeScanner select_json_escape_scanner()
+//! \brief Chooses the fastest #JsonEscapeScanner supported by the processor.
+//! \return Returns the chosen scanner.
+//!
+//! This function picks the AVX2, SSE2 or portable scanner, in this order of
+//! preference, according to the processor the program runs on, and stores it
+//! in #json_escape_scanner, so the choice is only made once. Concurrent calls
+//! make the same choice.
+//!
+//! \par Usage example
+//! \code
+//! if(scanner == NULL)
+//!   scanner = select_json_escape_scanner();
+//! \endcode
+static JsonEscapeScanner select_json_escape_scanner();
+
+//! \fn static void stop_log_archive_thread()
+//! \brief Stops the log file's archive thread, if it is running, after it
+//! archives every rotated log file.
+//!
+//! \par Usage example
+//! \code
+//! stop_log_archive_thread();
+//! \endcode
+static void stop_log_archive_thread();
+
+//! \fn static void stop_log_sync_thread()
+//! \brief Stops the log file's sync thread, if it is running.
+//!
+//! \warning This function must NOT be called with the logger lock held.
+//!
+//! \par Usage example
+//! \code
+//! stop_log_sync_thread();
+//! \endcode
+static void stop_log_sync_thread();
+
+//! \fn static void sync_log_file()
+//! \brief Flushes the log file and waits for it to be written to disk.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! if(category == ERROR_MSG && log_durability_policy.sync_errors)
+//!   sync_log_file();
+//! \endcode
+static void sync_log_file();
+
+//! \fn static void text_buffer_append(
+//!   TextBuffer* buffer,
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Appends a text to a text buffer, growing it if necessary.
+//! \param buffer Text buffer where the text is appended.
+//! \param text Text to be appended. Does NOT need to be null terminated.
+//! \param text_length Char length of the text to be appended.
+//!
+//! This function appends a text to the end of a text buffer. If the buffer's
+//! storage is not large enough, it is grown with text_buffer_reserve(). If the
+//! buffer can't be grown, the text is truncated to the available storage.
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_append(&buffer, "(Info) ", 7);
+//! \endcode
+static void text_buffer_append(
+  TextBuffer* buffer,
+  const char* text,
+  size_t text_length
+);
+
+//! \fn static void text_buffer_append_decimal(
+//!   TextBuffer* buffer,
+//!   unsigned long long value
+//! )
+//! \brief Appends the decimal digits of an integer to a text buffer.
+//! \param buffer Text buffer where the digits are appended.
+//! \param value Integer to be appended.
+//!
+//! The digits are converted from the least significant one into a small array
+//! in the stack, without parsing a format string.
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_append(&buffer, "-", 1);
+//! text_buffer_append_decimal(&buffer, -(unsigned long long) value);
+//! \endcode
+static void text_buffer_append_decimal(
+  TextBuffer* buffer,
+  unsigned long long value
+);
+
+//! \fn static void text_buffer_append_formatted(
+//!   TextBuffer* buffer,
+//!   const char* text_format,
+//!   va_list text_args
+//! )
+//! \brief Appends a formatted text with it's arguments to a text buffer.
+//! \param buffer Text buffer where the text is appended.
+//! \param text_format String formatting for the text's contents before
+//! argument substitution takes place.
+//! \param text_args Arguments used to substitute placeholders in the text's
+//! contents.
+//!
+//! This function formats a text with format_message_text() directly into the
+//! free storage of a text buffer. If the formatted text doesn't fit, the
+//! buffer is grown and the text is formatted again.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
+//!
+//! \par Usage example
+//! \code
+//! void question(TextBuffer* buffer, const char* text_format, ...) {
+//!   va_list text_args;
+//!   va_start(text_args, text_format);
+//!   text_buffer_append_formatted(buffer, text_format, text_args);
+//!   va_end(text_args);
+//! }
+//! \endcode
+static void text_buffer_append_formatted(
+  TextBuffer* buffer,
+  const char* text_format,
+  va_list text_args
+);
+
+//! \fn static void text_buffer_append_json_string(
+//!   TextBuffer* buffer,
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Appends a text to a text buffer as a quoted JSON string.
+//! \param buffer Text buffer where the string is appended.
+//! \param text Text to be appended. Does NOT need to be null terminated.
+//! \param text_length Char length of the text to be appended.
+//!
+//! Quotes, backslashes and control characters (including the escape character
+//! of ANSI escape codes) are escaped. The chars to escape are found by the
+//! #json_escape_scanner, which checks many chars at once with vector
+//! instructions where available, and the runs of chars between them are
+//! appended at once. Other bytes are copied as they are, so UTF-8 text is
+//! kept.
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_append_json_string(&buffer, record->body, record->body_length);
+//! \endcode
+static void text_buffer_append_json_string(
+  TextBuffer* buffer,
+  const char* text,
+  size_t text_length
+);
+
+//! \fn static void text_buffer_append_printf(
+//!   TextBuffer* buffer,
+//!   const char* text_format,
+//!   ...
+//! )
+//! \brief Appends a formatted text to a text buffer.
+//! \param buffer Text buffer where the text is appended.
+//! \param text_format String formatting for the text's contents before
+//! argument substitution takes place.
+//!
+//! This function is a variadic shorthand for text_buffer_append_formatted().
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_append_printf(&buffer, "%.2f", 3.14159);
+//! \endcode
+static void text_buffer_append_printf(
+  TextBuffer* buffer,
+  const char* text_format,
+  ...
+);
+
+//! \fn static void text_buffer_append_string(
+//!   TextBuffer* buffer,
+//!   const char* text
+//! )
+//! \brief Appends a null terminated text to a text buffer.
+//! \param buffer Text buffer where the text is appended.
+//! \param text Null terminated text to be appended.
+//!
+//! This function is a shorthand for text_buffer_append() when the length of
+//! the appended text is not known beforehand.
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_append_string(&buffer, message_tags[ERROR_MSG]);
+//! \endcode
+static void text_buffer_append_string(TextBuffer* buffer, const char* text);
+
+//! \fn static void text_buffer_init(
+//!   TextBuffer* buffer,
+//!   char* storage,
+//!   size_t capacity
+//! )
+//! \brief Initializes an empty text buffer with some initial storage.
+//! \param buffer Text buffer to be initialized.
+//! \param storage Initial storage for the buffer. Must NOT be NULL and must
+//! NOT be freed by the user while the buffer is used.
+//! \param capacity Char length of the initial storage. Must NOT be zero.
+//!
+//! \note A text buffer that grew past it's initial storage must be released
+//! with text_buffer_release() after it is no longer used.
+//!
+//! \par Usage example
+//! \code
+//! char storage[512];
+//! TextBuffer buffer;
+//!
+//! text_buffer_init(&buffer, storage, sizeof(storage));
+//! // Use the text buffer...
+//! text_buffer_release(&buffer);
+//! \endcode
+static void text_buffer_init(
+  TextBuffer* buffer,
+  char* storage,
+  size_t capacity
+);
+
+//! \fn static void text_buffer_release(TextBuffer* buffer)
+//! \brief Releases any heap memory allocated by a text buffer.
+//! \param buffer Text buffer to be released.
+//!
+//! This function frees the storage of a text buffer if it was allocated in the
+//! heap. The buffer must be initialized again before it is reused.
+//!
+//! \par Usage example
+//! \code
+//! text_buffer_release(&buffer);
+//! \endcode
+static void text_buffer_release(TextBuffer* buffer);
+
+//! \fn static int text_buffer_reserve(TextBuffer* buffer, size_t additional)
+//! \brief Ensures a text buffer can store some additional chars.
+//! \param buffer Text buffer to be grown.
+//! \param additional Number of chars to be appended to the buffer.
+//! \return Returns 0 when successfully executed and -1 if an error occurs.
+//!
+//! This function grows the storage of a text buffer, if needed, so it is able
+//! to store it's current text, the additional chars and a null terminator. The
+//! storage is at least doubled every time it grows.
+//!
+//! \par Usage example
+//! \code
+//! if(text_buffer_reserve(&buffer, 100) == 0)
+//!   buffer.length += snprintf(buffer.data + buffer.length, 101, "...");
+//! \endcode
+static int text_buffer_reserve(TextBuffer* buffer, size_t additional);
+
+//! \fn static int try_crash_lock(atomic_flag* lock)
+//! \brief Takes a crash lock from a crash handler, if it's released soon.
+//! \param lock Crash lock to be taken.
+//! \return Returns 0 if the lock was taken and -1 otherwise.
+//!
+//! This function makes #CRASH_LOCK_ATTEMPTS attempts a millisecond apart,
+//! sleeping with nanosleep(), so it is async-signal-safe.
+//!
+//! \par Usage example
+//! \code
+//! if(try_crash_lock(&buffer->crash_lock) == 0) {
+//!   write_crash_text(descriptor, buffer->data, buffer->length);
+//!   release_crash_lock(&buffer->crash_lock);
+//! }
+//! \endcode
+static int try_crash_lock(atomic_flag* lock);
+
+//! \fn static void unlock_logger()
+//! \brief Releases the logger lock if thread safety is enabled.
+//!
+//! This function undoes a call to lock_logger(), unlocking #logger_mutex once
+//! every nested call was undone.
+//!
+//! \par Usage example
+//! \code
+//! lock_logger();
+//! // Access the Message Logger's shared state...
+//! unlock_logger();
+//! \endcode
+static void unlock_logger();
+
+//! \fn static void update_log_sink_variants()
+//! \brief Groups the log sinks that render messages the same way.
+//!
+//! This function sets each sink's variant to the index of the first sink with
+//! the same colors and timestamp. It must be called every time a sink is
+//! attached or detached.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! update_log_sink_variants();
+//! \endcode
+static void update_log_sink_variants();
+
+//! \fn static void write_binary_record(
+//!   MessageCategory category,
+//!   const char* context,
+//!   const char* format,
+//!   va_list args
+//! )
+//! \brief Writes a message to the binary log file without formatting it.
+//! \param category Category of the message.
+//! \param context Text containing the message's caller context. Pass a NULL
+//! pointer for a message without context.
+//! \param format Message's text format without substitution arguments.
+//! \param args Arguments to substitute in message's text format.
+//!
+//! This function writes a message record with the message's timestamp,
+//! category, context, format string identifier and the raw bytes of each of
+//! it's arguments, as described by the format string's cached conversions.
+//! If the format string can't be recorded, the message is formatted and
+//! written as a text record instead. When the time format changed since the
+//! last message, a time format record is written first.
+//!
+//! \note The va_list provided as an argument for this function is NOT rendered
+//! unusable by this function! A local copy of the va_list argument is made,
+//! allowing other functions to reuse it. However, this implies that the memory
+//! cleaning for the va_list achieved with va_end() is a task that this
+//! function does NOT handle!
+//!
+//! \par Usage example
+//! \code
+//! if(binary_log_file != NULL)
+//!   write_binary_record(category, context, format, args);
+//! \endcode
+static void write_binary_record(
+  MessageCategory category,
+  const char* context,
+  const char* format,
+  va_list args
+);
+
+//! \fn static int write_crash_record(
+//!   const AsyncRecordSlot* slot,
+//!   size_t position,
+//!   int file_descriptor
+//! )
+//! \brief Writes a message of the async logging ring buffer from a crash
+//! handler.
+//! \param slot Ring buffer slot with the message.
+//! \param position Ring buffer position of the message.
+//! \param file_descriptor Descriptor of the log file. -1 if there is none.
+//! \return Returns 0 when the message is written and -1 if it's slot was
+//! consumed meanwhile.
+//!
+//! This function renders the message without colors, prefixed by it's time in
+//! seconds since the epoch instead of the time format, since formatting times
+//! is NOT async-signal-safe. The slot is only read while it's sequence shows
+//! it holds the message, so a message consumed by the writer thread while
+//! it's rendered is not written. The message is written to the terminal, if
+//! the console output is enabled, and to the log file, as a JSON object with
+//! the same timestamp if the log file's format is #JSON_LOG_FILE.
+//!
+//! \par Usage example
+//! \code
+//! write_crash_record(&async_ring[position & async_ring_mask], position, -1);
+//! \endcode
+static int write_crash_record(
+  const AsyncRecordSlot* slot,
+  size_t position,
+  int file_descriptor
+);
+
+//! \fn static void write_crash_text(
+//!   int descriptor,
+//!   const char* text,
+//!   size_t text_length
+//! )
+//! \brief Writes a whole text to a file descriptor from a crash handler.
+//! \param descriptor File descriptor written to.
+//! \param text Text to be written. Does NOT need to be null terminated.
+//! \param text_length Char length of the text to be written.
+//!
+//! This function only calls write(), retrying partial writes and interrupted
+//! calls, so it is async-signal-safe.
+//!
+//! \par Usage example
+//! \code
+//! write_crash_text(STDOUT_FILENO, buffer->file.data, buffer->file.length);
+//! \endcode
+static void write_crash_text(
+  int descriptor,
+  const char* text,
+  size_t text_length
+);
+
+//! \fn static void write_file_buffer(
+//!   FileBuffer* buffer,
+//!   FILE* stream,
+//!   const void* data,
+//!   size_t length
+//! )
+//! \brief Writes data to a log file through it's #FileBuffer.
+//! \param buffer File buffer of the log file.
+//! \param stream Stream of the log file.
+//! \param data Data to be written.
+//! \param length Char length of the data to be written.
+//!
+//! This function appends the data to the buffer, writing the buffer to the
+//! stream first if the data doesn't fit. Data that doesn't fit an empty buffer
+//! is written directly.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! write_file_buffer(&log_file_buffer, log_file, text, text_length);
+//! \endcode
+static void write_file_buffer(
+  FileBuffer* buffer,
+  FILE* stream,
+  const void* data,
+  size_t length
+);
+
+//! \fn static void write_flight_records()
+//! \brief Writes the flight recorder's messages to the log file.
+//!
+//! This function writes, oldest first, the messages kept by the flight
+//! recorders of every thread that were not written to the log file when they
+//! were logged (e.g: because their category was disabled), in the log file's
+//! format. The messages are then discarded, so each of them is written at
+//! most once. Messages pending in the async logging ring buffer are written
+//! first, with the logger lock held until the dump is written, so the dump
+//! isn't interleaved with them. Does nothing if no log file is configured.
+//!
+//! \par Usage example
+//! \code
+//! if(category == ERROR_MSG)
+//!   write_flight_records(); // Before the error is written.
+//! \endcode
+static void write_flight_records();
+
+//! \fn static void write_log_file(
+//!   const char* text,
+//!   size_t text_length,
+//!   time_t now
+//! )
+//! \brief Writes a text to the log file, rotating it if necessary.
+//! \param text Text to be written. Does NOT need to be null terminated.
+//! \param text_length Char length of the text to be written.
+//! \param now Time of the text's messages, used to check for periodic
+//! rotations.
+//!
+//! This function writes a text, which may contain one or many messages, to the
+//! log file with a single call. Before writing, it checks the \link
+//! #log_rotation_policy log rotation policy \endlink and rotates the log file
+//! if the text would make it larger than the max file size or if the rotation
+//! interval has elapsed. Both checks are integer comparisons against
+//! #log_file_size and #log_file_rotation_time.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled, and with a log file configured.
+//!
+//! \par Usage example
+//! \code
+//! write_log_file(file_line.data, file_line.length, record.timestamp.tv_sec);
+//! \endcode
+static void write_log_file(const char* text, size_t text_length, time_t now);
+
+//! \fn static void write_log_sinks(
+//!   const LogRecord* record,
+//!   const TextBuffer* console_line,
+//!   const TextBuffer* file_line
+//! )
+//! \brief Writes a message to every log sink of it's category.
+//! \param record Message to be written.
+//! \param console_line Message already rendered for the terminal. May be NULL.
+//! \param file_line Message already rendered for the log file. May be NULL.
+//!
+//! This function renders the message once for each variant of the log sinks
+//! that accept it's category, into a single text buffer, and writes the text
+//! of it's variant to each sink. Sinks that render messages exactly like the
+//! terminal or the log file reuse console_line or file_line instead. Callback
+//! sinks receive a LogRecordView of the record itself, without rendering.
+//!
+//! \warning This function must be called with the logger lock held
+//! if thread safety is enabled.
+//!
+//! \par Usage example
+//! \code
+//! if(num_of_log_sinks > 0)
+//!   write_log_sinks(&record, &console_line, &file_line);
+//! \endcode
+static void write_log_sinks(
+  const LogRecord* record,
+  const TextBuffer* console_line,
+  const TextBuffer* file_line
+);
+
+//! \fn static void write_mapped_log_file(const char* text, size_t text_length)
+//! \brief Writes a text to the memory mapped log file.
+//! \param text Text to be written. Does NOT need to be null terminated.
+//! \param text_length Char length of the text to be written.
+//!
+//! This function reserves space for a text at the end of the memory mapped log
+//! file with an atomic compare and swap and copies the text into the mapping.
+//! The file is grown before the space is reserved, so a text that can't be
+//! stored leaves no hole in it. Since each text has it's own reserved space,
+//! this function does NOT need the logger lock and many threads may call it
+//! concurrently, with #mapped_log_file_lock read locked. Texts beyond
+//! #MAPPED_LOG_FILE_WINDOW are discarded, as are texts written after the file
+//! is closed.
+//!
+//! \par Usage example
+//! \code
+//! write_mapped_log_file(file_line.data, file_line.length);
+//! \endcode
+static void write_mapped_log_file(const char* text, size_t text_length);
+
+
+// Public function implementations:
+int add_log_sink(const LogSinkConfiguration *sink_configuration) {
+
+  FILE *stream;
+  int i, sink_id = -1;
+  LogSink *sink;
+
+  if(sink_configuration == NULL) {
+    error(
+      "Logger module",
+      "Cannot add a log sink from a NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  if(
+    sink_configuration->callback == NULL &&
+    sink_configuration->stream == NULL &&
+    sink_configuration->file_name == NULL
+  ) {
+    error(
+      "Logger module",
+      "Could not add log sink! "
+      "Please provide a callback, a stream or a file name.\n"
+    );
+    return -1;
+  }
+
+  if(
+    sink_configuration->time_format != NULL &&
+    strlen(sink_configuration->time_format) >= TIME_FMT_SIZE
+  ) {
+    error(
+      "Logger module",
+      "Could not add log sink! Try again with a time format of less "
+      "then %u characters.\n",
+      TIME_FMT_SIZE
+    );
+    return -1;
+  }
+
+  stream = sink_configuration->stream;
+
+  // Callback sinks don't write to any stream:
+  if(sink_configuration->callback != NULL)
+    stream = NULL;
+
+  else if(stream == NULL) {
+
+    stream = fopen(
+      sink_configuration->file_name,
+      sink_configuration->file_mode == APPEND ? "a" : "w"
+    );
+
+    if(stream == NULL) {
+      error(
+        "Logger module",
+        "Could not create log sink file! Please check your system.\n"
+      );
+      return -1;
+    }
+
+  }
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  for(i = 0; i < MAX_LOG_SINKS && sink_id < 0; i++) {
+    if(!log_sinks[i].attached)
+      sink_id = i;
+  }
+
+  if(sink_id >= 0) {
+
+    sink = &log_sinks[sink_id];
+    sink->owns_stream = stream != sink_configuration->stream;
+    sink->callback = sink_configuration->callback;
+    sink->user_data = sink_configuration->user_data;
+    sink->category_mask = sink_configuration->category_mask;
+
+    switch(sink_configuration->color_mode) {
+
+      case ALWAYS_COLORS:
+        sink->colors = 1;
+        break;
+
+      case NEVER_COLORS:
+        sink->colors = 0;
+        break;
+
+      default:
+        sink->colors = stream != NULL && isatty(fileno(stream));
+        break;
+
+    }
+
+    if(sink_configuration->time_format == NULL)
+      sink->timestamp = LOGGER_TIMESTAMP;
+
+    else if(sink_configuration->time_format[0] == '\0')
+      sink->timestamp = NO_TIMESTAMP;
+
+    else {
+      sink->timestamp = CUSTOM_TIMESTAMP;
+      strcpy(
+        sink->time_format.string_representation,
+        sink_configuration->time_format
+      );
+
+      // A removed sink's timestamps may still be cached for this time format:
+      atomic_fetch_add(&logger_time_fmt_generation, 1);
+    }
+
+    sink->stream = stream;
+    sink->attached = 1;
+    num_of_log_sinks++;
+    update_log_sink_variants();
+
+  }
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  if(sink_id < 0) {
+
+    if(stream != NULL && stream != sink_configuration->stream)
+      fclose(stream);
+
+    error(
+      "Logger module",
+      "Could not add log sink! At most %d sinks may be attached.\n",
+      MAX_LOG_SINKS
+    );
+    return -1;
+
+  }
+
+  return sink_id;
+
+}
+
+int configure_binary_log_file(const char *file_name, LogFileMode file_mode) {
+
+  uint32_t byte_order = 0x01020304;
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  // If there was a previous log file, we need to close it:
+  if(log_file != NULL) {
+    close_buffered_file(&log_file_buffer, log_file);
+    log_file = NULL;
+  }
+
+  close_mapped_log_file();
+  close_binary_log_file();
+
+  binary_log_file = fopen(file_name, file_mode == APPEND ? "ab" : "wb");
+
+  // A new binary log file starts with a header that identifies it:
+  if(binary_log_file != NULL) {
+
+    fseek(binary_log_file, 0, SEEK_END);
+    attach_file_buffer(&binary_log_file_buffer, binary_log_file);
+
+    if(ftell(binary_log_file) == 0) {
+      write_file_buffer(
+        &binary_log_file_buffer,
+        binary_log_file,
+        BINARY_LOG_MAGIC,
+        strlen(BINARY_LOG_MAGIC)
+      );
+      write_file_buffer(
+        &binary_log_file_buffer,
+        binary_log_file,
+        &byte_order,
+        sizeof(byte_order)
+      );
+    }
+
+  }
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  if(binary_log_file == NULL) {
+    error(
+      "Logger module",
+      "Could not create log file! Please check your system.\n"
+    );
+    return -1;
+  }
+
+  return 0;
+
+}
+
+int configure_log_durability(const LogDurabilityPolicy *durability_policy) {
+
+  if(durability_policy == NULL) {
+    error(
+      "Logger module",
+      "Cannot assign log durability policy from a NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  // Restart the sync thread, so it uses the new policy:
+  stop_log_sync_thread();
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  log_durability_policy = *durability_policy;
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  if(durability_policy->sync_interval == 0 && durability_policy->sync_size == 0)
+    return 0;
+
+  // The sync thread shares the log file with the program's other threads:
+  enable_thread_safety();
+
+  atomic_store(&log_sync_running, 1);
+
+  if(pthread_create(&log_sync_thread, NULL, log_sync_routine, NULL) != 0) {
+    atomic_store(&log_sync_running, 0);
+    error(
+      "Logger module",
+      "Could not create the log file's sync thread! "
+      "Please check your system.\n"
+    );
+    return -1;
+  }
+
+  return 0;
+
+}
+
+int configure_log_file(const char *file_name, LogFileMode file_mode) {
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  // If there was a previous log file, we need to close it:
+  if(log_file != NULL) {
+    close_buffered_file(&log_file_buffer, log_file);
+    log_file = NULL;
+  }
+
+  close_mapped_log_file();
+  close_binary_log_file();
+
+  if(strlen(file_name) >= PATH_MAX) {
+
+    // Release logger lock if thread safety is enabled:
+    unlock_logger();
+
+    error(
+      "Logger module",
+      "Could not create log file! The file name is too long.\n"
+    );
+    return -1;
+
+  }
+
+  // Open the log file and store it's pointer for future use:
+  switch (file_mode) {
+
+    case APPEND:
+      log_file = fopen(file_name, "a");
+
+      if(log_file == NULL) {
+        warning(
+          "Logger module",
+          "Could not find log file! Defaulting to write mode!\n"
+        );
+        log_file = fopen(file_name, "w");
+      }
+
+      break;
+
+    case WRITE:
+      log_file = fopen(file_name, "w");
+      break;
+
+  }
+
+  // Keep track of the log file for it's rotation:
+  if(log_file != NULL) {
+
+    strcpy(log_file_name, file_name);
+
+    fseek(log_file, 0, SEEK_END);
+    log_file_size = ftell(log_file);
+    attach_file_buffer(&log_file_buffer, log_file);
+
+    log_file_rotation_time =
+      time(NULL) + log_rotation_policy.rotation_interval;
+
+  }
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  if(log_file == NULL) {
+    error(
+      "Logger module",
+      "Could not create log file! Please check your system.\n"
+    );
+    return -1;
+  }
+
+  return 0;
+
+}
+
+int configure_log_rotation(const LogRotationPolicy *rotation_policy) {
+
+  if(rotation_policy == NULL) {
+    error(
+      "Logger module",
+      "Cannot assign log rotation policy from a NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  if(
+    rotation_policy->archive_naming != NUMBERED_ARCHIVES &&
+    rotation_policy->archive_naming != TIMESTAMPED_ARCHIVES
+  ) {
+    error(
+      "Logger module",
+      "Cannot assign an unknown archive naming scheme! "
+      "Please use a valid ArchiveNaming.\n"
+    );
+    return -1;
+  }
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  log_rotation_policy = *rotation_policy;
+  log_file_rotation_time = time(NULL) + log_rotation_policy.rotation_interval;
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  return 0;
+
+}
+
+int configure_mapped_log_file(
+  const char *file_name,
+  LogFileMode file_mode,
+  size_t extent_size
+) {
+
+  char *mapping;
+  int descriptor, flags = O_RDWR | O_CREAT;
+  struct stat file_status;
+
+  if(extent_size == 0) {
+    error(
+      "Logger module",
+      "Could not create log file! The extent size must NOT be zero.\n"
+    );
+    return -1;
+  }
+
+  if(file_mode == WRITE)
+    flags |= O_TRUNC;
+
+  // Open and map the log file:
+  descriptor = open(file_name, flags, 0666);
+
+  if(descriptor < 0 || fstat(descriptor, &file_status) != 0) {
+
+    if(descriptor >= 0)
+      close(descriptor);
+
+    error(
+      "Logger module",
+      "Could not create log file! Please check your system.\n"
+    );
+    return -1;
+
+  }
+
+  mapping = mmap(
+    NULL,
+    MAPPED_LOG_FILE_WINDOW,
+    PROT_READ | PROT_WRITE,
+    MAP_SHARED,
+    descriptor,
+    0
+  );
+
+  if(mapping == MAP_FAILED) {
+    close(descriptor);
+    error(
+      "Logger module",
+      "Could not map log file into memory! Please check your system.\n"
+    );
+    return -1;
+  }
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  // If there was a previous log file, we need to close it:
+  if(log_file != NULL) {
+    close_buffered_file(&log_file_buffer, log_file);
+    log_file = NULL;
+  }
+
+  close_mapped_log_file();
+  close_binary_log_file();
+
+  // Messages are appended after any existing contents:
+  pthread_rwlock_wrlock(&mapped_log_file_lock);
+
+  mapped_log_file_descriptor = descriptor;
+  mapped_log_file_extent = extent_size;
+  atomic_store(&mapped_log_file_allocated, file_status.st_size);
+  atomic_store(&mapped_log_file_offset, file_status.st_size);
+  mapped_log_file = mapping;
+
+  pthread_rwlock_unlock(&mapped_log_file_lock);
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  return 0;
+
+}
+
+int decode_binary_log_file(const char *file_name, FILE *destination) {
+
+  char **formats = NULL, **new_formats, magic[sizeof(BINARY_LOG_MAGIC) - 1];
+  char body_storage[LINE_STORAGE_SIZE], context_storage[LINE_STORAGE_SIZE];
+  char line_storage[LINE_STORAGE_SIZE];
+  FILE *file;
+  int kind, result = 0;
+  int32_t nanoseconds;
+  int64_t seconds;
+  LogRecord record;
+  TextBuffer body, context, line, text;
+  TimeFormat time_format = {
+    .string_representation = "%H:%M:%S %d-%m-%Y"
+  };
+  uint32_t byte_order, context_length, i, id, length, num_of_formats = 0;
+  unsigned char category;
+
+  if(destination == NULL) {
+    error(
+      "Logger module",
+      "Cannot write decoded messages to a NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  file = fopen(file_name, "rb");
+
+  if(file == NULL) {
+    error(
+      "Logger module",
+      "Could not open binary log file! Please check your system.\n"
+    );
+    return -1;
+  }
+
+  if(
+    read_binary_log(file, magic, sizeof(magic)) != 0 ||
+    memcmp(magic, BINARY_LOG_MAGIC, sizeof(magic)) != 0 ||
+    read_binary_log(file, &byte_order, sizeof(byte_order)) != 0 ||
+    byte_order != 0x01020304
+  ) {
+    fclose(file);
+    error(
+      "Logger module",
+      "Could not decode binary log file! It is not a binary log file or was "
+      "written by a machine with a different byte order.\n"
+    );
+    return -1;
+  }
+
+  // Each record starts with it's kind:
+  while(result == 0 && (kind = fgetc(file)) != EOF) {
+
+    switch(kind) {
+
+      case FORMAT_RECORD:
+
+        text_buffer_init(&text, body_storage, sizeof(body_storage));
+
+        if(
+          read_binary_log(file, &id, sizeof(id)) != 0 ||
+          read_binary_log(file, &length, sizeof(length)) != 0 ||
+          read_binary_text(file, &text, length) != 0
+        ) {
+          text_buffer_release(&text);
+          result = -1;
+          break;
+        }
+
+        // Identifiers restart whenever messages are appended to the file:
+        if(id >= num_of_formats) {
+
+          new_formats = realloc(formats, (id + 1) * sizeof(char*));
+
+          if(new_formats == NULL) {
+            text_buffer_release(&text);
+            result = -1;
+            break;
+          }
+
+          formats = new_formats;
+
+          for(i = num_of_formats; i <= id; i++)
+            formats[i] = NULL;
+
+          num_of_formats = id + 1;
+
+        }
+
+        free(formats[id]);
+        formats[id] = strdup(text.data);
+        text_buffer_release(&text);
+
+        if(formats[id] == NULL)
+          result = -1;
+
+        break;
+
+      case TIME_FORMAT_RECORD:
+
+        if(
+          read_binary_log(file, &length, sizeof(length)) != 0 ||
+          length >= TIME_FMT_SIZE ||
+          read_binary_log(file, time_format.string_representation, length) != 0
+        ) {
+          result = -1;
+          break;
+        }
+
+        time_format.string_representation[length] = '\0';
+
+        // The caches can't tell that the time format's contents changed:
+        for(i = 0; i < TIMESTAMP_CACHE_SIZE; i++)
+          thread_timestamp_caches[i].time_format = NULL;
+
+        break;
+
+      case MESSAGE_RECORD:
+      case TEXT_RECORD:
+
+        text_buffer_init(&context, context_storage, sizeof(context_storage));
+        text_buffer_init(&body, body_storage, sizeof(body_storage));
+        text_buffer_init(&line, line_storage, sizeof(line_storage));
+
+        if(
+          read_binary_log(file, &category, sizeof(category)) != 0 ||
+          category >= NUM_OF_MESSAGE_CATEGORIES ||
+          read_binary_log(file, &seconds, sizeof(seconds)) != 0 ||
+          read_binary_log(file, &nanoseconds, sizeof(nanoseconds)) != 0 ||
+          read_binary_log(file, &context_length, sizeof(context_length)) != 0 ||
+          (
+            context_length != UINT32_MAX &&
+            read_binary_text(file, &context, context_length) != 0
+          )
+        )
+          result = -1;
+
+        else if(kind == MESSAGE_RECORD) {
+          if(
+            read_binary_log(file, &id, sizeof(id)) != 0 ||
+            id >= num_of_formats ||
+            formats[id] == NULL ||
+            decode_binary_arguments(file, formats[id], &body) != 0
+          )
+            result = -1;
+        }
+
+        else if(
+          read_binary_log(file, &length, sizeof(length)) != 0 ||
+          read_binary_text(file, &body, length) != 0
+        )
+          result = -1;
+
+        // Write the message exactly as a regular log file would:
+        if(result == 0) {
+
+          record.category = category;
+          record.timestamp.tv_sec = seconds;
+          record.timestamp.tv_nsec = nanoseconds;
+          record.context = context_length != UINT32_MAX ? context.data : NULL;
+          record.context_length = context.length;
+          record.body = body.data;
+          record.body_length = body.length;
+          record.fields = NULL;
+          record.fields_length = 0;
+
+          render_file_record(&line, &record, &time_format);
+          fwrite(line.data, 1, line.length, destination);
+
+        }
+
+        text_buffer_release(&context);
+        text_buffer_release(&body);
+        text_buffer_release(&line);
+
+        break;
+
+      default:
+        result = -1;
+        break;
+
+    }
+
+  }
+
+  // Free allocated resources:
+  for(i = 0; i < num_of_formats; i++)
+    free(formats[i]);
+
+  free(formats);
+  fclose(file);
+
+  if(result != 0)
+    error(
+      "Logger module",
+      "Could not decode binary log file! The file is truncated or corrupted.\n"
+    );
+
+  return result;
+
+}
+
+int dump_flight_recorder() {
+
+  if(!(atomic_load(&logger_enabled_categories) & FLIGHT_RECORDER_FLAG)) {
+    error(
+      "Logger module",
+      "Could not dump the flight recorder! The flight recorder is NOT "
+      "enabled.\n"
+    );
+    return -1;
+  }
+
+  // Acquire logger lock if thread safety is enabled. It's held through the
+  // dump, so the log file can't be closed in between:
+  lock_logger();
+
+  if(log_file == NULL && mapped_log_file == NULL) {
+    unlock_logger();
+    error(
+      "Logger module",
+      "Could not dump the flight recorder! No log file is configured.\n"
+    );
+    return -1;
+  }
+
+  write_flight_records();
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  return 0;
+
+}
+
+int enable_async_logging(unsigned int capacity) {
+
+  size_t i, ring_size = 2;
+
+  if(atomic_load(&async_logging_enabled)) {
+    error(
+      "Logger module",
+      "Asynchronous logging is already enabled!\n"
+    );
+    return -1;
+  }
+
+  // The ring buffer's size must be a power of two:
+  while(ring_size < capacity)
+    ring_size <<= 1;
+
+  // The writer thread runs concurrently with the program's other threads:
+  enable_thread_safety();
+
+  // Allocate the ring buffer:
+  async_ring = malloc(ring_size * sizeof(AsyncRecordSlot));
+
+  if(async_ring == NULL) {
+    error(
+      "Logger module",
+      "Could not allocate memory for the asynchronous logging ring buffer! "
+      "Please check your system.\n"
+    );
+    return -1;
+  }
+
+  // Initialize the ring buffer:
+  for(i = 0; i < ring_size; i++)
+    atomic_init(&async_ring[i].sequence, i);
+
+  async_ring_mask = ring_size - 1;
+  async_dequeue_position = 0;
+  atomic_store(&async_enqueue_position, 0);
+
+  // Start the writer thread:
+  atomic_store(&async_writer_running, 1);
+
+  if(
+    pthread_create(&async_writer_thread, NULL, async_writer_routine, NULL) != 0
+  ) {
+    free(async_ring);
+    async_ring = NULL;
+    error(
+      "Logger module",
+      "Could not create the asynchronous logging writer thread! "
+      "Please check your system.\n"
+    );
+    return -1;
+  }
+
+  // Only hand messages over to the writer thread once everything is ready:
+  atomic_store_explicit(&async_logging_enabled, 1, memory_order_release);
+
+  return 0;
+
+}
+
+int enable_flight_recorder(unsigned int capacity) {
+
+  size_t recorder_size = 2;
+
+  if(atomic_load(&logger_enabled_categories) & FLIGHT_RECORDER_FLAG) {
+    error(
+      "Logger module",
+      "The flight recorder is already enabled!\n"
+    );
+    return -1;
+  }
+
+  // The flight recorders' size must be a power of two:
+  while(recorder_size < capacity)
+    recorder_size <<= 1;
+
+  // Each thread's recorder is allocated by it's first message and released
+  // for other threads when it exits:
+  if(pthread_key_create(&flight_recorder_key, release_flight_recorder) != 0) {
+    error(
+      "Logger module",
+      "Could not create the flight recorder's thread key! "
+      "Please check your system.\n"
+    );
+    return -1;
+  }
+
+  flight_recorder_mask = recorder_size - 1;
+
+  // Only keep messages once the flight recorder is ready:
+  atomic_fetch_or_explicit(
+    &logger_enabled_categories,
+    FLIGHT_RECORDER_FLAG,
+    memory_order_release
+  );
+
+  return 0;
+
+}
+
+int enable_thread_buffering(size_t buffer_size, unsigned int flush_interval) {
+
+  if(buffer_size == 0) {
+    error(
+      "Logger module",
+      "Could not enable thread buffering! The buffer size must NOT be zero.\n"
+    );
+    return -1;
+  }
+
+  if(atomic_load(&thread_buffering_enabled)) {
+    error(
+      "Logger module",
+      "Thread buffering is already enabled!\n"
+    );
+    return -1;
+  }
+
+  // Buffers are flushed from many threads, which share the outputs:
+  enable_thread_safety();
+
+  if(pthread_key_create(&thread_buffer_key, release_thread_buffer) != 0) {
+    error(
+      "Logger module",
+      "Could not create the thread buffers' key! Please check your system.\n"
+    );
+    return -1;
+  }
+
+  thread_buffer_size = buffer_size;
+  thread_buffer_flush_interval = flush_interval;
+  atomic_store(&thread_buffering_enabled, 1);
+
+  return 0;
+
+}
+
+int enable_thread_safety() {
+
+  // The mutex is statically initialized, so enabling thread safety only needs
+  // to make lock_logger() use it:
+  atomic_store_explicit(&logger_thread_safety_enabled, 1, memory_order_relaxed);
+
+  return 0;
+
+}
+
+unsigned int get_enabled_categories() {
+  return
+    atomic_load_explicit(&logger_enabled_categories, memory_order_relaxed) &
+    ALL_MESSAGE_CATEGORIES;
+}
+
+int get_logger_msg_colors(
+  DisplayColors* display_colors_destination,
+  MessageCategory requested_category
+) {
+
+  if(display_colors_destination == NULL) {
+    error(
+      "Logger module",
+      "Cannot store display color information in NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  copy_display_colors(
+    display_colors_destination,
+    &acquire_configuration()->color_pallet.message_colors[requested_category]
+  );
+  release_configuration();
+
+  return 0;
+
+}
+
+int get_logger_tag_colors(
+  DisplayColors* display_colors_destination,
+  TagCategory requested_category
+) {
+
+  if(display_colors_destination == NULL) {
+    error(
+      "Logger module",
+      "Cannot store display color information in NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  copy_display_colors(
+    display_colors_destination,
+    &acquire_configuration()->color_pallet.tag_colors[requested_category]
+  );
+  release_configuration();
+
+  return 0;
+
+}
+
+int get_time_format(TimeFormat *time_format_destination) {
+
+  if(time_format_destination == NULL) {
+    error(
+      "Logger module",
+      "Cannot store time format in NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  // Copy logger time format to destination time format:
+  strncpy(
+    time_format_destination->string_representation,
+    acquire_configuration()->time_format.string_representation,
+    TIME_FMT_SIZE
+  );
+  release_configuration();
+
+  return 0;
+
+}
+
+int install_crash_handlers() {
+
+  struct sigaction crash_action;
+  size_t i;
+  stack_t stack;
+
+  if(crash_handlers_installed)
+    return 0;
+
+  // Handle stack overflows in this thread on an alternate stack, unless the
+  // program already set one up:
+  if(sigaltstack(NULL, &stack) == 0 && (stack.ss_flags & SS_DISABLE)) {
+    stack.ss_sp = crash_signal_stack;
+    stack.ss_size = sizeof(crash_signal_stack);
+    stack.ss_flags = 0;
+    sigaltstack(&stack, NULL);
+  }
+
+  memset(&crash_action, 0, sizeof(crash_action));
+  crash_action.sa_handler = crash_signal_handler;
+  crash_action.sa_flags = SA_ONSTACK;
+  sigemptyset(&crash_action.sa_mask);
+
+  for(i = 0; i < NUM_OF_CRASH_SIGNALS; i++) {
+
+    if(
+      sigaction(crash_signals[i], &crash_action, &previous_crash_actions[i])
+      != 0
+    ) {
+
+      // Undo the handlers already installed:
+      while(i-- > 0)
+        sigaction(crash_signals[i], &previous_crash_actions[i], NULL);
+
+      error(
+        "Logger module",
+        "Could not install the crash handlers! Please check your system.\n"
+      );
+      return -1;
+
+    }
+
+  }
+
+  crash_handlers_installed = 1;
+
+  return 0;
+
+}
+
+int remove_log_sink(int sink_id) {
+
+  int result = -1;
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  if(
+    sink_id >= 0 &&
+    sink_id < MAX_LOG_SINKS &&
+    log_sinks[sink_id].attached
+  ) {
+    // Drop the cached timestamps of the sink's time format:
+    if(log_sinks[sink_id].timestamp == CUSTOM_TIMESTAMP)
+      atomic_fetch_add(&logger_time_fmt_generation, 1);
+
+    close_log_sink(&log_sinks[sink_id]);
+    num_of_log_sinks--;
+    update_log_sink_variants();
+    result = 0;
+  }
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  if(result != 0)
+    error(
+      "Logger module",
+      "Could not remove log sink! No sink is attached with id %d.\n",
+      sink_id
+    );
+
+  return result;
+
+}
+
+int set_color_mode(ColorMode color_mode) {
+
+  int enabled;
+
+  switch(color_mode) {
+
+    case AUTO_COLORS:
+      enabled = isatty(STDOUT_FILENO);
+      break;
+
+    case ALWAYS_COLORS:
+      enabled = 1;
+      break;
+
+    case NEVER_COLORS:
+      enabled = 0;
+      break;
+
+    default:
+      error(
+        "Logger module",
+        "Cannot set an unknown color mode! Please use a valid ColorMode.\n"
+      );
+      return -1;
+
+  }
+
+  atomic_store_explicit(&logger_colors_enabled, enabled, memory_order_relaxed);
+
+  return 0;
+
+}
+
+int set_console_output(int enabled) {
+
+  atomic_store_explicit(
+    &console_output_enabled,
+    enabled != 0,
+    memory_order_relaxed
+  );
+
+  return 0;
+
+}
+
+int set_enabled_categories(unsigned int category_mask) {
+
+  unsigned int categories;
+
+  if((category_mask & ~ALL_MESSAGE_CATEGORIES) != 0) {
+    error(
+      "Logger module",
+      "Cannot enable unknown message categories! "
+      "Please build the mask with CATEGORY_MASK.\n"
+    );
+    return -1;
+  }
+
+  // Keep the flight recorder's flag, which shares the mask:
+  categories = atomic_load_explicit(
+    &logger_enabled_categories,
+    memory_order_relaxed
+  );
+
+  while(
+    !atomic_compare_exchange_weak_explicit(
+      &logger_enabled_categories,
+      &categories,
+      (categories & FLIGHT_RECORDER_FLAG) | category_mask,
+      memory_order_relaxed,
+      memory_order_relaxed
+    )
+  );
+
+  return 0;
+
+}
+
+int set_log_file_format(LogFileFormat file_format) {
+
+  if(file_format != TEXT_LOG_FILE && file_format != JSON_LOG_FILE) {
+    error(
+      "Logger module",
+      "Cannot set an unknown log file format! Please use a valid "
+      "LogFileFormat.\n"
+    );
+    return -1;
+  }
+
+  atomic_store_explicit(&log_file_format, file_format, memory_order_relaxed);
+
+  return 0;
+
+}
+
+int set_logger_msg_colors(
+  MessageCategory message_category,
+  const DisplayColors *assigned_colors
+) {
+
+  LoggerConfiguration *configuration;
+
+  if(assigned_colors == NULL) {
+    error(
+      "Logger module",
+      "Cannot assign display color information from NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  configuration = begin_configuration_update();
+
+  if(configuration == NULL)
+    return -1;
+
+  copy_display_colors(
+    &configuration->color_pallet.message_colors[message_category],
+    assigned_colors
+  );
+
+  render_display_prefixes(configuration);
+  publish_configuration(configuration);
+
+  return 0;
+
+}
+
+int set_logger_tag_colors(
+  TagCategory tag_category,
+  const DisplayColors *assigned_colors
+) {
+
+  LoggerConfiguration *configuration;
+
+  if(assigned_colors == NULL) {
+    error(
+      "Logger module",
+      "Cannot assign display color information from NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  configuration = begin_configuration_update();
+
+  if(configuration == NULL)
+    return -1;
+
+  copy_display_colors(
+    &configuration->color_pallet.tag_colors[tag_category],
+    assigned_colors
+  );
+
+  render_display_prefixes(configuration);
+  publish_configuration(configuration);
+
+  return 0;
+
+}
+
+int set_time_format(const char *new_format) {
+
+  LoggerConfiguration *configuration;
+
+  if(new_format == NULL) {
+    error(
+      "Logger module",
+      "Cannot assign time format from a NULL pointer! "
+      "Please use a valid reference.\n"
+    );
+    return -1;
+  }
+
+  if(strlen(new_format) > TIME_FMT_SIZE) {
+    error(
+      "Logger module",
+      "Could not change time format! Try again with an argument of less "
+      "then %u characters.\n",
+      TIME_FMT_SIZE
+    );
+    return -1;
+  }
+
+  configuration = begin_configuration_update();
+
+  if(configuration == NULL)
+    return -1;
+
+  // Copy new time format to logger time format:
+  strncpy(
+    configuration->time_format.string_representation,
+    new_format,
+    TIME_FMT_SIZE
+  );
+  configuration->time_format.string_representation[TIME_FMT_SIZE - 1] = '\0';
+
+  publish_configuration(configuration);
+  atomic_fetch_add(&logger_time_fmt_generation, 1);
+
+  return 0;
+
+}
+
+void begin_logger_batch() {
+  lock_logger();
+}
+
+void color_background(Color p_color) {
+
+  // Ignore colors that are not in the Color enumeration or disabled colors:
+  if(p_color < BLA || p_color > DFLT || !colors_enabled())
+    return;
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  fwrite(
+    background_color_escapes[p_color].text,
+    1,
+    background_color_escapes[p_color].length,
+    stdout
+  );
+
+  clear_line_text_background_past_cursor();
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+}
+
+void color_text(Color p_color) {
+
+  // Ignore colors that are not in the Color enumeration or disabled colors:
+  if(p_color < BLA || p_color > DFLT || !colors_enabled())
+    return;
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  fwrite(
+    text_color_escapes[p_color].text,
+    1,
+    text_color_escapes[p_color].length,
+    stdout
+  );
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+}
+
+void end_logger_batch() {
+  unlock_logger();
+}
+
+void error(const char *context, const char *format, ...) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(ERROR_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_category_message(ERROR_MSG, context, NULL, 0, format, arg_list);
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void error_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(ERROR_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_structured_message(
+    ERROR_MSG,
+    context,
+    fields,
+    num_of_fields,
+    format,
+    arg_list
+  );
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void info(const char *context, const char *format, ...) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(INFO_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_category_message(INFO_MSG, context, NULL, 0, format, arg_list);
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void info_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(INFO_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_structured_message(
+    INFO_MSG,
+    context,
+    fields,
+    num_of_fields,
+    format,
+    arg_list
+  );
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void lock_logger_recursive_mutex() {
+  if(logger_lock_needed())
+    begin_logger_batch();
+
+  else
+    warning(
+      "Logger module",
+      "Enable thread safety to access the logger recursive mutex."
+    );
+}
+
+void logger_module_clean_up() {
+
+  FlightRecorder *recorder;
+  int i;
+  LoggerConfiguration *configuration;
+  ThreadBuffer *buffer;
+
+  // Restore the signal actions replaced by the crash handlers:
+  if(crash_handlers_installed) {
+
+    for(i = 0; i < NUM_OF_CRASH_SIGNALS; i++)
+      sigaction(crash_signals[i], &previous_crash_actions[i], NULL);
+
+    crash_handlers_installed = 0;
+
+  }
+
+  // Stop the async writer thread after it writes all pending messages:
+  if(atomic_load(&async_logging_enabled)) {
+    atomic_store(&async_logging_enabled, 0);
+    atomic_store(&async_writer_running, 0);
+    pthread_join(async_writer_thread, NULL);
+    free(async_ring);
+    async_ring = NULL;
+  }
+
+  // Stop keeping messages in the flight recorder:
+  if(atomic_load(&logger_enabled_categories) & FLIGHT_RECORDER_FLAG) {
+
+    atomic_fetch_and(&logger_enabled_categories, ~FLIGHT_RECORDER_FLAG);
+    pthread_key_delete(flight_recorder_key);
+
+    while((recorder = atomic_load(&flight_recorders)) != NULL) {
+      atomic_store(&flight_recorders, recorder->next);
+      free(recorder);
+    }
+
+  }
+
+  // Write the messages still buffered by every thread:
+  if(atomic_load(&thread_buffering_enabled)) {
+
+    atomic_store(&thread_buffering_enabled, 0);
+    pthread_key_delete(thread_buffer_key);
+    pthread_mutex_lock(&thread_buffers_mutex);
+
+    while(thread_buffers != NULL) {
+      buffer = thread_buffers;
+      acquire_crash_lock(&thread_buffers_crash_lock);
+      thread_buffers = buffer->next;
+      release_crash_lock(&thread_buffers_crash_lock);
+      pthread_mutex_lock(&buffer->mutex);
+      acquire_crash_lock(&buffer->crash_lock);
+      flush_thread_buffer(buffer);
+      release_crash_lock(&buffer->crash_lock);
+      pthread_mutex_unlock(&buffer->mutex);
+      pthread_mutex_destroy(&buffer->mutex);
+      text_buffer_release(&buffer->console);
+      text_buffer_release(&buffer->file);
+      free(buffer);
+    }
+
+    pthread_mutex_unlock(&thread_buffers_mutex);
+
+  }
+
+  // Stop syncing the log file in the background, syncing it one last time:
+  if(atomic_load(&log_sync_running)) {
+    stop_log_sync_thread();
+    lock_logger();
+    sync_log_file();
+    unlock_logger();
+  }
+
+  memset(&log_durability_policy, 0, sizeof(log_durability_policy));
+
+  // Clean up the log file:
+  if(log_file != NULL) {
+    close_buffered_file(&log_file_buffer, log_file);
+    log_file = NULL;
+  }
+
+  // Wait for the rotated log files to be archived:
+  stop_log_archive_thread();
+
+  close_mapped_log_file();
+  close_binary_log_file();
+
+  // Clean up the log sinks:
+  for(i = 0; i < MAX_LOG_SINKS; i++)
+    close_log_sink(&log_sinks[i]);
+
+  num_of_log_sinks = 0;
+
+  // No message is being logged anymore, so the replaced configuration
+  // snapshots can be freed:
+  pthread_mutex_lock(&logger_configuration_mutex);
+
+  while(logger_retired_configurations != NULL) {
+    configuration = logger_retired_configurations;
+    logger_retired_configurations = configuration->retired_next;
+    free(configuration);
+  }
+
+  pthread_mutex_unlock(&logger_configuration_mutex);
+
+  // Free the scratch body of the calling thread. Other threads free theirs
+  // when they exit:
+  if(!thread_scratch_body_in_use)
+    text_buffer_release(&thread_scratch_body);
+
+  // The mutex is statically initialized, so it's kept for later use:
+  atomic_store_explicit(&logger_thread_safety_enabled, 0, memory_order_relaxed);
+
+}
+
+void message(const char *context, const char *format, ...) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(DEFAULT_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_category_message(DEFAULT_MSG, context, NULL, 0, format, arg_list);
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void message_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(DEFAULT_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_structured_message(
+    DEFAULT_MSG,
+    context,
+    fields,
+    num_of_fields,
+    format,
+    arg_list
+  );
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void reset_background_color() {
+  color_background(DFLT);
+}
+
+void reset_colors() {
+
+  if(!colors_enabled())
+    return;
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  apply_all_default_attributes();
+  clear_line_text_background_past_cursor();
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+}
+
+void reset_logger_colors() {
+
+  int i;
+  LoggerConfiguration *configuration = begin_configuration_update();
+
+  if(configuration == NULL)
+    return;
+
+  for(i = 0; i < NUM_OF_MESSAGE_CATEGORIES; i++) {
+    copy_display_colors(
+      &configuration->color_pallet.message_colors[i],
+      &default_color_pallet.message_colors[i]
+    );
+  }
+
+  for(i = 0; i < NUM_OF_TAG_CATEGORIES; i++) {
+    copy_display_colors(
+      &configuration->color_pallet.tag_colors[i],
+      &default_color_pallet.tag_colors[i]
+    );
+  }
+
+  render_display_prefixes(configuration);
+  publish_configuration(configuration);
+
+}
+
+void reset_text_color() {
+  color_text(DFLT);
+}
+
+void success(const char *context, const char *format, ...) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(SUCCESS_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_category_message(SUCCESS_MSG, context, NULL, 0, format, arg_list);
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void success_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(SUCCESS_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_structured_message(
+    SUCCESS_MSG,
+    context,
+    fields,
+    num_of_fields,
+    format,
+    arg_list
+  );
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void unlock_logger_recursive_mutex() {
+  if(logger_lock_held)
+    end_logger_batch();
+
+  else
+    warning(
+      "Logger module",
+      "Enable thread safety to access the logger recursive mutex."
+    );
+}
+
+void warning(const char *context, const char *format, ...) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(WARNING_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_category_message(WARNING_MSG, context, NULL, 0, format, arg_list);
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+void warning_fields(
+  const char *context,
+  const LogField *fields,
+  size_t num_of_fields,
+  const char *format,
+  ...
+) {
+
+  va_list arg_list;
+
+  // Skip disabled categories before doing any work:
+  if(!CATEGORY_NEEDED(WARNING_MSG))
+    return;
+
+  // Start the argument list with any arguments after the format string:
+  va_start(arg_list, format);
+
+  log_structured_message(
+    WARNING_MSG,
+    context,
+    fields,
+    num_of_fields,
+    format,
+    arg_list
+  );
+
+  // Free allocated resources:
+  va_end(arg_list);
+
+}
+
+// Private function implementations:
+static void acquire_crash_lock(atomic_flag* lock) {
+  while(atomic_flag_test_and_set_explicit(lock, memory_order_acquire))
+    sched_yield();
+}
+
+static const LoggerConfiguration* acquire_configuration() {
+
+  const LoggerConfiguration *configuration;
+  ConfigurationReader *reader;
+
+  // Nested readers use the snapshot acquired by the outermost one:
+  if(thread_configuration_depth++ > 0)
+    return thread_configuration;
+
+  reader = thread_configuration_reader;
+
+  if(reader == NULL)
+    reader = claim_configuration_reader();
+
+  // Without a reader, the snapshot is kept from being replaced instead:
+  if(reader == NULL) {
+    pthread_mutex_lock(&logger_configuration_mutex);
+    thread_configuration = get_configuration();
+    return thread_configuration;
+  }
+
+  // Publish the snapshot before using it. If it was replaced before it was
+  // published, the setter may have missed it and the new one is used:
+  do {
+    configuration = get_configuration();
+    atomic_store(&reader->snapshot, configuration);
+  } while(configuration != atomic_load(&logger_configuration));
+
+  thread_configuration = configuration;
+
+  return configuration;
+
+}
+
+static TextBuffer* acquire_scratch_body() {
+
+  if(thread_scratch_body_in_use)
+    return NULL;
+
+  // The scratch body starts in the thread's static storage, and again after
+  // it's heap storage is freed:
+  if(thread_scratch_body.data == NULL)
+    text_buffer_init(
+      &thread_scratch_body,
+      thread_scratch_storage,
+      sizeof(thread_scratch_storage)
+    );
+
+  thread_scratch_body.length = 0;
+  thread_scratch_body_in_use = 1;
+
+  return &thread_scratch_body;
+
+}
+
+static void apply_all_default_attributes() {
+  fwrite(
+    reset_attributes_escape.text,
+    1,
+    reset_attributes_escape.length,
+    stdout
+  );
+}
+
+static void archive_log_file(LogArchiveJob* job) {
+
+  char archive_name[PATH_MAX + 32], older_archive_name[PATH_MAX + 32];
+  int length;
+  unsigned int i;
+  struct tm time_info;
+
+  // The sync thread only syncs the current log file, so the rotated log file
+  // is synced before it's closed:
+  fflush(job->file);
+
+  if(job->sync)
+    fdatasync(fileno(job->file));
+
+  fclose(job->file);
+
+  // Without archives, the log file is simply deleted:
+  if(job->policy.max_archives == 0) {
+    remove(job->staged_name);
+    free(job);
+    return;
+  }
+
+  switch(job->policy.archive_naming) {
+
+    case NUMBERED_ARCHIVES:
+
+      // Shift the existing archives, discarding the oldest one:
+      for(i = job->policy.max_archives; i > 1; i--) {
+        length = snprintf(
+          archive_name,
+          sizeof(archive_name),
+          "%s.%u",
+          job->file_name,
+          i - 1
+        );
+
+        if(length < 0 || (size_t) length >= sizeof(archive_name))
+          break;
+
+        snprintf(
+          older_archive_name,
+          sizeof(older_archive_name),
+          "%s.%u",
+          job->file_name,
+          i
+        );
+        rename(archive_name, older_archive_name);
+      }
+
+      length = snprintf(
+        archive_name,
+        sizeof(archive_name),
+        "%s.1",
+        job->file_name
+      );
+
+      if(length >= 0 && (size_t) length < sizeof(archive_name))
+        rename(job->staged_name, archive_name);
+
+      break;
+
+    case TIMESTAMPED_ARCHIVES:
+
+      localtime_r(&job->time, &time_info);
+      length = snprintf(
+        archive_name,
+        sizeof(archive_name),
+        "%s.",
+        job->file_name
+      );
+
+      if(
+        length < 0 ||
+        (size_t) length >= sizeof(archive_name) ||
+        strftime(
+          archive_name + length,
+          sizeof(archive_name) - length,
+          "%Y%m%d-%H%M%S",
+          &time_info
+        ) == 0
+      )
+        break;
+
+      // Several rotations may happen in the same second. The counter has a
+      // fixed width to keep the archives in alphabetical order:
+      length = strlen(archive_name);
+      for(i = 1; access(archive_name, F_OK) == 0; i++)
+        if(
+          (size_t) snprintf(
+            archive_name + length,
+            sizeof(archive_name) - length,
+            "-%03u",
+            i
+          ) >= sizeof(archive_name) - length
+        )
+          break;
+
+      if(access(archive_name, F_OK) != 0) {
+        rename(job->staged_name, archive_name);
+        prune_timestamped_archives(job->file_name, job->policy.max_archives);
+      }
+
+      break;
+
+  }
+
+  free(job);
+
+}
+
+static void attach_file_buffer(FileBuffer* buffer, FILE* stream) {
+
+  pthread_once(&file_buffers_exit_once, register_file_buffers_flush);
+
+  // The text is buffered by the file buffer instead of the C library:
+  setvbuf(stream, NULL, _IONBF, 0);
+
+  acquire_crash_lock(&buffer->crash_lock);
+  buffer->descriptor = fileno(stream);
+  buffer->length = 0;
+  release_crash_lock(&buffer->crash_lock);
+
+}
+
+static void* async_writer_routine(void* args) {
+
+  char console_storage[ASYNC_RECORD_SIZE], file_storage[ASYNC_RECORD_SIZE];
+  int running;
+  size_t num_of_records;
+  TextBuffer console_batch, file_batch;
+
+  text_buffer_init(&console_batch, console_storage, sizeof(console_storage));
+  text_buffer_init(&file_batch, file_storage, sizeof(file_storage));
+
+  // The batches grow in the heap to hold many messages, so we reserve that
+  // memory upfront:
+  text_buffer_reserve(&console_batch, async_batch_size);
+  text_buffer_reserve(&file_batch, async_batch_size);
+
+  do {
+
+    // Read the running flag before draining, so the messages enqueued before
+    // the flag was cleared are always written:
+    running = atomic_load(&async_writer_running);
+
+    num_of_records = drain_async_ring(&console_batch, &file_batch);
+
+    if(num_of_records == 0 && running)
+      nanosleep(&async_writer_idle_time, NULL);
+
+  } while(running || num_of_records > 0);
+
+  text_buffer_release(&console_batch);
+  text_buffer_release(&file_batch);
+
+  return NULL;
+
+}
+
+static LoggerConfiguration* begin_configuration_update() {
+
+  LoggerConfiguration *configuration;
+  const LoggerConfiguration *current;
+
+  // Make sure the default configuration is published before it's copied:
+  get_configuration();
+  pthread_mutex_lock(&logger_configuration_mutex);
+  current = atomic_load_explicit(&logger_configuration, memory_order_acquire);
+  configuration = malloc(sizeof(LoggerConfiguration));
+
+  if(configuration == NULL) {
+    pthread_mutex_unlock(&logger_configuration_mutex);
+    error(
+      "Logger module",
+      "Could not allocate memory for the logger configuration! "
+      "Please check your system.\n"
+    );
+    return NULL;
+  }
+
+  *configuration = *current;
+  configuration->retired_next = NULL;
+
+  return configuration;
+
+}
+
+static FlightRecord* begin_flight_record(FlightRecorder* recorder) {
+
+  FlightRecord *record = &recorder->records[
+    atomic_load_explicit(&recorder->position, memory_order_relaxed) &
+    flight_recorder_mask
+  ];
+
+  // Mark the record as being written before any of it changes:
+  atomic_store_explicit(&record->sequence, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  return record;
+
+}
+
+static int buffer_thread_record(const LogRecord* record, int console) {
+
+  long elapsed;
+  ThreadBuffer *buffer = get_thread_buffer();
+
+  if(buffer == NULL)
+    return -1;
+
+  // The crash lock keeps crash handlers from reading the buffer while it's
+  // being changed:
+  pthread_mutex_lock(&buffer->mutex);
+  acquire_crash_lock(&buffer->crash_lock);
+
+  if(console)
+    render_console_record(&buffer->console, record, colors_enabled());
+
+  if(
+    atomic_load_explicit(&log_file, memory_order_relaxed) != NULL ||
+    atomic_load_explicit(&mapped_log_file, memory_order_relaxed) != NULL
+  )
+    render_log_file_line(
+      &buffer->file,
+      record,
+      atomic_load_explicit(&log_file_format, memory_order_relaxed)
+    );
+
+  buffer->last_message_time = record->timestamp.tv_sec;
+
+  // Flush the buffer when it's full, when it's too old or for errors:
+  elapsed =
+    (record->timestamp.tv_sec - buffer->flush_time.tv_sec) * 1000 +
+    (record->timestamp.tv_nsec - buffer->flush_time.tv_nsec) / 1000000;
+
+  if(
+    buffer->console.length >= thread_buffer_size ||
+    buffer->file.length >= thread_buffer_size ||
+    record->category == ERROR_MSG ||
+    (
+      thread_buffer_flush_interval > 0 &&
+      elapsed >= (long) thread_buffer_flush_interval
+    )
+  ) {
+
+    flush_thread_buffer(buffer);
+
+    // Force error messages to disk if the durability policy says so:
+    if(record->category == ERROR_MSG && log_durability_policy.sync_errors) {
+      lock_logger();
+      sync_log_file();
+      unlock_logger();
+    }
+
+  }
+
+  release_crash_lock(&buffer->crash_lock);
+  pthread_mutex_unlock(&buffer->mutex);
+
+  return 0;
+
+}
+
+static ConfigurationReader* claim_configuration_reader() {
+
+  ConfigurationReader *reader;
+  int claimed;
+
+  pthread_once(&configuration_reader_key_once, create_configuration_reader_key);
+
+  // Reuse the reader of an exited thread:
+  for(
+    reader = atomic_load(&configuration_readers);
+    reader != NULL;
+    reader = reader->next
+  ) {
+    claimed = 0;
+
+    if(atomic_compare_exchange_strong(&reader->claimed, &claimed, 1))
+      break;
+  }
+
+  if(reader == NULL) {
+
+    reader = malloc(sizeof(ConfigurationReader));
+
+    if(reader == NULL)
+      return NULL;
+
+    atomic_init(&reader->snapshot, NULL);
+    atomic_init(&reader->claimed, 1);
+    reader->next = atomic_load(&configuration_readers);
+
+    while(
+      !atomic_compare_exchange_weak(
+        &configuration_readers,
+        &reader->next,
+        reader
+      )
+    );
+
+  }
+
+  if(configuration_reader_key_created)
+    pthread_setspecific(configuration_reader_key, reader);
+
+  thread_configuration_reader = reader;
+
+  return reader;
+
+}
+
+static FlightRecorder* claim_flight_recorder() {
+
+  FlightRecorder *recorder = pthread_getspecific(flight_recorder_key);
+  int claimed;
+  size_t i;
+
+  if(recorder != NULL)
+    return recorder;
+
+  // Reuse the recorder of an exited thread:
+  for(
+    recorder = atomic_load(&flight_recorders);
+    recorder != NULL;
+    recorder = recorder->next
+  ) {
+    claimed = 0;
+
+    if(atomic_compare_exchange_strong(&recorder->claimed, &claimed, 1))
+      break;
+  }
+
+  if(recorder == NULL) {
+
+    recorder = malloc(
+      sizeof(FlightRecorder) +
+      (flight_recorder_mask + 1) * sizeof(FlightRecord)
+    );
+
+    if(recorder == NULL)
+      return NULL;
+
+    for(i = 0; i <= flight_recorder_mask; i++)
+      atomic_init(&recorder->records[i].sequence, 0);
+
+    atomic_init(&recorder->position, 0);
+    recorder->dump_position = 0;
+    recorder->dump_end = 0;
+    atomic_init(&recorder->claimed, 1);
+    recorder->next = atomic_load(&flight_recorders);
+
+    while(
+      !atomic_compare_exchange_weak(
+        &flight_recorders,
+        &recorder->next,
+        recorder
+      )
+    );
+
+  }
+
+  pthread_setspecific(flight_recorder_key, recorder);
+
+  return recorder;
+
+}
+
+static void clear_line_text_background_past_cursor() {
+  // When bash creates a new line, it colors the background of the entire new
+  // line automatically. The following escape code clears any existing
+  // background on the current line past the cursor position.
+  fwrite(clear_line_escape.text, 1, clear_line_escape.length, stdout);
+}
+
+static void close_binary_log_file() {
+
+  int i;
+
+  if(binary_log_file == NULL)
+    return;
+
+  close_buffered_file(&binary_log_file_buffer, binary_log_file);
+  binary_log_file = NULL;
+
+  for(i = 0; i < BINARY_FORMAT_CACHE_SIZE; i++)
+    free(binary_formats[i].format);
+
+  memset(binary_formats, 0, sizeof(binary_formats));
+  binary_formats_recorded = 0;
+  binary_log_time_fmt_generation = -1;
+
+}
+
+static void close_buffered_file(FileBuffer* buffer, FILE* stream) {
+
+  flush_file_buffer(buffer, stream);
+
+  acquire_crash_lock(&buffer->crash_lock);
+  buffer->descriptor = -1;
+  release_crash_lock(&buffer->crash_lock);
+
+  fclose(stream);
+
+}
+
+static void close_log_sink(LogSink* sink) {
+
+  if(!sink->attached)
+    return;
+
+  if(sink->stream != NULL && sink->owns_stream)
+    fclose(sink->stream);
+
+  else if(sink->stream != NULL)
+    fflush(sink->stream);
+
+  sink->stream = NULL;
+  sink->callback = NULL;
+  sink->attached = 0;
+
+}
+
+static void close_mapped_log_file() {
+
+  size_t length;
+
+  if(mapped_log_file == NULL)
+    return;
+
+  // Wait for the texts being copied into the mapping:
+  pthread_rwlock_wrlock(&mapped_log_file_lock);
+
+  // Discard the unused part of the last extent:
+  length = atomic_load(&mapped_log_file_offset);
+
+  if(length > atomic_load(&mapped_log_file_allocated))
+    length = atomic_load(&mapped_log_file_allocated);
+
+  munmap(mapped_log_file, MAPPED_LOG_FILE_WINDOW);
+  ftruncate(mapped_log_file_descriptor, length);
+  close(mapped_log_file_descriptor);
+
+  mapped_log_file = NULL;
+  mapped_log_file_descriptor = -1;
+
+  pthread_rwlock_unlock(&mapped_log_file_lock);
+
+}
+
+static int colors_enabled() {
+
+  int enabled = atomic_load_explicit(
+    &logger_colors_enabled,
+    memory_order_relaxed
+  );
+
+  // Resolve the default color mode on first use:
+  if(enabled < 0) {
+    enabled = isatty(STDOUT_FILENO);
+    atomic_store_explicit(
+      &logger_colors_enabled,
+      enabled,
+      memory_order_relaxed
+    );
+  }
+
+  return enabled;
+
+}
+
+static void copy_display_colors(
+  DisplayColors* destination,
+  const DisplayColors* origin
+) {
+  destination->background_color = origin->background_color;
+  destination->text_color = origin->text_color;
+}
+
+static size_t copy_record_contents(
+  char* contents,
+  size_t contents_size,
+  const char* context,
+  const char* fields,
+  const char* format,
+  va_list args,
+  size_t* context_length,
+  size_t* fields_length
+) {
+
+  int body_length;
+  size_t available;
+  va_list args_copy;
+
+  *context_length = 0;
+
+  // The context may take at most half of the record, leaving room for the
+  // message's contents:
+  if(context != NULL) {
+    *context_length = strnlen(context, contents_size / 2);
+    memcpy(contents, context, *context_length);
+  }
+
+  available = contents_size - *context_length;
+
+  // The fields are only kept whole, in at most half of the remaining room:
+  if(fields == NULL || *fields_length > available / 2)
+    *fields_length = 0;
+
+  else {
+    memcpy(contents + *context_length, fields, *fields_length);
+    contents += *fields_length;
+    available -= *fields_length;
+  }
+
+  // We need to copy the args va_list because format_message_text() makes the
+  // va_list unusable for future calls, like any v*printf().
+  va_copy(args_copy, args);
+  body_length = format_message_text(
+    contents + *context_length,
+    available,
+    format,
+    args_copy
+  );
+  va_end(args_copy);
+
+  if(body_length < 0)
+    body_length = 0;
+
+  return
+    (size_t) body_length < available ? (size_t) body_length : available - 1;
+
+}
+
+static void crash_signal_handler(int signal_number) {
+
+  AsyncRecordSlot *slot;
+  ThreadBuffer *buffer;
+  int console = atomic_load_explicit(
+    &console_output_enabled,
+    memory_order_relaxed
+  ), file_descriptor = -1;
+  size_t i, position;
+
+  // Restore the replaced actions first, so a crash while writing the pending
+  // messages isn't handled again:
+  for(i = 0; i < NUM_OF_CRASH_SIGNALS; i++)
+    sigaction(crash_signals[i], &previous_crash_actions[i], NULL);
+
+  // Only the first crashing thread writes the pending messages:
+  if(!atomic_flag_test_and_set(&crash_handler_running)) {
+
+    // The file buffers hold the oldest messages:
+    if(try_crash_lock(&log_file_buffer.crash_lock) == 0) {
+      file_descriptor = log_file_buffer.descriptor;
+
+      if(file_descriptor >= 0)
+        write_crash_text(
+          file_descriptor,
+          log_file_buffer.data,
+          log_file_buffer.length
+        );
+
+      log_file_buffer.length = 0;
+      release_crash_lock(&log_file_buffer.crash_lock);
+    }
+
+    if(try_crash_lock(&binary_log_file_buffer.crash_lock) == 0) {
+      if(binary_log_file_buffer.descriptor >= 0)
+        write_crash_text(
+          binary_log_file_buffer.descriptor,
+          binary_log_file_buffer.data,
+          binary_log_file_buffer.length
+        );
+
+      binary_log_file_buffer.length = 0;
+      release_crash_lock(&binary_log_file_buffer.crash_lock);
+    }
+
+    // Then come the messages not taken by the async writer thread yet:
+    if(async_ring != NULL) {
+
+      position = atomic_load_explicit(
+        &async_dequeue_position,
+        memory_order_relaxed
+      );
+
+      for(i = 0; i <= async_ring_mask; i++, position++) {
+
+        slot = &async_ring[position & async_ring_mask];
+
+        if(write_crash_record(slot, position, file_descriptor) != 0)
+          break;
+
+      }
+
+    }
+
+    // And the messages buffered by each thread, which can't be changed or
+    // freed while their crash locks are held:
+    if(try_crash_lock(&thread_buffers_crash_lock) == 0) {
+
+      for(buffer = thread_buffers; buffer != NULL; buffer = buffer->next) {
+
+        if(try_crash_lock(&buffer->crash_lock) != 0)
+          continue;
+
+        if(console)
+          write_crash_text(
+            STDOUT_FILENO,
+            buffer->console.data,
+            buffer->console.length
+          );
+
+        if(file_descriptor >= 0)
+          write_crash_text(
+            file_descriptor,
+            buffer->file.data,
+            buffer->file.length
+          );
+
+        buffer->console.length = 0;
+        buffer->file.length = 0;
+        release_crash_lock(&buffer->crash_lock);
+
+      }
+
+      release_crash_lock(&thread_buffers_crash_lock);
+
+    }
+
+  }
+
+  raise(signal_number);
+
+}
+
+static void create_configuration_reader_key() {
+  configuration_reader_key_created = pthread_key_create(
+    &configuration_reader_key,
+    free_configuration_reader
+  ) == 0;
+}
+
+static void create_scratch_body_key() {
+  scratch_body_key_created =
+    pthread_key_create(&scratch_body_key, free_scratch_body) == 0;
+}
+
+static int decode_binary_arguments(
+  FILE* file,
+  const char* format,
+  TextBuffer* body
+) {
+
+  char argument_storage[LINE_STORAGE_SIZE];
+  char specification[MAX_CONVERSION_LENGTH + 32];
+  const char *conversion_text, *text = format;
+  double double_value;
+  FormatConversion conversion;
+  int result = 0;
+  int32_t star_value;
+  int64_t integer_value;
+  long double long_double_value;
+  size_t i, conversion_length, specification_length;
+  TextBuffer argument;
+  uint32_t string_length;
+
+  while(*text != '\0' && result == 0) {
+
+    // Copy the text up to the next conversion as is:
+    conversion_text = strchr(text, '%');
+
+    if(conversion_text == NULL) {
+      text_buffer_append_string(body, text);
+      break;
+    }
+
+    text_buffer_append(body, text, conversion_text - text);
+    conversion_length = parse_format_conversion(conversion_text, &conversion);
+    text = conversion_text + conversion_length;
+
+    if(conversion.type == UNSUPPORTED_ARGUMENT)
+      return -1;
+
+    // Substitute the "*" arguments into the conversion's text:
+    specification_length = 0;
+
+    for(i = 0; i < conversion_length; i++) {
+
+      if(conversion_text[i] != '*') {
+        specification[specification_length++] = conversion_text[i];
+        continue;
+      }
+
+      if(read_binary_log(file, &star_value, sizeof(star_value)) != 0)
+        return -1;
+
+      // A negative precision is taken as if it was omitted:
+      if(star_value < 0 && i > 0 && conversion_text[i-1] == '.')
+        specification_length--;
+
+      else
+        specification_length += sprintf(
+          specification + specification_length,
+          "%d",
+          (int) star_value
+        );
+
+    }
+
+    specification[specification_length] = '\0';
+
+    // Format the conversion with it's argument:
+    switch(conversion.type) {
+
+      case NO_ARGUMENT:
+        text_buffer_append_printf(body, specification);
+        break;
+
+      case INT_ARGUMENT:
+      case LONG_ARGUMENT:
+      case LONG_LONG_ARGUMENT:
+      case INTMAX_ARGUMENT:
+      case SIZE_ARGUMENT:
+      case PTRDIFF_ARGUMENT:
+      case POINTER_ARGUMENT:
+
+        if(read_binary_log(file, &integer_value, sizeof(integer_value)) != 0)
+          return -1;
+
+        if(conversion.type == INT_ARGUMENT)
+          text_buffer_append_printf(body, specification, (int) integer_value);
+
+        else if(conversion.type == LONG_ARGUMENT)
+          text_buffer_append_printf(body, specification, (long) integer_value);
+
+        else if(conversion.type == LONG_LONG_ARGUMENT)
+          text_buffer_append_printf(
+            body,
+            specification,
+            (long long) integer_value
+          );
+
+        else if(conversion.type == INTMAX_ARGUMENT)
+          text_buffer_append_printf(
+            body,
+            specification,
+            (intmax_t) integer_value
+          );
+
+        else if(conversion.type == SIZE_ARGUMENT)
+          text_buffer_append_printf(
+            body,
+            specification,
+            (size_t) integer_value
+          );
+
+        else if(conversion.type == PTRDIFF_ARGUMENT)
+          text_buffer_append_printf(
+            body,
+            specification,
+            (ptrdiff_t) integer_value
+          );
+
+        else
+          text_buffer_append_printf(
+            body,
+            specification,
+            (void*) (uintptr_t) integer_value
+          );
+
+        break;
+
+      case DOUBLE_ARGUMENT:
+
+        if(read_binary_log(file, &double_value, sizeof(double_value)) != 0)
+          return -1;
+
+        text_buffer_append_printf(body, specification, double_value);
+        break;
+
+      case LONG_DOUBLE_ARGUMENT:
+
+        if(
+          read_binary_log(
+            file,
+            &long_double_value,
+            sizeof(long_double_value)
+          ) != 0
+        )
+          return -1;
+
+        text_buffer_append_printf(body, specification, long_double_value);
+        break;
+
+      case STRING_ARGUMENT:
+
+        if(read_binary_log(file, &string_length, sizeof(string_length)) != 0)
+          return -1;
+
+        // NULL strings are formatted as the C library does:
+        if(string_length == UINT32_MAX) {
+          text_buffer_append_printf(body, specification, (char*) NULL);
+          break;
+        }
+
+        text_buffer_init(&argument, argument_storage, sizeof(argument_storage));
+
+        if(read_binary_text(file, &argument, string_length) == 0)
+          text_buffer_append_printf(body, specification, argument.data);
+
+        else
+          result = -1;
+
+        text_buffer_release(&argument);
+        break;
+
+    }
+
+  }
+
+  return result;
+
+}
+
+static size_t drain_async_ring(
+  TextBuffer* console_batch,
+  TextBuffer* file_batch
+) {
+
+  AsyncRecordSlot *slot;
+  int has_errors = 0, i;
+  LogRecord record;
+  size_t num_of_records = 0, position;
+  time_t batch_time = 0;
+
+  // Acquire logger lock, since the configurations are shared:
+  lock_logger();
+
+  position = atomic_load_explicit(
+    &async_dequeue_position,
+    memory_order_relaxed
+  );
+
+  while(
+    console_batch->length < async_batch_size &&
+    file_batch->length < async_batch_size
+  ) {
+
+    slot = &async_ring[position & async_ring_mask];
+
+    // Stop when the next slot was not published by it's producer yet:
+    if(
+      atomic_load_explicit(&slot->sequence, memory_order_acquire) !=
+      position + 1
+    )
+      break;
+
+    record.category = slot->category;
+    record.timestamp = slot->timestamp;
+    record.context = slot->has_context ? slot->contents : NULL;
+    record.context_length = slot->context_length;
+    record.fields = slot->contents + slot->context_length;
+    record.fields_length = slot->fields_length;
+    record.body = record.fields + record.fields_length;
+    record.body_length = slot->body_length;
+
+    if(atomic_load_explicit(&console_output_enabled, memory_order_relaxed))
+      render_console_record(console_batch, &record, colors_enabled());
+
+    if(log_file != NULL || mapped_log_file != NULL)
+      render_log_file_line(
+        file_batch,
+        &record,
+        atomic_load_explicit(&log_file_format, memory_order_relaxed)
+      );
+
+    if(num_of_log_sinks > 0)
+      write_log_sinks(&record, NULL, NULL);
+
+    batch_time = record.timestamp.tv_sec;
+    has_errors |= record.category == ERROR_MSG;
+
+    // Release the slot for the producer one lap ahead:
+    atomic_store_explicit(
+      &slot->sequence,
+      position + async_ring_mask + 1,
+      memory_order_release
+    );
+    position++;
+    atomic_store_explicit(
+      &async_dequeue_position,
+      position,
+      memory_order_relaxed
+    );
+    num_of_records++;
+
+  }
+
+  // Write the whole batch at once:
+  if(num_of_records > 0) {
+
+    if(console_batch->length > 0) {
+      fwrite(console_batch->data, 1, console_batch->length, stdout);
+      fflush(stdout);
+    }
+
+    if(log_file != NULL) {
+      write_log_file(file_batch->data, file_batch->length, batch_time);
+
+      // Force error messages to disk if the durability policy says so:
+      if(has_errors && log_durability_policy.sync_errors)
+        sync_log_file();
+
+      else
+        flush_file_buffer(&log_file_buffer, log_file);
+    }
+
+    if(mapped_log_file != NULL)
+      write_mapped_log_file(file_batch->data, file_batch->length);
+
+    for(i = 0; i < MAX_LOG_SINKS; i++) {
+      if(log_sinks[i].attached && log_sinks[i].stream != NULL)
+        fflush(log_sinks[i].stream);
+    }
+
+  }
+
+  console_batch->length = 0;
+  file_batch->length = 0;
+
+  // Release logger lock:
+  unlock_logger();
+
+  return num_of_records;
+
+}
+
+static void end_flight_record(FlightRecorder* recorder, FlightRecord* record) {
+
+  size_t position = atomic_load_explicit(
+    &recorder->position,
+    memory_order_relaxed
+  );
+
+  atomic_store_explicit(&record->sequence, position + 1, memory_order_release);
+  atomic_store_explicit(
+    &recorder->position,
+    position + 1,
+    memory_order_release
+  );
+
+}
+
+static void enqueue_async_record(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+) {
+
+  AsyncRecordSlot *slot;
+  char console_storage[LINE_STORAGE_SIZE], file_storage[LINE_STORAGE_SIZE];
+  intptr_t difference;
+  LogRecord record;
+  size_t position;
+  TextBuffer console_batch, file_batch;
+
+  // Claim the slot at the current enqueue position:
+  position = atomic_load_explicit(
+    &async_enqueue_position,
+    memory_order_relaxed
+  );
+
+  while(1) {
+
+    slot = &async_ring[position & async_ring_mask];
+    difference = (intptr_t) atomic_load_explicit(
+      &slot->sequence,
+      memory_order_acquire
+    ) - (intptr_t) position;
+
+    if(difference == 0) {
+      // On failure, the position is updated with the current enqueue position.
+      if(
+        atomic_compare_exchange_weak_explicit(
+          &async_enqueue_position,
+          &position,
+          position + 1,
+          memory_order_relaxed,
+          memory_order_relaxed
+        )
+      )
+        break;
+    }
+
+    else {
+      // If the slot wasn't consumed yet, the ring buffer is full and we wait
+      // for the writer thread to catch up, unless this thread holds the lock
+      // the writer thread needs. Then, we write the oldest messages ourselves,
+      // which also keeps them in order:
+      if(difference < 0 && logger_lock_held) {
+        text_buffer_init(
+          &console_batch,
+          console_storage,
+          sizeof(console_storage)
+        );
+        text_buffer_init(&file_batch, file_storage, sizeof(file_storage));
+        drain_async_ring(&console_batch, &file_batch);
+        text_buffer_release(&console_batch);
+        text_buffer_release(&file_batch);
+      }
+
+      else if(difference < 0)
+        sched_yield();
+
+      position = atomic_load_explicit(
+        &async_enqueue_position,
+        memory_order_relaxed
+      );
+    }
+
+  }
+
+  // Copy the message to the slot:
+  slot->category = category;
+  clock_gettime(CLOCK_REALTIME, &slot->timestamp);
+  slot->has_context = context != NULL;
+  slot->fields_length = fields_length;
+  slot->body_length = copy_record_contents(
+    slot->contents,
+    ASYNC_RECORD_SIZE,
+    context,
+    fields,
+    format,
+    args,
+    &slot->context_length,
+    &slot->fields_length
+  );
+
+  // Keep the text in the flight recorder too, while the slot is still ours:
+  if(
+    atomic_load_explicit(&logger_enabled_categories, memory_order_relaxed) &
+    FLIGHT_RECORDER_FLAG
+  ) {
+    record.category = category;
+    record.timestamp = slot->timestamp;
+    record.context = slot->has_context ? slot->contents : NULL;
+    record.context_length = slot->context_length;
+    record.fields = slot->contents + slot->context_length;
+    record.fields_length = slot->fields_length;
+    record.body = record.fields + record.fields_length;
+    record.body_length = slot->body_length;
+    record_flight_record(
+      &record,
+      atomic_load_explicit(&log_file, memory_order_relaxed) != NULL ||
+      atomic_load_explicit(&mapped_log_file, memory_order_relaxed) != NULL
+    );
+  }
+
+  // Publish the slot to the writer thread:
+  atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+}
+
+static const BinaryFormat* find_binary_format(const char* format) {
+
+  BinaryFormat *entry;
+  const char *text = format;
+  FormatConversion conversion;
+  size_t i, length;
+  uint32_t hash = 2166136261u, recorded_length;
+  unsigned char kind = FORMAT_RECORD;
+
+  // Hash the format string's contents with FNV-1a:
+  for(length = 0; format[length] != '\0'; length++)
+    hash = (hash ^ (unsigned char) format[length]) * 16777619u;
+
+  // Look for the format string or for the first unused entry after it's hash:
+  for(i = 0; i < BINARY_FORMAT_CACHE_SIZE; i++) {
+
+    entry = &binary_formats[(hash + i) & (BINARY_FORMAT_CACHE_SIZE - 1)];
+
+    if(entry->format == NULL)
+      break;
+
+    if(
+      entry->hash == hash &&
+      entry->length == length &&
+      memcmp(entry->format, format, length) == 0
+    )
+      return entry;
+
+  }
+
+  if(i == BINARY_FORMAT_CACHE_SIZE || length > UINT32_MAX)
+    return NULL;
+
+  // Keep a copy, since the caller's format string may be changed or freed:
+  entry->format = malloc(length + 1);
+
+  if(entry->format == NULL)
+    return NULL;
+
+  memcpy(entry->format, format, length + 1);
+
+  // Parse the conversions with arguments of a new format string:
+  entry->length = length;
+  entry->hash = hash;
+  entry->id = binary_formats_recorded++;
+  entry->num_of_conversions = 0;
+
+  while((text = strchr(text, '%')) != NULL) {
+
+    text += parse_format_conversion(text, &conversion);
+
+    if(conversion.type == NO_ARGUMENT)
+      continue;
+
+    if(
+      conversion.type == UNSUPPORTED_ARGUMENT ||
+      entry->num_of_conversions == MAX_BINARY_CONVERSIONS
+    ) {
+      entry->num_of_conversions = -1;
+      break;
+    }
+
+    entry->conversions[entry->num_of_conversions++] = conversion;
+
+  }
+
+  // Only format strings that can be recorded are written to the file:
+  if(entry->num_of_conversions >= 0) {
+    recorded_length = length;
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      &kind,
+      sizeof(kind)
+    );
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      &entry->id,
+      sizeof(entry->id)
+    );
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      &recorded_length,
+      sizeof(recorded_length)
+    );
+    write_file_buffer(&binary_log_file_buffer, binary_log_file, format, length);
+  }
+
+  return entry;
+
+}
+
+#ifdef LOGGER_USES_X86_SIMD
+__attribute__((target("avx2")))
+static size_t find_json_escape_avx2(const char* text, size_t text_length) {
+
+  const __m256i backslashes = _mm256_set1_epi8('\\');
+  const __m256i last_controls = _mm256_set1_epi8(0x1F);
+  const __m256i quotes = _mm256_set1_epi8('"');
+  __m256i chars, matches;
+  size_t position = 0;
+  unsigned int mask;
+
+  for(; position + 32 <= text_length; position += 32) {
+
+    chars = _mm256_loadu_si256((const __m256i*) (text + position));
+
+    // Control characters are the chars not above 0x1F, as unsigned bytes:
+    matches = _mm256_or_si256(
+      _mm256_or_si256(
+        _mm256_cmpeq_epi8(chars, quotes),
+        _mm256_cmpeq_epi8(chars, backslashes)
+      ),
+      _mm256_cmpeq_epi8(_mm256_min_epu8(chars, last_controls), chars)
+    );
+    mask = (unsigned int) _mm256_movemask_epi8(matches);
+
+    if(mask != 0)
+      return position + __builtin_ctz(mask);
+
+  }
+
+  return position +
+    find_json_escape_sse2(text + position, text_length - position);
+
+}
+#endif
+
+static size_t find_json_escape_scalar(const char* text, size_t text_length) {
+
+  size_t position;
+  unsigned char character;
+
+  for(position = 0; position < text_length; position++) {
+
+    character = text[position];
+
+    if(character < 0x20 || character == '"' || character == '\\')
+      break;
+
+  }
+
+  return position;
+
+}
+
+#ifdef LOGGER_USES_X86_SIMD
+__attribute__((target("sse2")))
+static size_t find_json_escape_sse2(const char* text, size_t text_length) {
+
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  const __m128i last_controls = _mm_set1_epi8(0x1F);
+  const __m128i quotes = _mm_set1_epi8('"');
+  __m128i chars, matches;
+  size_t position = 0;
+  unsigned int mask;
+
+  for(; position + 16 <= text_length; position += 16) {
+
+    chars = _mm_loadu_si128((const __m128i*) (text + position));
+
+    // Control characters are the chars not above 0x1F, as unsigned bytes:
+    matches = _mm_or_si128(
+      _mm_or_si128(
+        _mm_cmpeq_epi8(chars, quotes),
+        _mm_cmpeq_epi8(chars, backslashes)
+      ),
+      _mm_cmpeq_epi8(_mm_min_epu8(chars, last_controls), chars)
+    );
+    mask = (unsigned int) _mm_movemask_epi8(matches);
+
+    if(mask != 0)
+      return position + __builtin_ctz(mask);
+
+  }
+
+  return position +
+    find_json_escape_scalar(text + position, text_length - position);
+
+}
+#endif
+
+static void flush_file_buffer(FileBuffer* buffer, FILE* stream) {
+
+  if(buffer->length == 0 || stream == NULL)
+    return;
+
+  acquire_crash_lock(&buffer->crash_lock);
+  fwrite(buffer->data, 1, buffer->length, stream);
+  buffer->length = 0;
+  release_crash_lock(&buffer->crash_lock);
+
+}
+
+static void flush_file_buffers() {
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  flush_file_buffer(&log_file_buffer, log_file);
+  flush_file_buffer(&binary_log_file_buffer, binary_log_file);
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+}
+
+static void flush_thread_buffer(ThreadBuffer* buffer) {
+
+  // Acquire logger lock, since the outputs are shared:
+  lock_logger();
+
+  if(buffer->console.length > 0)
+    fwrite(buffer->console.data, 1, buffer->console.length, stdout);
+
+  if(log_file != NULL && buffer->file.length > 0)
+    write_log_file(
+      buffer->file.data,
+      buffer->file.length,
+      buffer->last_message_time
+    );
+
+  // Release logger lock:
+  unlock_logger();
+
+  // Memory mapped log files are written to concurrently, without the lock:
+  if(mapped_log_file != NULL && buffer->file.length > 0)
+    write_mapped_log_file(buffer->file.data, buffer->file.length);
+
+  buffer->console.length = 0;
+  buffer->file.length = 0;
+  clock_gettime(CLOCK_REALTIME, &buffer->flush_time);
+
+}
+
+static int format_fixed_double(char* text, double value, int precision) {
+
+  char fraction_digits[MAX_FIXED_PRECISION], integer_digits[20];
+  char *integer_text, *integer_end = integer_digits + sizeof(integer_digits);
+  FixedFraction fraction = 0, half, mask = 0;
+  int exponent, i, length, round_up, shift = 0;
+  uint64_t bits, integer, mantissa;
+
+  if(!isfinite(value) || precision > MAX_FIXED_PRECISION)
+    return -1;
+
+  // Split the double into an integer mantissa and a binary exponent:
+  memcpy(&bits, &value, sizeof(bits));
+  exponent = (bits >> 52) & 0x7FF;
+  mantissa = bits & ((UINT64_C(1) << 52) - 1);
+
+  if(exponent == 0)
+    exponent = -1074;
+
+  else {
+    mantissa |= UINT64_C(1) << 52;
+    exponent -= 1075;
+  }
+
+  // Split the mantissa into it's integer and fraction bits:
+  if(exponent >= 0) {
+
+    if(exponent > 11)
+      return -1;
+
+    integer = mantissa << exponent;
+
+  }
+
+  else if(-exponent <= MAX_FIXED_FRACTION_BITS) {
+    shift = -exponent;
+    integer = shift < 64 ? mantissa >> shift : 0;
+    mask = ((FixedFraction) 1 << shift) - 1;
+    fraction = mantissa & mask;
+  }
+
+  // Doubles below 2^-60 round to zero with any supported precision:
+  else if(-exponent >= 53 + 60)
+    integer = 0;
+
+  else
+    return -1;
+
+  // Multiply the fraction by 10 once for each digit:
+  for(i = 0; i < precision; i++) {
+    fraction *= 10;
+    fraction_digits[i] = '0' + (char) (fraction >> shift);
+    fraction &= mask;
+  }
+
+  // Round the remainder to the nearest, ties to even:
+  if(shift > 0) {
+
+    half = (FixedFraction) 1 << (shift - 1);
+    round_up = fraction > half || (
+      fraction == half &&
+      (precision > 0 ? fraction_digits[precision-1] - '0' : integer) % 2 == 1
+    );
+
+    if(round_up) {
+
+      for(i = precision - 1; i >= 0 && fraction_digits[i] == '9'; i--)
+        fraction_digits[i] = '0';
+
+      if(i >= 0)
+        fraction_digits[i]++;
+
+      else
+        integer++;
+
+    }
+
+  }
+
+  integer_text = format_unsigned_digits(integer_end, integer, 10, 0);
+  length = integer_end - integer_text;
+  memcpy(text, integer_text, length);
+
+  if(precision > 0) {
+    text[length++] = '.';
+    memcpy(text + length, fraction_digits, precision);
+    length += precision;
+  }
+
+  return length;
+
+}
+
+static int format_message_text(
+  char* text,
+  size_t text_size,
+  const char* format,
+  va_list args
+) {
+
+  char conversion, digits[FORMAT_DIGITS_SIZE], length_modifier;
+  char *digits_end = digits + sizeof(digits);
+  const char *argument_text, *conversion_text, *prefix, *text_format = format;
+  double double_value;
+  FormattedText formatted = { .data = text, .size = text_size, .length = 0 };
+  int digits_length, left_aligned, precision, supported = 1, zero_padded;
+  long long signed_value;
+  size_t argument_length, prefix_length, width;
+  unsigned long long value;
+  va_list args_copy;
+
+  // We need to copy the args va_list because the conversions read so far
+  // would be lost if the text has to be formatted by vsnprintf() instead.
+  va_copy(args_copy, args);
+
+  while(*format != '\0' && supported) {
+
+    // Copy the text up to the next conversion as is:
+    conversion_text = strchr(format, '%');
+
+    if(conversion_text == NULL) {
+      formatted_text_append(&formatted, format, strlen(format));
+      break;
+    }
+
+    formatted_text_append(&formatted, format, conversion_text - format);
+    format = conversion_text + 1;
+
+    // Flags:
+    left_aligned = 0;
+    zero_padded = 0;
+
+    for(; *format == '-' || *format == '0'; format++) {
+      if(*format == '-')
+        left_aligned = 1;
+
+      else
+        zero_padded = 1;
+    }
+
+    // Width and precision:
+    width = 0;
+    precision = -1;
+
+    while(*format >= '0' && *format <= '9' && width <= MAX_FAST_FORMAT_WIDTH)
+      width = 10 * width + *format++ - '0';
+
+    if(*format == '.') {
+
+      precision = 0;
+      format++;
+
+      while(
+        *format >= '0' && *format <= '9' &&
+        precision <= MAX_FAST_FORMAT_WIDTH
+      )
+        precision = 10 * precision + *format++ - '0';
+
+    }
+
+    if(width > MAX_FAST_FORMAT_WIDTH || precision > MAX_FAST_FORMAT_WIDTH) {
+      supported = 0;
+      break;
+    }
+
+    // Length modifier, where "L" stands for "ll":
+    length_modifier = '\0';
+
+    if(*format == 'l' && format[1] == 'l') {
+      length_modifier = 'L';
+      format += 2;
+    }
+
+    else if(*format == 'l' || *format == 'z')
+      length_modifier = *format++;
+
+    conversion = *format;
+
+    if(conversion != '\0')
+      format++;
+
+    prefix = "";
+    prefix_length = 0;
+    argument_text = digits;
+    argument_length = 0;
+
+    switch(conversion) {
+
+      case '%':
+        supported =
+          !left_aligned && !zero_padded && width == 0 && precision < 0 &&
+          length_modifier == '\0';
+        argument_text = "%";
+        argument_length = 1;
+        break;
+
+      case 'd':
+      case 'i':
+
+        if(length_modifier == 'l')
+          signed_value = va_arg(args_copy, long);
+
+        else if(length_modifier == 'L')
+          signed_value = va_arg(args_copy, long long);
+
+        else if(length_modifier == 'z')
+          signed_value = va_arg(args_copy, ssize_t);
+
+        else
+          signed_value = va_arg(args_copy, int);
+
+        value = signed_value;
+
+        if(signed_value < 0) {
+          prefix = "-";
+          prefix_length = 1;
+          value = -value;
+        }
+
+        argument_text = format_unsigned_digits(digits_end, value, 10, 0);
+        argument_length = digits_end - argument_text;
+        supported = precision < 0;
+        break;
+
+      case 'u':
+      case 'x':
+      case 'X':
+
+        if(length_modifier == 'l')
+          value = va_arg(args_copy, unsigned long);
+
+        else if(length_modifier == 'L')
+          value = va_arg(args_copy, unsigned long long);
+
+        else if(length_modifier == 'z')
+          value = va_arg(args_copy, size_t);
+
+        else
+          value = va_arg(args_copy, unsigned);
+
+        argument_text = format_unsigned_digits(
+          digits_end,
+          value,
+          conversion == 'u' ? 10 : 16,
+          conversion == 'X'
+        );
+        argument_length = digits_end - argument_text;
+        supported = precision < 0;
+        break;
+
+      case 'c':
+        digits[0] = (unsigned char) va_arg(args_copy, int);
+        argument_length = 1;
+        supported = !zero_padded && precision < 0 && length_modifier == '\0';
+        break;
+
+      case 's':
+        argument_text = va_arg(args_copy, const char*);
+        supported =
+          argument_text != NULL && !zero_padded && length_modifier == '\0';
+
+        if(supported)
+          argument_length = precision < 0 ?
+            strlen(argument_text) :
+            strnlen(argument_text, precision);
+
+        break;
+
+      case 'p':
+        value = (uintptr_t) va_arg(args_copy, void*);
+        argument_text = format_unsigned_digits(digits_end, value, 16, 0);
+        argument_length = digits_end - argument_text;
+        prefix = "0x";
+        prefix_length = 2;
+        supported =
+          value != 0 && !zero_padded && precision < 0 &&
+          length_modifier == '\0';
+        break;
+
+      case 'f':
+      case 'F':
+        double_value = va_arg(args_copy, double);
+        digits_length = format_fixed_double(
+          digits,
+          double_value,
+          precision < 0 ? 6 : precision
+        );
+        argument_length = digits_length;
+
+        if(signbit(double_value)) {
+          prefix = "-";
+          prefix_length = 1;
+        }
+
+        supported =
+          digits_length >= 0 &&
+          (length_modifier == '\0' || length_modifier == 'l');
+        break;
+
+      default:
+        supported = 0;
+        break;
+
+    }
+
+    if(!supported)
+      break;
+
+    // Pad the conversion to it's width:
+    if(width <= prefix_length + argument_length)
+      width = 0;
+
+    else
+      width -= prefix_length + argument_length;
+
+    if(!left_aligned && !zero_padded)
+      formatted_text_pad(&formatted, ' ', width);
+
+    formatted_text_append(&formatted, prefix, prefix_length);
+
+    if(!left_aligned && zero_padded)
+      formatted_text_pad(&formatted, '0', width);
+
+    formatted_text_append(&formatted, argument_text, argument_length);
+
+    if(left_aligned)
+      formatted_text_pad(&formatted, ' ', width);
+
+  }
+
+  va_end(args_copy);
+
+  if(!supported)
+    return vsnprintf(text, text_size, text_format, args);
+
+  if(text_size > 0)
+    text[formatted.length < text_size ? formatted.length : text_size - 1] =
+      '\0';
+
+  return formatted.length <= INT_MAX ? (int) formatted.length : -1;
+
+}
+
+static char* format_unsigned_digits(
+  char* end,
+  unsigned long long value,
+  unsigned base,
+  int uppercase
+) {
+
+  const char *hexadecimal_digits = uppercase ?
+    "0123456789ABCDEF" :
+    "0123456789abcdef";
+
+  if(base == 16) {
+
+    do {
+      *--end = hexadecimal_digits[value & 0xF];
+      value >>= 4;
+    } while(value > 0);
+
+    return end;
+
+  }
+
+  while(value >= 100) {
+    end -= 2;
+    memcpy(end, decimal_digit_pairs + 2 * (value % 100), 2);
+    value /= 100;
+  }
+
+  if(value >= 10) {
+    end -= 2;
+    memcpy(end, decimal_digit_pairs + 2 * value, 2);
+  }
+
+  else
+    *--end = '0' + value;
+
+  return end;
+
+}
+
+static void formatted_text_append(
+  FormattedText* text,
+  const char* chars,
+  size_t chars_length
+) {
+
+  size_t copied_length = 0;
+
+  if(text->length + 1 < text->size) {
+    copied_length = text->size - text->length - 1;
+
+    if(copied_length > chars_length)
+      copied_length = chars_length;
+
+    memcpy(text->data + text->length, chars, copied_length);
+  }
+
+  text->length += chars_length;
+
+}
+
+static void formatted_text_pad(
+  FormattedText* text,
+  char padding,
+  size_t padding_length
+) {
+
+  size_t copied_length = 0;
+
+  if(text->length + 1 < text->size) {
+    copied_length = text->size - text->length - 1;
+
+    if(copied_length > padding_length)
+      copied_length = padding_length;
+
+    memset(text->data + text->length, padding, copied_length);
+  }
+
+  text->length += padding_length;
+
+}
+
+static void free_configuration_reader(void* reader) {
+
+  // Messages logged by later destructors claim a reader again:
+  thread_configuration_reader = NULL;
+  atomic_store(&((ConfigurationReader*) reader)->claimed, 0);
+
+}
+
+static void free_scratch_body(void* body) {
+  text_buffer_release(body);
+}
+
+static const char* get_cached_timestamp(
+  const struct timespec* time,
+  const TimeFormat* time_format,
+  size_t* timestamp_length
+) {
+
+  char partial_format[TIME_FMT_SIZE];
+  const char *format = time_format->string_representation, *suffix = NULL;
+  TimestampCache *cache = NULL;
+  int i, fraction_digits = 0;
+  long fraction;
+  size_t available, prefix_length = 0;
+  struct tm time_info;
+  unsigned int generation = atomic_load_explicit(
+    &logger_time_fmt_generation,
+    memory_order_relaxed
+  );
+
+  // Look for the cache of the time format, replacing another one if needed:
+  for(i = 0; i < TIMESTAMP_CACHE_SIZE && cache == NULL; i++) {
+    if(thread_timestamp_caches[i].time_format == time_format)
+      cache = &thread_timestamp_caches[i];
+  }
+
+  if(cache == NULL) {
+    cache = &thread_timestamp_caches[
+      thread_timestamp_cache_victim++ % TIMESTAMP_CACHE_SIZE
+    ];
+    cache->time_format = NULL;
+  }
+
+  if(
+    cache->second != time->tv_sec ||
+    cache->time_format != time_format ||
+    cache->generation != generation
+  ) {
+
+    // Look for a sub-second conversion in the time format:
+    for(i = 0; format[i] != '\0' && suffix == NULL; i++) {
+
+      if(format[i] != '%' || format[i+1] == '\0')
+        continue;
+
+      if(format[i+1] == 'N') {
+        fraction_digits = 9;
+        prefix_length = i;
+        suffix = &format[i+2];
+      }
+
+      else if(format[i+1] >= '1' && format[i+1] <= '9' && format[i+2] == 'N') {
+        fraction_digits = format[i+1] - '0';
+        prefix_length = i;
+        suffix = &format[i+3];
+      }
+
+      // Skip the conversion's character (e.g: in a "%%" conversion):
+      else
+        i++;
+
+    }
+
+    localtime_r(&time->tv_sec, &time_info);
+
+    if(suffix == NULL)
+      cache->length = strftime(cache->text, TIME_FMT_SIZE, format, &time_info);
+
+    // Format the text around the sub-second digits separately:
+    else {
+
+      memcpy(partial_format, format, prefix_length);
+      partial_format[prefix_length] = '\0';
+      cache->length = strftime(
+        cache->text,
+        TIME_FMT_SIZE,
+        partial_format,
+        &time_info
+      );
+
+      if(cache->length + fraction_digits >= TIME_FMT_SIZE)
+        fraction_digits = 0;
+
+      cache->fraction_offset = cache->length;
+      cache->length += fraction_digits;
+      available = TIME_FMT_SIZE - cache->length;
+      cache->length += strftime(
+        cache->text + cache->length,
+        available,
+        suffix,
+        &time_info
+      );
+
+    }
+
+    cache->fraction_digits = fraction_digits;
+    cache->second = time->tv_sec;
+    cache->time_format = time_format;
+    cache->generation = generation;
+
+  }
+
+  // Rewrite the sub-second digits, from the least significant one:
+  fraction = time->tv_nsec;
+
+  for(i = cache->fraction_digits; i < 9; i++)
+    fraction /= 10;
+
+  for(i = cache->fraction_digits - 1; i >= 0; i--) {
+    cache->text[cache->fraction_offset + i] = '0' + fraction % 10;
+    fraction /= 10;
+  }
+
+  *timestamp_length = cache->length;
+
+  return cache->text;
+
+}
+
+static const LoggerConfiguration* get_configuration() {
+
+  const LoggerConfiguration *configuration = atomic_load_explicit(
+    &logger_configuration,
+    memory_order_acquire
+  );
+
+  if(configuration == NULL) {
+    pthread_once(&logger_configuration_once, publish_default_configuration);
+    configuration = atomic_load_explicit(
+      &logger_configuration,
+      memory_order_acquire
+    );
+  }
+
+  return configuration;
+
+}
+
+static ThreadBuffer* get_thread_buffer() {
+
+  ThreadBuffer *buffer = pthread_getspecific(thread_buffer_key);
+
+  if(buffer != NULL)
+    return buffer;
+
+  buffer = malloc(sizeof(ThreadBuffer));
+
+  if(buffer == NULL)
+    return NULL;
+
+  text_buffer_init(
+    &buffer->console,
+    buffer->console_storage,
+    sizeof(buffer->console_storage)
+  );
+  text_buffer_init(
+    &buffer->file,
+    buffer->file_storage,
+    sizeof(buffer->file_storage)
+  );
+
+  // The buffers hold many messages, so we reserve that memory upfront:
+  text_buffer_reserve(&buffer->console, thread_buffer_size);
+  text_buffer_reserve(&buffer->file, thread_buffer_size);
+
+  buffer->last_message_time = 0;
+  clock_gettime(CLOCK_REALTIME, &buffer->flush_time);
+  pthread_mutex_init(&buffer->mutex, NULL);
+  atomic_flag_clear(&buffer->crash_lock);
+
+  // Add the buffer to the list of thread buffers:
+  pthread_mutex_lock(&thread_buffers_mutex);
+  acquire_crash_lock(&thread_buffers_crash_lock);
+
+  buffer->previous = NULL;
+  buffer->next = thread_buffers;
+
+  if(thread_buffers != NULL)
+    thread_buffers->previous = buffer;
+
+  thread_buffers = buffer;
+
+  release_crash_lock(&thread_buffers_crash_lock);
+  pthread_mutex_unlock(&thread_buffers_mutex);
+
+  pthread_setspecific(thread_buffer_key, buffer);
+
+  return buffer;
+
+}
+
+static int grow_mapped_log_file(size_t required_length) {
+
+  int result = 0;
+  size_t allocated, new_length;
+
+  pthread_mutex_lock(&mapped_log_file_growth_mutex);
+
+  // Another thread may have grown the file while we waited:
+  allocated = atomic_load_explicit(
+    &mapped_log_file_allocated,
+    memory_order_relaxed
+  );
+
+  if(required_length > allocated) {
+
+    new_length = allocated + mapped_log_file_extent;
+
+    if(new_length < required_length)
+      new_length = required_length;
+
+    // Round up to a whole number of extents, without exceeding the mapping:
+    if(new_length % mapped_log_file_extent != 0)
+      new_length += mapped_log_file_extent - new_length % mapped_log_file_extent;
+
+    if(new_length > MAPPED_LOG_FILE_WINDOW)
+      new_length = MAPPED_LOG_FILE_WINDOW;
+
+    if(
+      posix_fallocate(
+        mapped_log_file_descriptor,
+        allocated,
+        new_length - allocated
+      ) == 0
+    )
+      atomic_store_explicit(
+        &mapped_log_file_allocated,
+        new_length,
+        memory_order_release
+      );
+
+    else
+      result = -1;
+
+  }
+
+  pthread_mutex_unlock(&mapped_log_file_growth_mutex);
+
+  return result;
+
+}
+
+static void* log_archive_routine(void* args) {
+
+  LogArchiveJob *job;
+
+  pthread_mutex_lock(&log_archive_mutex);
+
+  while(log_archive_running || log_archive_queue != NULL) {
+
+    if(log_archive_queue == NULL) {
+      pthread_cond_wait(&log_archive_condition, &log_archive_mutex);
+      continue;
+    }
+
+    job = log_archive_queue;
+    log_archive_queue = job->next;
+
+    if(log_archive_queue == NULL)
+      log_archive_queue_tail = NULL;
+
+    // Archive the log file without blocking the rotations queueing others:
+    pthread_mutex_unlock(&log_archive_mutex);
+    archive_log_file(job);
+    pthread_mutex_lock(&log_archive_mutex);
+
+  }
+
+  pthread_mutex_unlock(&log_archive_mutex);
+
+  return NULL;
+
+}
+
+static void log_category_message(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+) {
+
+  char body_storage[LINE_STORAGE_SIZE];
+  char console_storage[LINE_STORAGE_SIZE], file_storage[LINE_STORAGE_SIZE];
+  int console = atomic_load_explicit(
+    &console_output_enabled,
+    memory_order_relaxed
+  ), dumping, recording;
+  LogFileFormat file_format;
+  LogRecord record;
+  TextBuffer *body, console_line, file_line, nested_body;
+  unsigned int categories = atomic_load_explicit(
+    &logger_enabled_categories,
+    memory_order_acquire
+  );
+
+  // The flight recorder keeps every message and, before an error is written,
+  // writes the messages that led to it missing from the log file:
+  recording = (categories & FLIGHT_RECORDER_FLAG) != 0;
+  dumping = recording && category == ERROR_MSG;
+
+  // Messages of disabled categories are only kept by the flight recorder:
+  if(!(categories & CATEGORY_MASK(category))) {
+    if(recording)
+      record_flight_message(
+        category,
+        context,
+        fields,
+        fields_length,
+        format,
+        args
+      );
+    return;
+  }
+
+  // Record the message's arguments in the binary log file, unformatted:
+  if(binary_log_file != NULL)
+    write_binary_record(category, context, format, args);
+
+  // Skip formatting when no output needs the message as text:
+  if(
+    !console &&
+    atomic_load_explicit(&log_file, memory_order_relaxed) == NULL &&
+    atomic_load_explicit(&mapped_log_file, memory_order_relaxed) == NULL &&
+    atomic_load_explicit(&num_of_log_sinks, memory_order_relaxed) == 0
+  ) {
+    if(recording)
+      record_flight_message(
+        category,
+        context,
+        fields,
+        fields_length,
+        format,
+        args
+      );
+    return;
+  }
+
+  // Dump the flight recorder before the error, so the log file reads in the
+  // order the messages were logged:
+  if(dumping)
+    write_flight_records();
+
+  // Hand the message over to the async writer thread if it is enabled. The
+  // flight recorder copies the text formatted into the ring buffer's slot:
+  if(atomic_load_explicit(&async_logging_enabled, memory_order_acquire)) {
+    enqueue_async_record(
+      category,
+      context,
+      fields,
+      fields_length,
+      format,
+      args
+    );
+    return;
+  }
+
+  // Format the message contents once, for every output, in the thread's
+  // scratch body unless it holds a message this one is nested in:
+  body = acquire_scratch_body();
+
+  if(body == NULL) {
+    text_buffer_init(&nested_body, body_storage, sizeof(body_storage));
+    body = &nested_body;
+  }
+
+  text_buffer_append_formatted(body, format, args);
+
+  record.category = category;
+  clock_gettime(CLOCK_REALTIME, &record.timestamp);
+  record.context = context;
+  record.context_length = context != NULL ? strlen(context) : 0;
+  record.body = body->data;
+  record.body_length = body->length;
+  record.fields = fields;
+  record.fields_length = fields_length;
+
+  // Keep the formatted message in the flight recorder:
+  if(recording)
+    record_flight_record(
+      &record,
+      atomic_load_explicit(&log_file, memory_order_relaxed) != NULL ||
+      atomic_load_explicit(&mapped_log_file, memory_order_relaxed) != NULL
+    );
+
+  // Buffer the message in the current thread if thread buffering is enabled.
+  // Log sinks are not buffered:
+  if(
+    atomic_load_explicit(&thread_buffering_enabled, memory_order_acquire) &&
+    buffer_thread_record(&record, console) == 0
+  ) {
+
+    if(atomic_load_explicit(&num_of_log_sinks, memory_order_relaxed) > 0) {
+      lock_logger();
+      write_log_sinks(&record, NULL, NULL);
+      unlock_logger();
+    }
+
+    release_scratch_body(body);
+    return;
+
+  }
+
+  text_buffer_init(&console_line, console_storage, sizeof(console_storage));
+  text_buffer_init(&file_line, file_storage, sizeof(file_storage));
+
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
+
+  // Print the whole message at once:
+  if(console) {
+    render_console_record(&console_line, &record, colors_enabled());
+    fwrite(console_line.data, 1, console_line.length, stdout);
+  }
+
+  // If a log file exists, write the whole message to it at once:
+  file_format = atomic_load_explicit(&log_file_format, memory_order_relaxed);
+
+  if(log_file != NULL || mapped_log_file != NULL)
+    render_log_file_line(&file_line, &record, file_format);
+
+  if(log_file != NULL)
+    write_log_file(file_line.data, file_line.length, record.timestamp.tv_sec);
+
+  // Force error messages to disk if the durability policy says so:
+  if(category == ERROR_MSG && log_durability_policy.sync_errors)
+    sync_log_file();
+
+  // Write the message to the log sinks, reusing the lines rendered above.
+  // Sinks always write text lines:
+  if(num_of_log_sinks > 0)
+    write_log_sinks(
+      &record,
+      console ? &console_line : NULL,
+      (log_file != NULL || mapped_log_file != NULL) &&
+      file_format == TEXT_LOG_FILE ? &file_line : NULL
+    );
+
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
+
+  // Memory mapped log files are written to concurrently, without the lock:
+  if(mapped_log_file != NULL)
+    write_mapped_log_file(file_line.data, file_line.length);
+
+  // Free allocated resources:
+  release_scratch_body(body);
+  text_buffer_release(&console_line);
+  text_buffer_release(&file_line);
+
+}
+
+static void log_structured_message(
+  MessageCategory category,
+  const char* context,
+  const LogField* fields,
+  size_t num_of_fields,
+  const char* format,
+  va_list args
+) {
+
+  char fields_storage[LINE_STORAGE_SIZE];
+  TextBuffer fields_text;
+
+  // Encode the fields once for every output:
+  text_buffer_init(&fields_text, fields_storage, sizeof(fields_storage));
+
+  if(num_of_fields > 0)
+    render_log_fields(&fields_text, fields, num_of_fields);
+
+  log_category_message(
+    category,
+    context,
+    fields_text.length > 0 ? fields_text.data : NULL,
+    fields_text.length,
+    format,
+    args
+  );
+
+  // Free allocated resources:
+  text_buffer_release(&fields_text);
+
+}
+
+static void* log_sync_routine(void* args) {
+
+  int descriptor;
+  struct timespec deadline;
+
+  pthread_mutex_lock(&log_sync_mutex);
+
+  while(atomic_load(&log_sync_running)) {
+
+    // Wait for the sync interval to elapse or for a sync to be requested:
+    if(!log_sync_requested && log_durability_policy.sync_interval > 0) {
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += log_durability_policy.sync_interval / 1000;
+      deadline.tv_nsec +=
+        (long) (log_durability_policy.sync_interval % 1000) * 1000000;
+
+      if(deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+      }
+
+      pthread_cond_timedwait(&log_sync_condition, &log_sync_mutex, &deadline);
+    }
+
+    else if(!log_sync_requested)
+      pthread_cond_wait(&log_sync_condition, &log_sync_mutex);
+
+    if(!atomic_load(&log_sync_running))
+      break;
+
+    log_sync_requested = 0;
+    pthread_mutex_unlock(&log_sync_mutex);
+
+    // Only flush the log file with the lock held, syncing a duplicate of it's
+    // descriptor afterwards:
+    descriptor = -1;
+    lock_logger();
+
+    if(log_file != NULL && log_file_unsynced_size > 0) {
+      flush_file_buffer(&log_file_buffer, log_file);
+      descriptor = dup(fileno(log_file));
+      log_file_unsynced_size = 0;
+    }
+
+    unlock_logger();
+
+    if(descriptor >= 0) {
+      fdatasync(descriptor);
+      close(descriptor);
+    }
+
+    pthread_mutex_lock(&log_sync_mutex);
+
+  }
+
+  pthread_mutex_unlock(&log_sync_mutex);
+
+  return NULL;
+
+}
+
+static size_t parse_format_conversion(
+  const char* text,
+  FormatConversion* conversion
+) {
+
+  size_t length = 1;
+
+  conversion->type = UNSUPPORTED_ARGUMENT;
+  conversion->star_width = 0;
+  conversion->star_precision = 0;
+  conversion->precision = -1;
+
+  if(text[length] == '%') {
+    conversion->type = NO_ARGUMENT;
+    return length + 1;
+  }
+
+  // Flags:
+  while(text[length] != '\0' && strchr("-+ #0'", text[length]) != NULL)
+    length++;
+
+  // Width:
+  if(text[length] == '*') {
+    conversion->star_width = 1;
+    length++;
+  }
+
+  else
+    while(text[length] >= '0' && text[length] <= '9')
+      length++;
+
+  // Positional arguments can't be read in order:
+  if(text[length] == '$')
+    return length + 1;
+
+  // Precision:
+  if(text[length] == '.') {
+
+    length++;
+
+    if(text[length] == '*') {
+      conversion->star_precision = 1;
+      length++;
+    }
+
+    else {
+      conversion->precision = 0;
+
+      while(text[length] >= '0' && text[length] <= '9') {
+        conversion->precision = 10 * conversion->precision + text[length] - '0';
+        length++;
+      }
+    }
+
+  }
+
+  // Length modifier and conversion character:
+  switch(text[length]) {
+
+    case 'h':
+      length += text[length+1] == 'h' ? 2 : 1;
+      conversion->type = INT_ARGUMENT;
+      break;
+
+    case 'l':
+      if(text[length+1] == 'l') {
+        length += 2;
+        conversion->type = LONG_LONG_ARGUMENT;
+      }
+
+      else {
+        length++;
+        conversion->type = LONG_ARGUMENT;
+      }
+
+      break;
+
+    case 'q':
+      length++;
+      conversion->type = LONG_LONG_ARGUMENT;
+      break;
+
+    case 'j':
+      length++;
+      conversion->type = INTMAX_ARGUMENT;
+      break;
+
+    case 'z':
+      length++;
+      conversion->type = SIZE_ARGUMENT;
+      break;
+
+    case 't':
+      length++;
+      conversion->type = PTRDIFF_ARGUMENT;
+      break;
+
+    case 'L':
+      length++;
+      conversion->type = LONG_DOUBLE_ARGUMENT;
+      break;
+
+    default:
+      conversion->type = NO_ARGUMENT;
+      break;
+
+  }
+
+  if(text[length] == '\0') {
+    conversion->type = UNSUPPORTED_ARGUMENT;
+    return length;
+  }
+
+  switch(text[length]) {
+
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      if(conversion->type == NO_ARGUMENT)
+        conversion->type = INT_ARGUMENT;
+
+      else if(conversion->type == LONG_DOUBLE_ARGUMENT)
+        conversion->type = LONG_LONG_ARGUMENT;
+
+      break;
+
+    case 'c':
+      conversion->type = conversion->type == NO_ARGUMENT ?
+        INT_ARGUMENT :
+        UNSUPPORTED_ARGUMENT;
+      break;
+
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+      if(conversion->type == NO_ARGUMENT || conversion->type == LONG_ARGUMENT)
+        conversion->type = DOUBLE_ARGUMENT;
+
+      else if(conversion->type != LONG_DOUBLE_ARGUMENT)
+        conversion->type = UNSUPPORTED_ARGUMENT;
+
+      break;
+
+    case 's':
+      conversion->type = conversion->type == NO_ARGUMENT ?
+        STRING_ARGUMENT :
+        UNSUPPORTED_ARGUMENT;
+      break;
+
+    case 'p':
+      conversion->type = conversion->type == NO_ARGUMENT ?
+        POINTER_ARGUMENT :
+        UNSUPPORTED_ARGUMENT;
+      break;
+
+    default:
+      conversion->type = UNSUPPORTED_ARGUMENT;
+      break;
+
+  }
+
+  length++;
+
+  if(length > MAX_CONVERSION_LENGTH)
+    conversion->type = UNSUPPORTED_ARGUMENT;
+
+  return length;
+
+}
+
+static void lock_logger() {
+
+  if(!logger_lock_held && logger_lock_needed()) {
+    pthread_mutex_lock(&logger_mutex);
+    logger_lock_held = 1;
+  }
+
+  logger_lock_depth++;
+
+}
+
+static int logger_lock_needed() {
+
+#ifdef LOGGER_DETECTS_THREADS
+  if(!__libc_single_threaded)
+    return 1;
+#endif
+
+  return atomic_load_explicit(
+    &logger_thread_safety_enabled,
+    memory_order_relaxed
+  );
+
+}
+
+static void prune_timestamped_archives(
+  const char* file_name,
+  unsigned int max_archives
+) {
+
+  char pattern[2 * PATH_MAX + 64];
+  glob_t archives;
+  size_t i, length = 0;
+
+  // Escape any wildcard characters in the log file's name:
+  for(i = 0; file_name[i] != '\0'; i++) {
+    if(strchr("*?[\\", file_name[i]) != NULL)
+      pattern[length++] = '\\';
+    pattern[length++] = file_name[i];
+  }
+
+  strcpy(
+    pattern + length,
+    ".[0-9][0-9][0-9][0-9][0-9][0-9][0-9][0-9]-[0-9][0-9][0-9][0-9][0-9][0-9]*"
+  );
+
+  // The archives are listed in alphabetical, and thus chronological, order:
+  if(glob(pattern, 0, NULL, &archives) != 0)
+    return;
+
+  for(i = 0; i + max_archives < archives.gl_pathc; i++)
+    remove(archives.gl_pathv[i]);
+
+  globfree(&archives);
+
+}
+
+static void publish_configuration(LoggerConfiguration* configuration) {
+
+  ConfigurationReader *reader;
+  LoggerConfiguration *replaced, **retired;
+
+  // The exchange is sequentially consistent, like the readers' stores, so a
+  // reader that loaded the replaced snapshot is found below:
+  replaced = (LoggerConfiguration*) atomic_exchange(
+    &logger_configuration,
+    configuration
+  );
+
+  // Readers may still use the replaced snapshot. The default snapshot is
+  // never freed:
+  if(replaced != &logger_default_configuration) {
+    replaced->retired_next = logger_retired_configurations;
+    logger_retired_configurations = replaced;
+  }
+
+  // Free the replaced snapshots no reader holds anymore:
+  retired = &logger_retired_configurations;
+
+  while(*retired != NULL) {
+
+    for(
+      reader = atomic_load(&configuration_readers);
+      reader != NULL && atomic_load(&reader->snapshot) != *retired;
+      reader = reader->next
+    );
+
+    if(reader == NULL) {
+      replaced = *retired;
+      *retired = replaced->retired_next;
+      free(replaced);
+    }
+
+    else
+      retired = &(*retired)->retired_next;
+
+  }
+
+  pthread_mutex_unlock(&logger_configuration_mutex);
+
+}
+
+static void publish_default_configuration() {
+  render_display_prefixes(&logger_default_configuration);
+  atomic_store_explicit(
+    &logger_configuration,
+    &logger_default_configuration,
+    memory_order_release
+  );
+}
+
+static void queue_log_archive(LogArchiveJob* job) {
+
+  job->next = NULL;
+
+  pthread_mutex_lock(&log_archive_mutex);
+
+  if(log_archive_queue_tail != NULL)
+    log_archive_queue_tail->next = job;
+
+  else
+    log_archive_queue = job;
+
+  log_archive_queue_tail = job;
+
+  if(!log_archive_running) {
+
+    log_archive_running = 1;
+
+    if(
+      pthread_create(&log_archive_thread, NULL, log_archive_routine, NULL) != 0
+    ) {
+      // Without the thread, the queue only holds this job:
+      log_archive_running = 0;
+      log_archive_queue = NULL;
+      log_archive_queue_tail = NULL;
+      pthread_mutex_unlock(&log_archive_mutex);
+      archive_log_file(job);
+      return;
+    }
+
+  }
+
+  pthread_cond_signal(&log_archive_condition);
+  pthread_mutex_unlock(&log_archive_mutex);
+
+}
+
+static int read_binary_log(FILE* file, void* data, size_t length) {
+  return fread(data, 1, length, file) == length ? 0 : -1;
+}
+
+static int read_binary_text(FILE* file, TextBuffer* buffer, uint32_t length) {
+
+  if(text_buffer_reserve(buffer, length) != 0)
+    return -1;
+
+  if(read_binary_log(file, buffer->data + buffer->length, length) != 0)
+    return -1;
+
+  buffer->length += length;
+  buffer->data[buffer->length] = '\0';
+
+  return 0;
+
+}
+
+static int read_flight_record(
+  const FlightRecorder* recorder,
+  size_t position,
+  FlightRecord* copy
+) {
+
+  const FlightRecord *record =
+    &recorder->records[position & flight_recorder_mask];
+  size_t sequence = atomic_load_explicit(
+    &record->sequence,
+    memory_order_acquire
+  );
+
+  if(sequence != position + 1)
+    return -1;
+
+  copy->category = record->category;
+  copy->timestamp = record->timestamp;
+  copy->has_context = record->has_context;
+  copy->logged = record->logged;
+  copy->context_length = record->context_length;
+  copy->fields_length = record->fields_length;
+  copy->body_length = record->body_length;
+  memcpy(copy->contents, record->contents, FLIGHT_RECORD_SIZE);
+
+  // Discard the copy if the record's thread overwrote it meanwhile:
+  atomic_thread_fence(memory_order_acquire);
+
+  if(atomic_load_explicit(&record->sequence, memory_order_relaxed) != sequence)
+    return -1;
+
+  return 0;
+
+}
+
+static void record_flight_message(
+  MessageCategory category,
+  const char* context,
+  const char* fields,
+  size_t fields_length,
+  const char* format,
+  va_list args
+) {
+
+  FlightRecord *flight_record;
+  FlightRecorder *recorder = claim_flight_recorder();
+
+  if(recorder == NULL)
+    return;
+
+  // Format the message straight into the oldest record:
+  flight_record = begin_flight_record(recorder);
+  flight_record->category = category;
+  clock_gettime(CLOCK_REALTIME, &flight_record->timestamp);
+  flight_record->has_context = context != NULL;
+  flight_record->logged = 0;
+  flight_record->fields_length = fields_length;
+  flight_record->body_length = copy_record_contents(
+    flight_record->contents,
+    FLIGHT_RECORD_SIZE,
+    context,
+    fields,
+    format,
+    args,
+    &flight_record->context_length,
+    &flight_record->fields_length
+  );
+  end_flight_record(recorder, flight_record);
+
+}
+
+static void record_flight_record(const LogRecord* record, int logged) {
+
+  char *contents;
+  FlightRecord *flight_record;
+  FlightRecorder *recorder = claim_flight_recorder();
+  size_t available;
+
+  if(recorder == NULL)
+    return;
+
+  flight_record = begin_flight_record(recorder);
+  flight_record->category = record->category;
+  flight_record->timestamp = record->timestamp;
+  flight_record->has_context = record->context != NULL;
+  flight_record->logged = logged;
+  contents = flight_record->contents;
+
+  // Truncate the text like copy_record_contents() does:
+  flight_record->context_length =
+    record->context_length < FLIGHT_RECORD_SIZE / 2 ?
+    record->context_length : FLIGHT_RECORD_SIZE / 2;
+  available = FLIGHT_RECORD_SIZE - flight_record->context_length;
+
+  if(flight_record->context_length > 0)
+    memcpy(contents, record->context, flight_record->context_length);
+
+  contents += flight_record->context_length;
+  flight_record->fields_length =
+    record->fields != NULL && record->fields_length <= available / 2 ?
+    record->fields_length : 0;
+  available -= flight_record->fields_length;
+
+  if(flight_record->fields_length > 0)
+    memcpy(contents, record->fields, flight_record->fields_length);
+
+  contents += flight_record->fields_length;
+  flight_record->body_length =
+    record->body_length < available ? record->body_length : available - 1;
+  memcpy(contents, record->body, flight_record->body_length);
+
+  end_flight_record(recorder, flight_record);
+
+}
+
+static void register_file_buffers_flush() {
+  atexit(flush_file_buffers);
+}
+
+static void release_configuration() {
+
+  if(--thread_configuration_depth > 0)
+    return;
+
+  if(thread_configuration_reader != NULL)
+    atomic_store_explicit(
+      &thread_configuration_reader->snapshot,
+      NULL,
+      memory_order_release
+    );
+
+  else
+    pthread_mutex_unlock(&logger_configuration_mutex);
+
+  thread_configuration = NULL;
+
+}
+
+static void release_crash_lock(atomic_flag* lock) {
+  atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static void release_flight_recorder(void* recorder) {
+  atomic_store(&((FlightRecorder*) recorder)->claimed, 0);
+}
+
+static void release_scratch_body(TextBuffer* body) {
+
+  if(body != &thread_scratch_body) {
+    text_buffer_release(body);
+    return;
+  }
+
+  thread_scratch_body_in_use = 0;
+
+  if(!body->heap_allocated)
+    return;
+
+  // Keep the grown storage for the next message, making sure it is freed when
+  // the thread exits:
+  if(
+    body->capacity <= MAX_SCRATCH_BODY_SIZE &&
+    pthread_once(&scratch_body_key_once, create_scratch_body_key) == 0 &&
+    scratch_body_key_created &&
+    (
+      pthread_getspecific(scratch_body_key) == body ||
+      pthread_setspecific(scratch_body_key, body) == 0
+    )
+  )
+    return;
+
+  text_buffer_release(body);
+
+}
+
+static void release_thread_buffer(void* buffer) {
+
+  ThreadBuffer *thread_buffer = buffer;
+
+  // Remove the buffer from the list of thread buffers:
+  pthread_mutex_lock(&thread_buffers_mutex);
+  acquire_crash_lock(&thread_buffers_crash_lock);
+
+  if(thread_buffer->previous != NULL)
+    thread_buffer->previous->next = thread_buffer->next;
+
+  else
+    thread_buffers = thread_buffer->next;
+
+  if(thread_buffer->next != NULL)
+    thread_buffer->next->previous = thread_buffer->previous;
+
+  release_crash_lock(&thread_buffers_crash_lock);
+
+  pthread_mutex_lock(&thread_buffer->mutex);
+  acquire_crash_lock(&thread_buffer->crash_lock);
+  flush_thread_buffer(thread_buffer);
+  release_crash_lock(&thread_buffer->crash_lock);
+  pthread_mutex_unlock(&thread_buffer->mutex);
+
+  pthread_mutex_unlock(&thread_buffers_mutex);
+
+  // Free allocated resources:
+  pthread_mutex_destroy(&thread_buffer->mutex);
+  text_buffer_release(&thread_buffer->console);
+  text_buffer_release(&thread_buffer->file);
+  free(thread_buffer);
+
+}
+
+static void render_console_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  int colors
+) {
+
+  const char *tag = message_tags[record->category];
+  const DisplayPrefix *prefix;
+  const LoggerConfiguration *configuration = acquire_configuration();
+
+  // Render context:
+  if(record->context != NULL) {
+
+    if(colors) {
+      prefix = &configuration->tag_prefixes[CONTEXT_TAG];
+      text_buffer_append(buffer, prefix->text, prefix->length);
+    }
+
+    text_buffer_append(buffer, record->context, record->context_length);
+    text_buffer_append(buffer, ": ", 2);
+
+  }
+
+  // Render tags:
+  if(tag != NULL) {
+
+    if(colors) {
+      prefix = &configuration->tag_prefixes[
+        message_tag_categories[record->category]
+      ];
+      text_buffer_append(buffer, prefix->text, prefix->length);
+    }
+
+    text_buffer_append_string(buffer, tag);
+    text_buffer_append(buffer, " ", 1);
+
+  }
+
+  // Render message contents:
+  if(colors) {
+    prefix = &configuration->msg_prefixes[record->category];
+    text_buffer_append(buffer, prefix->text, prefix->length);
+  }
+
+  render_record_body(buffer, record);
+
+  // Reset display colors:
+  if(colors) {
+    text_buffer_append(
+      buffer,
+      reset_attributes_escape.text,
+      reset_attributes_escape.length
+    );
+    text_buffer_append(
+      buffer,
+      clear_line_escape.text,
+      clear_line_escape.length
+    );
+  }
+
+  release_configuration();
+
+}
+
+static size_t render_crash_json_string(
+  char* destination,
+  const char* text,
+  size_t text_length
+) {
+
+  const char hex_digits[] = "0123456789abcdef";
+  size_t i, length = 0;
+  unsigned char character;
+
+  destination[length++] = '"';
+
+  for(i = 0; i < text_length; i++) {
+
+    character = text[i];
+
+    if(character >= 0x20 && character != '"' && character != '\\') {
+      destination[length++] = character;
+      continue;
+    }
+
+    destination[length++] = '\\';
+
+    switch(character) {
+
+      case '"':
+      case '\\':
+        destination[length++] = character;
+        break;
+
+      case '\n':
+        destination[length++] = 'n';
+        break;
+
+      case '\r':
+        destination[length++] = 'r';
+        break;
+
+      case '\t':
+        destination[length++] = 't';
+        break;
+
+      default:
+        memcpy(destination + length, "u00", 3);
+        length += 3;
+        destination[length++] = hex_digits[character >> 4];
+        destination[length++] = hex_digits[character & 0xF];
+        break;
+
+    }
+
+  }
+
+  destination[length++] = '"';
+
+  return length;
+
+}
+
+static void render_display_prefixes(LoggerConfiguration* configuration) {
+
+  const DisplayColors *display_colors;
+  DisplayPrefix *prefix;
+  int i;
+
+  for(i = 0; i < NUM_OF_MESSAGE_CATEGORIES + NUM_OF_TAG_CATEGORIES; i++) {
+
+    if(i < NUM_OF_MESSAGE_CATEGORIES) {
+      display_colors = &configuration->color_pallet.message_colors[i];
+      prefix = &configuration->msg_prefixes[i];
+    }
+
+    else {
+      display_colors = &configuration->color_pallet.tag_colors[
+        i - NUM_OF_MESSAGE_CATEGORIES
+      ];
+      prefix = &configuration->tag_prefixes[i - NUM_OF_MESSAGE_CATEGORIES];
+    }
+
+    // Same escape codes as color_text() followed by color_background():
+    prefix->length = 0;
+    memcpy(
+      prefix->text,
+      text_color_escapes[display_colors->text_color].text,
+      text_color_escapes[display_colors->text_color].length
+    );
+    prefix->length += text_color_escapes[display_colors->text_color].length;
+    memcpy(
+      prefix->text + prefix->length,
+      background_color_escapes[display_colors->background_color].text,
+      background_color_escapes[display_colors->background_color].length
+    );
+    prefix->length +=
+      background_color_escapes[display_colors->background_color].length;
+    memcpy(
+      prefix->text + prefix->length,
+      clear_line_escape.text,
+      clear_line_escape.length
+    );
+    prefix->length += clear_line_escape.length;
+
+  }
+
+}
+
+static void render_file_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  const TimeFormat* time_format
+) {
+
+  const char *tag = message_tags[record->category], *timestamp;
+  size_t timestamp_length;
+
+  // Render the timestamp according to the format specified by the user:
+  timestamp = get_cached_timestamp(
+    &record->timestamp,
+    time_format,
+    &timestamp_length
+  );
+  text_buffer_append(buffer, "[", 1);
+  text_buffer_append(buffer, timestamp, timestamp_length);
+  text_buffer_append(buffer, "] ", 2);
+
+  // Render the message context:
+  if(record->context != NULL) {
+    text_buffer_append(buffer, record->context, record->context_length);
+    text_buffer_append(buffer, ": ", 2);
+  }
+
+  // Render the message type:
+  if(tag != NULL) {
+    text_buffer_append_string(buffer, tag);
+    text_buffer_append(buffer, " ", 1);
+  }
+
+  render_record_body(buffer, record);
+
+}
+
+static void render_json_record(TextBuffer* buffer, const LogRecord* record) {
+
+  char digits[9];
+  int i;
+  long nanoseconds = record->timestamp.tv_nsec;
+  size_t body_length = record->body_length;
+
+  // Render the timestamp as seconds since the epoch, with nanosecond digits:
+  text_buffer_append(buffer, "{\"timestamp\":", 13);
+
+  if(record->timestamp.tv_sec < 0) {
+    text_buffer_append(buffer, "-", 1);
+    text_buffer_append_decimal(
+      buffer,
+      -(unsigned long long) record->timestamp.tv_sec
+    );
+  }
+
+  else
+    text_buffer_append_decimal(buffer, record->timestamp.tv_sec);
+
+  for(i = 8; i >= 0; i--) {
+    digits[i] = '0' + nanoseconds % 10;
+    nanoseconds /= 10;
+  }
+
+  text_buffer_append(buffer, ".", 1);
+  text_buffer_append(buffer, digits, sizeof(digits));
+
+  text_buffer_append(buffer, ",\"category\":\"", 13);
+  text_buffer_append_string(buffer, message_category_names[record->category]);
+
+  // Render the message context:
+  text_buffer_append(buffer, "\",\"context\":", 12);
+
+  if(record->context != NULL)
+    text_buffer_append_json_string(
+      buffer,
+      record->context,
+      record->context_length
+    );
+
+  else
+    text_buffer_append(buffer, "null", 4);
+
+  // Render the message contents, without the newline that ends them:
+  if(body_length > 0 && record->body[body_length - 1] == '\n')
+    body_length--;
+
+  text_buffer_append(buffer, ",\"message\":", 11);
+  text_buffer_append_json_string(buffer, record->body, body_length);
+
+  // Render the message fields:
+  text_buffer_append(buffer, ",\"fields\":", 10);
+
+  if(record->fields_length > 0)
+    text_buffer_append(buffer, record->fields, record->fields_length);
+
+  else
+    text_buffer_append(buffer, "{}", 2);
+
+  text_buffer_append(buffer, "}\n", 2);
+
+}
+
+static void render_log_fields(
+  TextBuffer* buffer,
+  const LogField* fields,
+  size_t num_of_fields
+) {
+
+  char number[32];
+  const LogField *field;
+  int length;
+  size_t i;
+
+  text_buffer_append(buffer, "{", 1);
+
+  for(i = 0; i < num_of_fields; i++) {
+
+    field = &fields[i];
+
+    if(i > 0)
+      text_buffer_append(buffer, ",", 1);
+
+    if(field->key != NULL)
+      text_buffer_append_json_string(buffer, field->key, strlen(field->key));
+
+    else
+      text_buffer_append(buffer, "\"\"", 2);
+
+    text_buffer_append(buffer, ":", 1);
+
+    switch(field->type) {
 
-//! \fn static void log_timestamp(FILE* log_file, TimeFormat* time_format)
-//! \brief Writes a timestamp to a log file with a certain format. Log file
-//! pointer must NOT be NULL.
-//! \param log_file File where timestamp will be logged. Must NOT be NULL.
-//! \param time_format Time format used to generate timestamp.
-//!
-//! This function writes a timestamp to a log file. The time_format argument
-//! determines the formatting and contents of the timestamp. This function is
-//! generally called by functions that write message's contents to a log file
-//! (e.g: the \link log_message() log_message \endlink function) to register
-//! the time in which the message was generated by the Message Logger module.
-//!
-//! \warning This functions does not check if the file pointer is valid! Do NOT
-//! call this function with a NULL file pointer.
-//!
-//! \par Usage example
-//! \code
-//! FILE *log_file;
-//! TimeFormat time_format = {
-//!   .string_representation = "%H:%M:%S"
-//! };
-//!
-//! int main() {
-//!   log_file = fopen("test-logfile.log", "w");
-//!   log_timestamp(log_file, &time_format);
-//!   fprintf(log_file, "This message is being logged and timestamped!\n");
-//!   fclose(log_file);
-//!   return 0;
-//! }
-//! \endcode
-static void log_timestamp(FILE* log_file, TimeFormat* time_format);
+      case BOOL_FIELD:
+        if(field->bool_value)
+          text_buffer_append(buffer, "true", 4);
 
-//! \fn static void print_context(const char *context)
-//! \brief Prints a message's caller context in tag format.
-//! \param context Text containing the message's caller context.
-//!
-//! This function writes the context tag of a message to the terminal. The
-//! colors used for the context tag are taken from the \link
-//! #logger_color_pallet Message Logger's color pallet. \endlink
-//!
-//! \par Usage example
-//! \code
-//! print_context("Main function");
-//! printf("This message came from the main function!\n");
-//! \endcode
-static void print_context(const char *context);
+        else
+          text_buffer_append(buffer, "false", 5);
 
-//! \fn static void print_formatted_text(
-//!   const char* text_format,
-//!   va_list text_args
-//! )
-//! \brief Prints a formatted text after argument substitution.
-//! \param text_format String formatting for the text's contents before
-//! argument substitution takes place.
-//! \param text_args Arguments used to substitute placeholders in the text's
-//! contents.
-//!
-//! This function writes a formatted text to the terminal, utilizing the
-//! arguments provided to substitute any placeholders in the text's initial
-//! format.
-//!
-//! \note The va_list provided as an argument for this function is NOT rendered
-//! unusable by this function! A local copy of the va_list argument is made,
-//! allowing other functions to reuse it. However, this implies that the memory
-//! cleaning for the va_list achieved with va_end() is a task that this
-//! function does NOT handle!
-//!
-//! \par Usage example
-//! \code
-//! void question(const char* text_format, ...) {
-//!   va_list text_args;
-//!   va_start(text_args, text_format);
-//!   print_formatted_text(text_format, text_args);
-//!   va_end(text_args);
-//! }
-//!
-//! int main() {
-//!   int num = 3;
-//!   question("Number %d: What is the mitochondria?", int);
-//!   return 0;
-//! }
-//! \endcode
-static void print_formatted_text(const char* text_format, va_list text_args);
+        break;
 
-// Public function implementations:
-int configure_log_file(const char *file_name, LogFileMode file_mode) {
+      case DOUBLE_FIELD:
+        // JSON has no representation for infinities and NaN:
+        if(!isfinite(field->double_value)) {
+          text_buffer_append(buffer, "null", 4);
+          break;
+        }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+        // Use the shortest precision that reads back as the same value:
+        length = snprintf(number, sizeof(number), "%.15g", field->double_value);
 
-  // If there was a previous log file, we need to close it:
-  if(log_file != NULL) {
-    fclose(log_file);
-    log_file = NULL;
-  }
+        if(strtod(number, NULL) != field->double_value)
+          length =
+            snprintf(number, sizeof(number), "%.17g", field->double_value);
 
-  // Open the log file and store it's pointer for future use:
-  switch (file_mode) {
+        text_buffer_append(buffer, number, length);
+        break;
 
-    case APPEND:
-      log_file = fopen(file_name, "a");
+      case INT_FIELD:
+        if(field->int_value < 0) {
+          text_buffer_append(buffer, "-", 1);
+          text_buffer_append_decimal(
+            buffer,
+            -(unsigned long long) field->int_value
+          );
+        }
 
-      if(log_file == NULL) {
-        warning(
-          "Logger module",
-          "Could not find log file! Defaulting to write mode!\n"
-        );
-        log_file = fopen(file_name, "w");
-      }
+        else
+          text_buffer_append_decimal(buffer, field->int_value);
 
-      break;
+        break;
 
-    case WRITE:
-      log_file = fopen(file_name, "w");
-      break;
+      case STRING_FIELD:
+        if(field->string_value != NULL)
+          text_buffer_append_json_string(
+            buffer,
+            field->string_value,
+            strlen(field->string_value)
+          );
+
+        else
+          text_buffer_append(buffer, "null", 4);
+
+        break;
+
+      case UINT_FIELD:
+        text_buffer_append_decimal(buffer, field->uint_value);
+        break;
+
+      default:
+        text_buffer_append(buffer, "null", 4);
+        break;
+
+    }
 
   }
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  text_buffer_append(buffer, "}", 1);
 
-  if(log_file == NULL) {
-    error(
-      "Logger module",
-      "Could not create log file! Please check your system.\n"
-    );
-    return -1;
+}
+
+static void render_log_file_line(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  LogFileFormat file_format
+) {
+  if(file_format == JSON_LOG_FILE)
+    render_json_record(buffer, record);
+
+  else {
+    render_file_record(buffer, record, &acquire_configuration()->time_format);
+    release_configuration();
   }
+}
 
-  return 0;
+static void render_record_body(TextBuffer* buffer, const LogRecord* record) {
+
+  size_t body_length = record->body_length;
+
+  if(record->fields_length == 0) {
+    text_buffer_append(buffer, record->body, body_length);
+    return;
+  }
+
+  // Render the fields before the newline that ends the contents:
+  if(body_length > 0 && record->body[body_length - 1] == '\n')
+    body_length--;
+
+  text_buffer_append(buffer, record->body, body_length);
+
+  if(body_length > 0)
+    text_buffer_append(buffer, " ", 1);
+
+  text_buffer_append(buffer, record->fields, record->fields_length);
+
+  if(body_length < record->body_length)
+    text_buffer_append(buffer, "\n", 1);
 
 }
 
-int enable_thread_safety() {
+static void render_sink_record(
+  TextBuffer* buffer,
+  const LogRecord* record,
+  const LogSink* sink
+) {
 
-  pthread_mutexattr_t logger_mutex_attributes;
+  const char *timestamp;
+  const TimeFormat *time_format = NULL;
+  size_t timestamp_length;
 
-  // Allocate recursive mutex:
-  logger_recursive_mutex = malloc(sizeof(pthread_mutex_t));
+  // The snapshot is held until the record is rendered:
+  if(sink->timestamp == LOGGER_TIMESTAMP)
+    time_format = &acquire_configuration()->time_format;
 
-  if(logger_recursive_mutex == NULL) {
-    error(
-      "Logger module",
-      "Could not allocate memory for mutex lock! Please check your system."
+  else if(sink->timestamp == CUSTOM_TIMESTAMP)
+    time_format = &sink->time_format;
+
+  // Render the timestamp like in a log file:
+  if(time_format != NULL) {
+    timestamp = get_cached_timestamp(
+      &record->timestamp,
+      time_format,
+      &timestamp_length
     );
-    return -1;
+    text_buffer_append(buffer, "[", 1);
+    text_buffer_append(buffer, timestamp, timestamp_length);
+    text_buffer_append(buffer, "] ", 2);
   }
 
-  // Initialize recursive mutex:
-  pthread_mutexattr_init(&logger_mutex_attributes);
-  pthread_mutexattr_settype(&logger_mutex_attributes, PTHREAD_MUTEX_RECURSIVE);
-  pthread_mutex_init(logger_recursive_mutex, &logger_mutex_attributes);
-  pthread_mutexattr_destroy(&logger_mutex_attributes);
+  render_console_record(buffer, record, sink->colors);
 
-  return 0;
+  if(sink->timestamp == LOGGER_TIMESTAMP)
+    release_configuration();
 
 }
 
-int get_logger_msg_colors(
-  DisplayColors* display_colors_destination,
-  MessageCategory requested_category
-) {
+static void rotate_log_file(time_t now) {
 
-  if(display_colors_destination == NULL) {
+  FILE *rotated_log_file;
+  LogArchiveJob *job;
+  int length;
+
+  // Whatever happens, the rotation isn't retried before another condition of
+  // the rotation policy is met:
+  log_file_size = 0;
+  log_file_rotation_time = now + log_rotation_policy.rotation_interval;
+
+  job = malloc(sizeof(LogArchiveJob));
+
+  if(job == NULL) {
     error(
       "Logger module",
-      "Cannot store display color information in NULL pointer! "
-      "Please use a valid reference.\n"
+      "Could not allocate memory to rotate the log file! "
+      "Please check your system.\n"
     );
-    return -1;
+    return;
   }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
-
-  copy_display_colors(
-    display_colors_destination,
-    &logger_color_pallet.message_colors[requested_category]
+  length = snprintf(
+    job->staged_name,
+    sizeof(job->staged_name),
+    "%s.rotating-%lu",
+    log_file_name,
+    ++log_rotation_count
   );
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  if(length < 0 || (size_t) length >= sizeof(job->staged_name)) {
+    free(job);
+    error(
+      "Logger module",
+      "Could not rotate the log file, it's name is too long! "
+      "Please use a shorter log file name.\n"
+    );
+    return;
+  }
 
-  return 0;
+  // Only a rename and an open are done with the lock held, the rotated log
+  // file being closed and archived by the archive thread:
+  flush_file_buffer(&log_file_buffer, log_file);
 
-}
+  if(rename(log_file_name, job->staged_name) != 0) {
+    free(job);
+    error(
+      "Logger module",
+      "Could not rename the log file to rotate it! "
+      "Please check your system.\n"
+    );
+    return;
+  }
 
-int get_logger_tag_colors(
-  DisplayColors* display_colors_destination,
-  TagCategory requested_category
-) {
+  rotated_log_file = log_file;
+  log_file = fopen(log_file_name, "w");
 
-  if(display_colors_destination == NULL) {
+  job->file = rotated_log_file;
+  job->sync = atomic_load(&log_sync_running) && log_file_unsynced_size > 0;
+  job->time = now;
+  job->policy = log_rotation_policy;
+  strcpy(job->file_name, log_file_name);
+  log_file_unsynced_size = 0;
+
+  queue_log_archive(job);
+
+  if(log_file != NULL)
+    attach_file_buffer(&log_file_buffer, log_file);
+
+  else {
+    acquire_crash_lock(&log_file_buffer.crash_lock);
+    log_file_buffer.descriptor = -1;
+    release_crash_lock(&log_file_buffer.crash_lock);
     error(
       "Logger module",
-      "Cannot store display color information in NULL pointer! "
-      "Please use a valid reference.\n"
+      "Could not create a new log file after rotating it! "
+      "Please check your system.\n"
     );
-    return -1;
   }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+}
 
-  copy_display_colors(
-    display_colors_destination,
-    &logger_color_pallet.tag_colors[requested_category]
-  );
+static JsonEscapeScanner select_json_escape_scanner() {
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  JsonEscapeScanner scanner = find_json_escape_scalar;
 
-  return 0;
+#ifdef LOGGER_USES_X86_SIMD
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx2"))
+    scanner = find_json_escape_avx2;
+
+  else if(__builtin_cpu_supports("sse2"))
+    scanner = find_json_escape_sse2;
+#endif
+
+  atomic_store_explicit(&json_escape_scanner, scanner, memory_order_relaxed);
+
+  return scanner;
 
 }
 
-int get_time_format(TimeFormat *time_format_destination) {
+static void stop_log_archive_thread() {
 
-  if(time_format_destination == NULL) {
-    error(
-      "Logger module",
-      "Cannot store time format in NULL pointer! "
-      "Please use a valid reference.\n"
-    );
-    return -1;
+  pthread_mutex_lock(&log_archive_mutex);
+
+  if(!log_archive_running) {
+    pthread_mutex_unlock(&log_archive_mutex);
+    return;
   }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  log_archive_running = 0;
+  pthread_cond_signal(&log_archive_condition);
+  pthread_mutex_unlock(&log_archive_mutex);
 
-  // Copy logger time format to destination time format:
-  strncpy(
-    time_format_destination->string_representation,
-    logger_time_fmt.string_representation,
-    TIME_FMT_SIZE
-  );
+  pthread_join(log_archive_thread, NULL);
+
+}
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+static void stop_log_sync_thread() {
 
-  return 0;
+  if(!atomic_load(&log_sync_running))
+    return;
+
+  pthread_mutex_lock(&log_sync_mutex);
+  atomic_store(&log_sync_running, 0);
+  pthread_cond_signal(&log_sync_condition);
+  pthread_mutex_unlock(&log_sync_mutex);
+
+  pthread_join(log_sync_thread, NULL);
+  log_sync_requested = 0;
 
 }
 
-int set_logger_msg_colors(
-  MessageCategory message_category,
-  const DisplayColors *assigned_colors
+static void sync_log_file() {
+
+  if(log_file == NULL)
+    return;
+
+  flush_file_buffer(&log_file_buffer, log_file);
+  fdatasync(fileno(log_file));
+  log_file_unsynced_size = 0;
+
+}
+
+static void text_buffer_append(
+  TextBuffer* buffer,
+  const char* text,
+  size_t text_length
 ) {
 
-  if(assigned_colors == NULL) {
-    error(
-      "Logger module",
-      "Cannot assign display color information from NULL pointer! "
-      "Please use a valid reference.\n"
-    );
-    return -1;
-  }
+  // If the buffer can't grow, truncate the text to the available storage:
+  if(text_buffer_reserve(buffer, text_length) != 0)
+    text_length = buffer->capacity - buffer->length - 1;
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  memcpy(buffer->data + buffer->length, text, text_length);
+  buffer->length += text_length;
 
-  copy_display_colors(
-    &logger_color_pallet.message_colors[message_category],
-    assigned_colors
-  );
+}
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+static void text_buffer_append_decimal(
+  TextBuffer* buffer,
+  unsigned long long value
+) {
 
-  return 0;
+  char digits[20], *digits_end = digits + sizeof(digits), *first_digit;
+
+  first_digit = format_unsigned_digits(digits_end, value, 10, 0);
+  text_buffer_append(buffer, first_digit, digits_end - first_digit);
 
 }
 
-int set_logger_tag_colors(
-  TagCategory tag_category,
-  const DisplayColors *assigned_colors
+static void text_buffer_append_formatted(
+  TextBuffer* buffer,
+  const char* text_format,
+  va_list text_args
 ) {
 
-  if(assigned_colors == NULL) {
-    error(
-      "Logger module",
-      "Cannot assign display color information from NULL pointer! "
-      "Please use a valid reference.\n"
+  int text_length;
+  size_t available = buffer->capacity - buffer->length;
+  va_list text_args_copy;
+
+  // We need to copy the args va_list because format_message_text() makes the
+  // va_list unusable for future calls, like any v*printf().
+  va_copy(text_args_copy, text_args);
+  text_length = format_message_text(
+    buffer->data + buffer->length,
+    available,
+    text_format,
+    text_args_copy
+  );
+  va_end(text_args_copy);
+
+  if(text_length < 0)
+    return;
+
+  // If the text didn't fit, grow the buffer and format it again:
+  if((size_t) text_length >= available) {
+
+    if(text_buffer_reserve(buffer, text_length) != 0) {
+      buffer->length = buffer->capacity - 1;
+      return;
+    }
+
+    va_copy(text_args_copy, text_args);
+    format_message_text(
+      buffer->data + buffer->length,
+      text_length + 1,
+      text_format,
+      text_args_copy
     );
-    return -1;
+    va_end(text_args_copy);
+
   }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  buffer->length += text_length;
 
-  copy_display_colors(
-    &logger_color_pallet.tag_colors[tag_category],
-    assigned_colors
+}
+
+static void text_buffer_append_json_string(
+  TextBuffer* buffer,
+  const char* text,
+  size_t text_length
+) {
+
+  char escape[6] = "\\u00";
+  const char hex_digits[] = "0123456789abcdef";
+  JsonEscapeScanner scanner = atomic_load_explicit(
+    &json_escape_scanner,
+    memory_order_relaxed
   );
+  size_t i, run_start = 0;
+  unsigned char character;
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  if(scanner == NULL)
+    scanner = select_json_escape_scanner();
 
-  return 0;
+  text_buffer_append(buffer, "\"", 1);
 
-}
+  while(run_start < text_length) {
 
-int set_time_format(const char *new_format) {
+    // Append the run of chars that need no escaping at once:
+    i = run_start + scanner(text + run_start, text_length - run_start);
+    text_buffer_append(buffer, text + run_start, i - run_start);
 
-  if(new_format == NULL) {
-    error(
-      "Logger module",
-      "Cannot assign time format from a NULL pointer! "
-      "Please use a valid reference.\n"
-    );
-    return -1;
-  }
+    if(i == text_length)
+      break;
+
+    character = text[i];
+    run_start = i + 1;
+
+    switch(character) {
+
+      case '"':
+        text_buffer_append(buffer, "\\\"", 2);
+        break;
+
+      case '\\':
+        text_buffer_append(buffer, "\\\\", 2);
+        break;
+
+      case '\n':
+        text_buffer_append(buffer, "\\n", 2);
+        break;
+
+      case '\r':
+        text_buffer_append(buffer, "\\r", 2);
+        break;
+
+      case '\t':
+        text_buffer_append(buffer, "\\t", 2);
+        break;
+
+      default:
+        escape[4] = hex_digits[character >> 4];
+        escape[5] = hex_digits[character & 0xF];
+        text_buffer_append(buffer, escape, sizeof(escape));
+        break;
+
+    }
 
-  if(strlen(new_format) > TIME_FMT_SIZE) {
-    error(
-      "Logger module",
-      "Could not change time format! Try again with an argument of less "
-      "then %u characters.\n",
-      TIME_FMT_SIZE
-    );
-    return -1;
   }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  text_buffer_append(buffer, "\"", 1);
 
-  // Copy new time format to logger time format:
-  strncpy(logger_time_fmt.string_representation, new_format, TIME_FMT_SIZE);
+}
+
+static void text_buffer_append_printf(
+  TextBuffer* buffer,
+  const char* text_format,
+  ...
+) {
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  va_list text_args;
 
-  return 0;
+  va_start(text_args, text_format);
+  text_buffer_append_formatted(buffer, text_format, text_args);
+  va_end(text_args);
 
 }
 
-void color_background(Color p_color) {
+static void text_buffer_append_string(TextBuffer* buffer, const char* text) {
+  text_buffer_append(buffer, text, strlen(text));
+}
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+static void text_buffer_init(
+  TextBuffer* buffer,
+  char* storage,
+  size_t capacity
+) {
+  buffer->data = storage;
+  buffer->length = 0;
+  buffer->capacity = capacity;
+  buffer->heap_allocated = 0;
+}
 
-  switch(p_color) {
+static void text_buffer_release(TextBuffer* buffer) {
 
-    case BLA:
-      printf("\x1B[48;5;0m");
-      break;
+  if(buffer->heap_allocated)
+    free(buffer->data);
 
-    case RED:
-      printf("\x1B[48;5;1m");
-      break;
+  buffer->data = NULL;
+  buffer->length = 0;
+  buffer->capacity = 0;
+  buffer->heap_allocated = 0;
 
-    case GRN:
-      printf("\x1B[48;5;2m");
-      break;
+}
 
-    case YEL:
-      printf("\x1B[48;5;3m");
-      break;
+static int text_buffer_reserve(TextBuffer* buffer, size_t additional) {
 
-    case BLU:
-      printf("\x1B[48;5;4m");
-      break;
+  char *new_data;
+  size_t new_capacity, required = buffer->length + additional + 1;
 
-    case MAG:
-      printf("\x1B[48;5;5m");
-      break;
+  if(required <= buffer->capacity)
+    return 0;
 
-    case CYN:
-      printf("\x1B[48;5;6m");
-      break;
+  new_capacity = 2 * buffer->capacity;
 
-    case WHT:
-      printf("\x1B[48;5;7m");
-      break;
+  if(new_capacity < required)
+    new_capacity = required;
 
-    case B_BLA:
-      printf("\x1B[48;5;8m");
-      break;
+  // Move the text to the heap the first time the buffer grows:
+  if(buffer->heap_allocated)
+    new_data = realloc(buffer->data, new_capacity);
 
-    case B_RED:
-      printf("\x1B[48;5;9m");
-      break;
+  else {
+    new_data = malloc(new_capacity);
 
-    case B_GRN:
-      printf("\x1B[48;5;10m");
-      break;
+    if(new_data != NULL)
+      memcpy(new_data, buffer->data, buffer->length);
+  }
 
-    case B_YEL:
-      printf("\x1B[48;5;11m");
-      break;
+  if(new_data == NULL)
+    return -1;
 
-    case B_BLU:
-      printf("\x1B[48;5;12m");
-      break;
+  buffer->data = new_data;
+  buffer->capacity = new_capacity;
+  buffer->heap_allocated = 1;
 
-    case B_MAG:
-      printf("\x1B[48;5;13m");
-      break;
+  return 0;
 
-    case B_CYN:
-      printf("\x1B[48;5;14m");
-      break;
+}
 
-    case B_WHT:
-      printf("\x1B[48;5;15m");
-      break;
+static int try_crash_lock(atomic_flag* lock) {
 
-    case DFLT:
-      printf("\x1B[49m");
-      break;
+  int attempt;
+  struct timespec delay = { .tv_sec = 0, .tv_nsec = 1000000 };
 
-  }
+  for(attempt = 0; attempt < CRASH_LOCK_ATTEMPTS; attempt++) {
 
-  clear_line_text_background_past_cursor();
+    if(!atomic_flag_test_and_set_explicit(lock, memory_order_acquire))
+      return 0;
+
+    nanosleep(&delay, NULL);
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  }
+
+  return -1;
 
 }
 
-void color_text(Color p_color) {
+static void unlock_logger() {
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  if(logger_lock_depth == 0)
+    return;
 
-  switch(p_color) {
+  if(--logger_lock_depth == 0 && logger_lock_held) {
+    logger_lock_held = 0;
+    pthread_mutex_unlock(&logger_mutex);
+  }
 
-    case BLA:
-      printf("\x1B[22;38;5;0m");
-      break;
+}
 
-    case RED:
-      printf("\x1B[22;38;5;1m");
-      break;
+static void update_log_sink_variants() {
 
-    case GRN:
-      printf("\x1B[22;38;5;2m");
-      break;
+  int i, j;
+  LogSink *sink, *other;
 
-    case YEL:
-      printf("\x1B[22;38;5;3m");
-      break;
+  for(i = 0; i < MAX_LOG_SINKS; i++) {
 
-    case BLU:
-      printf("\x1B[22;38;5;4m");
-      break;
+    sink = &log_sinks[i];
+    sink->variant = i;
 
-    case MAG:
-      printf("\x1B[22;38;5;5m");
-      break;
+    for(j = 0; j < i && sink->variant == i; j++) {
 
-    case CYN:
-      printf("\x1B[22;38;5;6m");
-      break;
+      other = &log_sinks[j];
 
-    case WHT:
-      printf("\x1B[22;38;5;7m");
-      break;
+      if(
+        other->attached &&
+        other->callback == NULL &&
+        sink->callback == NULL &&
+        other->colors == sink->colors &&
+        other->timestamp == sink->timestamp &&
+        (
+          sink->timestamp != CUSTOM_TIMESTAMP ||
+          strcmp(
+            other->time_format.string_representation,
+            sink->time_format.string_representation
+          ) == 0
+        )
+      )
+        sink->variant = j;
 
-    case B_BLA:
-      printf("\x1B[1;38;5;8m");
-      break;
+    }
 
-    case B_RED:
-      printf("\x1B[1;38;5;9m");
-      break;
+  }
 
-    case B_GRN:
-      printf("\x1B[1;38;5;10m");
-      break;
+}
 
-    case B_YEL:
-      printf("\x1B[1;38;5;11m");
-      break;
+static void write_binary_record(
+  MessageCategory category,
+  const char* context,
+  const char* format,
+  va_list args
+) {
 
-    case B_BLU:
-      printf("\x1B[1;38;5;12m");
-      break;
+  char body_storage[LINE_STORAGE_SIZE], record_storage[LINE_STORAGE_SIZE];
+  const BinaryFormat *entry;
+  const FormatConversion *conversion;
+  const char *string, *time_format;
+  double double_value;
+  int i;
+  int32_t nanoseconds, star_value, precision;
+  int64_t integer_value, seconds;
+  long double long_double_value;
+  struct timespec timestamp;
+  TextBuffer body, record;
+  uint32_t length;
+  unsigned char kind, category_byte = category;
+  unsigned int generation;
+  va_list args_copy;
 
-    case B_MAG:
-      printf("\x1B[1;38;5;13m");
-      break;
+  clock_gettime(CLOCK_REALTIME, &timestamp);
+  seconds = timestamp.tv_sec;
+  nanoseconds = timestamp.tv_nsec;
 
-    case B_CYN:
-      printf("\x1B[1;38;5;14m");
-      break;
+  text_buffer_init(&record, record_storage, sizeof(record_storage));
 
-    case B_WHT:
-      printf("\x1B[1;38;5;15m");
-      break;
+  // Acquire logger lock if thread safety is enabled:
+  lock_logger();
 
-    case DFLT:
-      printf("\x1B[22;39m");
-      break;
+  if(binary_log_file == NULL) {
+
+    // Release logger lock if thread safety is enabled:
+    unlock_logger();
+
+    return;
 
   }
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  // Record the time format when it changes:
+  generation = atomic_load(&logger_time_fmt_generation);
+
+  if(binary_log_time_fmt_generation != (long) generation) {
+    kind = TIME_FORMAT_RECORD;
+    time_format = acquire_configuration()->time_format.string_representation;
+    length = strlen(time_format);
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      &kind,
+      sizeof(kind)
+    );
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      &length,
+      sizeof(length)
+    );
+    write_file_buffer(
+      &binary_log_file_buffer,
+      binary_log_file,
+      time_format,
+      length
+    );
+    release_configuration();
+    binary_log_time_fmt_generation = generation;
+  }
 
-}
+  entry = find_binary_format(format);
+  kind = entry != NULL && entry->num_of_conversions >= 0 ?
+    MESSAGE_RECORD :
+    TEXT_RECORD;
+
+  // Record the fields shared by every message:
+  text_buffer_append(&record, (const char*) &kind, sizeof(kind));
+  text_buffer_append(
+    &record,
+    (const char*) &category_byte,
+    sizeof(category_byte)
+  );
+  text_buffer_append(&record, (const char*) &seconds, sizeof(seconds));
+  text_buffer_append(&record, (const char*) &nanoseconds, sizeof(nanoseconds));
 
-void error(const char *context, const char *format, ...) {
+  length = context != NULL ? strlen(context) : UINT32_MAX;
+  text_buffer_append(&record, (const char*) &length, sizeof(length));
 
-  const char msg_type[8] = "(Error)";
-  va_list arg_list;
+  if(context != NULL)
+    text_buffer_append(&record, context, length);
 
-  // Start the argument list with any arguments after the format string:
-  va_start(arg_list, format);
+  // We need to copy the args va_list because reading it's arguments makes the
+  // va_list unusable for other functions.
+  va_copy(args_copy, args);
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  if(kind == MESSAGE_RECORD) {
 
-  // Print context:
-  if(context != NULL)
-    print_context(context);
+    text_buffer_append(&record, (const char*) &entry->id, sizeof(entry->id));
 
-  // Print tags:
-  color_text(logger_color_pallet.tag_colors[ERROR_TAG].text_color);
-  color_background(logger_color_pallet.tag_colors[ERROR_TAG].background_color);
-  printf("%s ", msg_type);
+    // Copy the raw bytes of each argument:
+    for(i = 0; i < entry->num_of_conversions; i++) {
 
-  // Print message contents:
-  color_text(logger_color_pallet.message_colors[ERROR_MSG].text_color);
-  color_background(
-    logger_color_pallet.message_colors[ERROR_MSG].background_color
-  );
-  print_formatted_text(format, arg_list);
+      conversion = &entry->conversions[i];
+      precision = conversion->precision;
 
-  // Reset display colors:
-  reset_colors();
+      if(conversion->star_width) {
+        star_value = va_arg(args_copy, int);
+        text_buffer_append(
+          &record,
+          (const char*) &star_value,
+          sizeof(star_value)
+        );
+      }
 
-  // If a log file exists, write the message contents to it:
-  if(log_file != NULL)
-    log_message(
-      log_file,
-      &logger_time_fmt,
-      context,
-      msg_type,
-      format,
-      arg_list
-    );
+      if(conversion->star_precision) {
+        star_value = va_arg(args_copy, int);
+        precision = star_value;
+        text_buffer_append(
+          &record,
+          (const char*) &star_value,
+          sizeof(star_value)
+        );
+      }
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+      switch(conversion->type) {
 
-  // Free allocated resources:
-  va_end(arg_list);
+        case INT_ARGUMENT:
+          integer_value = va_arg(args_copy, int);
+          break;
 
-}
+        case LONG_ARGUMENT:
+          integer_value = va_arg(args_copy, long);
+          break;
 
-void info(const char *context, const char *format, ...) {
+        case LONG_LONG_ARGUMENT:
+          integer_value = va_arg(args_copy, long long);
+          break;
 
-  const char msg_type[7] = "(Info)";
-  va_list arg_list;
+        case INTMAX_ARGUMENT:
+          integer_value = va_arg(args_copy, intmax_t);
+          break;
 
-  // Start the argument list with any arguments after the format string:
-  va_start(arg_list, format);
+        case SIZE_ARGUMENT:
+          integer_value = va_arg(args_copy, size_t);
+          break;
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+        case PTRDIFF_ARGUMENT:
+          integer_value = va_arg(args_copy, ptrdiff_t);
+          break;
 
-  // Print context:
-  if(context != NULL)
-    print_context(context);
+        case POINTER_ARGUMENT:
+          integer_value = (uintptr_t) va_arg(args_copy, void*);
+          break;
 
-  // Print tags:
-  color_text(logger_color_pallet.tag_colors[INFO_TAG].text_color);
-  color_background(logger_color_pallet.tag_colors[INFO_TAG].background_color);
-  printf("%s ", msg_type);
+        case DOUBLE_ARGUMENT:
+          double_value = va_arg(args_copy, double);
+          text_buffer_append(
+            &record,
+            (const char*) &double_value,
+            sizeof(double_value)
+          );
+          continue;
 
-  // Print message contents:
-  color_text(logger_color_pallet.message_colors[INFO_MSG].text_color);
-  color_background(
-    logger_color_pallet.message_colors[INFO_MSG].background_color
-  );
-  print_formatted_text(format, arg_list);
+        case LONG_DOUBLE_ARGUMENT:
+          long_double_value = va_arg(args_copy, long double);
+          text_buffer_append(
+            &record,
+            (const char*) &long_double_value,
+            sizeof(long_double_value)
+          );
+          continue;
 
-  // Reset display colors:
-  reset_colors();
+        case STRING_ARGUMENT:
 
-  // If a log file exists, write the message contents to it:
-  if(log_file != NULL)
-    log_message(
-      log_file,
-      &logger_time_fmt,
-      context,
-      msg_type,
-      format,
-      arg_list
-    );
+          // Strings are copied up to their precision, like printf reads them:
+          string = va_arg(args_copy, const char*);
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+          if(string == NULL)
+            length = UINT32_MAX;
 
-  // Free allocated resources:
-  va_end(arg_list);
+          else if(precision >= 0)
+            length = strnlen(string, precision);
 
-}
+          else
+            length = strlen(string);
 
-void lock_logger_recursive_mutex() {
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+          text_buffer_append(&record, (const char*) &length, sizeof(length));
 
-  else
-    warning(
-      "Logger module",
-      "Enable thread safety to access the logger recursive mutex."
-    );
-}
+          if(string != NULL)
+            text_buffer_append(&record, string, length);
 
-void logger_module_clean_up() {
+          continue;
+
+        default:
+          continue;
+
+      }
+
+      text_buffer_append(
+        &record,
+        (const char*) &integer_value,
+        sizeof(integer_value)
+      );
+
+    }
 
-  // Clean up the log file:
-  if(log_file != NULL) {
-    fclose(log_file);
-    log_file = NULL;
   }
 
-  // Clean up the recursive mutex:
-  if(logger_recursive_mutex != NULL) {
-    pthread_mutex_destroy(logger_recursive_mutex);
-    free(logger_recursive_mutex);
-    logger_recursive_mutex = NULL;
+  // Format messages that can't be recorded:
+  else {
+    text_buffer_init(&body, body_storage, sizeof(body_storage));
+    text_buffer_append_formatted(&body, format, args_copy);
+    length = body.length;
+    text_buffer_append(&record, (const char*) &length, sizeof(length));
+    text_buffer_append(&record, body.data, body.length);
+    text_buffer_release(&body);
   }
 
-}
+  va_end(args_copy);
 
-void message(const char *context, const char *format, ...) {
+  write_file_buffer(
+    &binary_log_file_buffer,
+    binary_log_file,
+    record.data,
+    record.length
+  );
 
-  va_list arg_list;
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
 
-  // Start the argument list with any arguments after the format string:
-  va_start(arg_list, format);
+  // Free allocated resources:
+  text_buffer_release(&record);
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+}
 
-  // Print context:
-  if(context != NULL)
-    print_context(context);
+static int write_crash_record(
+  const AsyncRecordSlot* slot,
+  size_t position,
+  int file_descriptor
+) {
 
-  // Print message contents:
-  color_text(logger_color_pallet.message_colors[DEFAULT_MSG].text_color);
-  color_background(
-    logger_color_pallet.message_colors[DEFAULT_MSG].background_color
-  );
-  print_formatted_text(format, arg_list);
+  char digits[24], json[6 * ASYNC_RECORD_SIZE + 128];
+  char line[ASYNC_RECORD_SIZE + 64], timestamp[48];
+  const char *body, *name, *tag;
+  int has_context, i;
+  long fraction;
+  MessageCategory category;
+  size_t body_length, context_length, fields_length, json_length = 0;
+  size_t length = 0, stored_length, timestamp_length = 0;
+  unsigned long seconds;
+
+  if(
+    atomic_load_explicit(&slot->sequence, memory_order_acquire) !=
+    position + 1
+  )
+    return -1;
 
-  // Reset display colors:
-  reset_colors();
+  // Copy the slot's fields, which are only trusted after the slot is checked
+  // again, and bound them so a reused slot can't be read out of bounds:
+  category = slot->category;
+  has_context = slot->has_context;
+  context_length = slot->context_length;
+  fields_length = slot->fields_length;
+  stored_length = slot->body_length;
+  body_length = stored_length;
+  fraction = slot->timestamp.tv_nsec % 1000000000;
+  seconds = (unsigned long) slot->timestamp.tv_sec;
+
+  if(
+    (unsigned int) category >= NUM_OF_MESSAGE_CATEGORIES ||
+    context_length > ASYNC_RECORD_SIZE ||
+    fields_length > ASYNC_RECORD_SIZE - context_length ||
+    body_length > ASYNC_RECORD_SIZE - context_length - fields_length
+  )
+    return -1;
 
-  // If a log file exists, write the message contents to it:
-  if(log_file != NULL)
-    log_message(
-      log_file,
-      &logger_time_fmt,
-      context,
-      NULL,
-      format,
-      arg_list
-    );
+  tag = message_tags[category];
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  if(fraction < 0)
+    fraction = 0;
 
-  // Free allocated resources:
-  va_end(arg_list);
+  // Render the time as "[seconds.nanoseconds] ", without the C library:
+  i = sizeof(digits);
 
-}
+  do {
+    digits[--i] = '0' + seconds % 10;
+    seconds /= 10;
+  } while(seconds > 0);
 
-void reset_background_color() {
-  color_background(DFLT);
-}
+  timestamp[timestamp_length++] = '[';
+  memcpy(timestamp + timestamp_length, digits + i, sizeof(digits) - i);
+  timestamp_length += sizeof(digits) - i;
+  timestamp[timestamp_length++] = '.';
 
-void reset_colors() {
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  for(i = 8; i >= 0; i--) {
+    timestamp[timestamp_length + i] = '0' + fraction % 10;
+    fraction /= 10;
+  }
 
-  apply_all_default_attributes();
-  clear_line_text_background_past_cursor();
+  timestamp_length += 9;
+  timestamp[timestamp_length++] = ']';
+  timestamp[timestamp_length++] = ' ';
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
-}
+  // Render the message like in a log file, without colors:
+  if(has_context) {
+    memcpy(line, slot->contents, context_length);
+    length = context_length;
+    line[length++] = ':';
+    line[length++] = ' ';
+  }
 
-void reset_logger_colors() {
+  if(tag != NULL) {
+    memcpy(line + length, tag, strlen(tag));
+    length += strlen(tag);
+    line[length++] = ' ';
+  }
 
-  int i;
+  body = slot->contents + context_length + fields_length;
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  // Render the fields before the newline that ends the contents:
+  if(
+    fields_length > 0 &&
+    body_length > 0 &&
+    body[body_length - 1] == '\n'
+  )
+    body_length--;
 
-  for(i = 0; i < NUM_OF_MESSAGE_CATEGORIES; i++) {
-    copy_display_colors(
-      &logger_color_pallet.message_colors[i],
-      &default_color_pallet.message_colors[i]
-    );
+  memcpy(line + length, body, body_length);
+  length += body_length;
+
+  if(fields_length > 0) {
+    line[length++] = ' ';
+    memcpy(line + length, slot->contents + context_length, fields_length);
+    length += fields_length;
+
+    if(body_length < stored_length)
+      line[length++] = '\n';
   }
 
-  for(i = 0; i < NUM_OF_TAG_CATEGORIES; i++) {
-    copy_display_colors(
-      &logger_color_pallet.tag_colors[i],
-      &default_color_pallet.tag_colors[i]
+  // Render the message as a JSON object for JSON Lines log files, with the
+  // same seconds since the epoch:
+  if(
+    file_descriptor >= 0 &&
+    atomic_load_explicit(&log_file_format, memory_order_relaxed) ==
+    JSON_LOG_FILE
+  ) {
+    name = message_category_names[category];
+    body_length = stored_length;
+
+    if(body_length > 0 && body[body_length - 1] == '\n')
+      body_length--;
+
+    memcpy(json, "{\"timestamp\":", 13);
+    json_length = 13;
+    memcpy(json + json_length, timestamp + 1, timestamp_length - 3);
+    json_length += timestamp_length - 3;
+    memcpy(json + json_length, ",\"category\":\"", 13);
+    json_length += 13;
+    memcpy(json + json_length, name, strlen(name));
+    json_length += strlen(name);
+    memcpy(json + json_length, "\",\"context\":", 12);
+    json_length += 12;
+
+    if(has_context)
+      json_length += render_crash_json_string(
+        json + json_length,
+        slot->contents,
+        context_length
+      );
+
+    else {
+      memcpy(json + json_length, "null", 4);
+      json_length += 4;
+    }
+
+    memcpy(json + json_length, ",\"message\":", 11);
+    json_length += 11;
+    json_length += render_crash_json_string(
+      json + json_length,
+      body,
+      body_length
     );
+    memcpy(json + json_length, ",\"fields\":", 10);
+    json_length += 10;
+
+    if(fields_length > 0) {
+      memcpy(
+        json + json_length,
+        slot->contents + context_length,
+        fields_length
+      );
+      json_length += fields_length;
+    }
+
+    else {
+      memcpy(json + json_length, "{}", 2);
+      json_length += 2;
+    }
+
+    memcpy(json + json_length, "}\n", 2);
+    json_length += 2;
   }
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
-}
-
-void reset_text_color() {
-  color_text(DFLT);
-}
+  // Drop the message if it's slot was consumed while it was rendered:
+  if(
+    atomic_load_explicit(&slot->sequence, memory_order_acquire) !=
+    position + 1
+  )
+    return -1;
 
-void success(const char *context, const char *format, ...) {
+  if(atomic_load_explicit(&console_output_enabled, memory_order_relaxed))
+    write_crash_text(STDOUT_FILENO, line, length);
 
-  const char msg_type[10] = "(Success)";
-  va_list arg_list;
+  if(file_descriptor >= 0 && json_length > 0)
+    write_crash_text(file_descriptor, json, json_length);
 
-  // Start the argument list with any arguments after the format string:
-  va_start(arg_list, format);
+  else if(file_descriptor >= 0) {
+    write_crash_text(file_descriptor, timestamp, timestamp_length);
+    write_crash_text(file_descriptor, line, length);
+  }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  return 0;
 
-  // Print context:
-  if(context != NULL)
-    print_context(context);
+}
 
-  // Print tags:
-  color_text(logger_color_pallet.tag_colors[SUCCESS_TAG].text_color);
-  color_background(
-    logger_color_pallet.tag_colors[SUCCESS_TAG].background_color
-  );
-  printf("%s ", msg_type);
+static void write_crash_text(
+  int descriptor,
+  const char* text,
+  size_t text_length
+) {
 
-  // Print message contents:
-  color_text(logger_color_pallet.message_colors[SUCCESS_MSG].text_color);
-  color_background(
-    logger_color_pallet.message_colors[SUCCESS_MSG].background_color
-  );
-  print_formatted_text(format, arg_list);
+  ssize_t written;
 
-  // Reset display colors:
-  reset_colors();
+  while(text_length > 0) {
 
-  // If a log file exists, write the message contents to it:
-  if(log_file != NULL)
-    log_message(
-      log_file,
-      &logger_time_fmt,
-      context,
-      msg_type,
-      format,
-      arg_list
-    );
+    written = write(descriptor, text, text_length);
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+    if(written < 0 && errno == EINTR)
+      continue;
 
-  // Free allocated resources:
-  va_end(arg_list);
+    if(written <= 0)
+      return;
 
-}
+    text += written;
+    text_length -= written;
 
-void unlock_logger_recursive_mutex() {
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  }
 
-  else
-    warning(
-      "Logger module",
-      "Enable thread safety to access the logger recursive mutex."
-    );
 }
 
-void warning(const char *context, const char *format, ...) {
+static void write_file_buffer(
+  FileBuffer* buffer,
+  FILE* stream,
+  const void* data,
+  size_t length
+) {
 
-  const char msg_type[10] = "(Warning)";
-  va_list arg_list;
+  if(buffer->length + length > sizeof(buffer->data))
+    flush_file_buffer(buffer, stream);
 
-  // Start the argument list with any arguments after the format string:
-  va_start(arg_list, format);
+  if(length > sizeof(buffer->data)) {
+    fwrite(data, 1, length, stream);
+    return;
+  }
 
-  // Acquire logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_lock(logger_recursive_mutex);
+  acquire_crash_lock(&buffer->crash_lock);
+  memcpy(buffer->data + buffer->length, data, length);
+  buffer->length += length;
+  release_crash_lock(&buffer->crash_lock);
 
-  // Print context:
-  if(context != NULL)
-    print_context(context);
+}
 
-  // Print tags:
-  color_text(logger_color_pallet.tag_colors[WARNING_TAG].text_color);
-  color_background(
-    logger_color_pallet.tag_colors[WARNING_TAG].background_color
-  );
-  printf("%s ", msg_type);
+static void write_flight_records() {
 
-  // Print message contents:
-  color_text(logger_color_pallet.message_colors[WARNING_MSG].text_color);
-  color_background(
-    logger_color_pallet.message_colors[WARNING_MSG].background_color
-  );
-  print_formatted_text(format, arg_list);
+  char console_storage[LINE_STORAGE_SIZE], file_storage[LINE_STORAGE_SIZE];
+  FlightRecord copies[2], *candidate = &copies[0], *oldest = &copies[1], *swap;
+  FlightRecorder *oldest_recorder, *recorder;
+  LogFileFormat file_format;
+  LogRecord record;
+  TextBuffer console_batch, file_batch;
+  time_t batch_time = 0;
 
-  // Reset display colors:
-  reset_colors();
+  // Acquire logger lock if thread safety is enabled. It's held until the dump
+  // is written, so no message is written between the messages pending in the
+  // async logging ring buffer and the dump:
+  lock_logger();
 
-  // If a log file exists, write the message contents to it:
-  if(log_file != NULL)
-    log_message(
-      log_file,
-      &logger_time_fmt,
-      context,
-      msg_type,
-      format,
-      arg_list
-    );
+  if(log_file == NULL && mapped_log_file == NULL) {
+    unlock_logger();
+    return;
+  }
 
-  // Release logger recursive lock if thread safety is enabled:
-  if(logger_recursive_mutex != NULL)
-    pthread_mutex_unlock(logger_recursive_mutex);
+  text_buffer_init(&console_batch, console_storage, sizeof(console_storage));
+  text_buffer_init(&file_batch, file_storage, sizeof(file_storage));
+
+  if(atomic_load_explicit(&async_logging_enabled, memory_order_acquire))
+    while(drain_async_ring(&console_batch, &file_batch) > 0);
+
+  // Only dump the messages kept until now which weren't overwritten yet:
+  for(
+    recorder = atomic_load(&flight_recorders);
+    recorder != NULL;
+    recorder = recorder->next
+  ) {
+    recorder->dump_end = atomic_load_explicit(
+      &recorder->position,
+      memory_order_acquire
+    );
 
-  // Free allocated resources:
-  va_end(arg_list);
+    if(recorder->dump_end - recorder->dump_position > flight_recorder_mask)
+      recorder->dump_position = recorder->dump_end - flight_recorder_mask - 1;
+  }
 
-}
+  file_format = atomic_load_explicit(&log_file_format, memory_order_relaxed);
+
+  // Merge the messages of every thread missing from the log file, oldest
+  // first:
+  while(1) {
+
+    oldest_recorder = NULL;
+
+    for(
+      recorder = atomic_load(&flight_recorders);
+      recorder != NULL;
+      recorder = recorder->next
+    ) {
+
+      // Skip the records overwritten since the dump started:
+      while(
+        recorder->dump_position != recorder->dump_end &&
+        read_flight_record(recorder, recorder->dump_position, candidate) != 0
+      )
+        recorder->dump_position++;
+
+      if(recorder->dump_position == recorder->dump_end)
+        continue;
+
+      if(
+        oldest_recorder == NULL ||
+        candidate->timestamp.tv_sec < oldest->timestamp.tv_sec ||
+        (
+          candidate->timestamp.tv_sec == oldest->timestamp.tv_sec &&
+          candidate->timestamp.tv_nsec < oldest->timestamp.tv_nsec
+        )
+      ) {
+        oldest_recorder = recorder;
+        swap = oldest;
+        oldest = candidate;
+        candidate = swap;
+      }
 
-// Private function implementations:
-static void apply_all_default_attributes() {
-  printf("\x1B[0m");
-}
+    }
 
-static void clear_line_text_background_past_cursor() {
-  // When bash creates a new line, it colors the background of the entire new
-  // line automatically. The following printf clears any existing background
-  // on the current line past the cursor position.
-  printf("\x1B[K");
-}
+    if(oldest_recorder == NULL)
+      break;
 
-static void copy_display_colors(
-  DisplayColors* destination,
-  const DisplayColors* origin
-) {
-  destination->background_color = origin->background_color;
-  destination->text_color = origin->text_color;
-}
+    oldest_recorder->dump_position++;
 
-static void log_formatted_text_content(
-  FILE* log_file,
-  const char* text_format,
-  va_list text_args
-) {
+    if(oldest->logged)
+      continue;
 
-  va_list text_args_copy;
+    record.category = oldest->category;
+    record.timestamp = oldest->timestamp;
+    record.context = oldest->has_context ? oldest->contents : NULL;
+    record.context_length = oldest->context_length;
+    record.fields = oldest->contents + oldest->context_length;
+    record.fields_length = oldest->fields_length;
+    record.body = record.fields + record.fields_length;
+    record.body_length = oldest->body_length;
 
-  // We need to copy the args va_list because any v*printf() makes the va_list
-  // unusable for future v*printf() calls.
-  va_copy(text_args_copy, text_args);
-  vfprintf(log_file, text_format, text_args_copy);
-  va_end(text_args_copy);
+    render_log_file_line(&file_batch, &record, file_format);
+    batch_time = record.timestamp.tv_sec;
 
-}
+  }
 
-static void log_message(
-  FILE* log_file,
-  TimeFormat* time_format,
-  const char* msg_context,
-  const char* msg_type,
-  const char* msg_format,
-  va_list msg_args
-) {
+  // Write the whole dump at once:
+  if(log_file != NULL && file_batch.length > 0)
+    write_log_file(file_batch.data, file_batch.length, batch_time);
 
-  // This check is a little of an overkill... but better safe than sorry!
-  if(log_file != NULL) {
+  // Release logger lock if thread safety is enabled:
+  unlock_logger();
 
-    // Log the timestamp according to the format specified by the user:
-    log_timestamp(log_file, time_format);
+  if(mapped_log_file != NULL && file_batch.length > 0)
+    write_mapped_log_file(file_batch.data, file_batch.length);
 
-    // Log the message context:
-    if(msg_context != NULL)
-      fprintf(log_file, "%s: ", msg_context);
+  // Free allocated resources:
+  text_buffer_release(&console_batch);
+  text_buffer_release(&file_batch);
 
-    // Log the message type:
-    if(msg_type != NULL)
-      fprintf(log_file, "%s ", msg_type);
+}
 
-    log_formatted_text_content(log_file, msg_format, msg_args);
+static void write_log_file(const char* text, size_t text_length, time_t now) {
+
+  // Rotate the log file before this text would exceed the max file size, or
+  // if it's rotation interval has elapsed:
+  if(
+    (
+      log_rotation_policy.max_file_size > 0 &&
+      log_file_size > 0 &&
+      log_file_size + text_length > log_rotation_policy.max_file_size
+    ) || (
+      log_rotation_policy.rotation_interval > 0 &&
+      now >= log_file_rotation_time
+    )
+  ) {
+    rotate_log_file(now);
+
+    if(log_file == NULL)
+      return;
+  }
 
+  write_file_buffer(&log_file_buffer, log_file, text, text_length);
+  log_file_size += text_length;
+  log_file_unsynced_size += text_length;
+
+  // Wake the sync thread up once the policy's sync size is written:
+  if(
+    log_durability_policy.sync_size > 0 &&
+    log_file_unsynced_size >= log_durability_policy.sync_size &&
+    atomic_load(&log_sync_running) &&
+    !atomic_load_explicit(&log_sync_requested, memory_order_relaxed)
+  ) {
+    pthread_mutex_lock(&log_sync_mutex);
+    log_sync_requested = 1;
+    pthread_cond_signal(&log_sync_condition);
+    pthread_mutex_unlock(&log_sync_mutex);
   }
+
 }
 
-static void log_timestamp(FILE* log_file, TimeFormat* time_format) {
+static void write_log_sinks(
+  const LogRecord* record,
+  const TextBuffer* console_line,
+  const TextBuffer* file_line
+) {
 
-  char timestamp[TIME_FMT_SIZE];
-  struct tm *time_info;
-  time_t raw_time;
+  char lines_storage[LINE_STORAGE_SIZE];
+  const char *line;
+  int console_colors = colors_enabled(), i, rendered[MAX_LOG_SINKS] = { 0 };
+  LogSink *sink;
+  LogRecordView view = {
+    .category = record->category,
+    .timestamp = record->timestamp,
+    .context = record->context,
+    .context_length = record->context_length,
+    .body = record->body,
+    .body_length = record->body_length,
+    .fields = record->fields_length > 0 ? record->fields : NULL,
+    .fields_length = record->fields_length
+  };
+  size_t line_length, line_offsets[MAX_LOG_SINKS];
+  size_t line_lengths[MAX_LOG_SINKS];
+  TextBuffer lines;
+
+  text_buffer_init(&lines, lines_storage, sizeof(lines_storage));
+
+  for(i = 0; i < MAX_LOG_SINKS; i++) {
+
+    sink = &log_sinks[i];
+
+    if(
+      !sink->attached ||
+      !(sink->category_mask & CATEGORY_MASK(record->category))
+    )
+      continue;
+
+    // Callbacks get the message without rendering it:
+    if(sink->callback != NULL) {
+      sink->callback(&view, sink->user_data);
+      continue;
+    }
+
+    // Reuse the lines already rendered for the terminal or the log file:
+    if(
+      console_line != NULL &&
+      sink->timestamp == NO_TIMESTAMP &&
+      sink->colors == console_colors
+    ) {
+      line = console_line->data;
+      line_length = console_line->length;
+    }
+
+    else if(
+      file_line != NULL &&
+      sink->timestamp == LOGGER_TIMESTAMP &&
+      !sink->colors
+    ) {
+      line = file_line->data;
+      line_length = file_line->length;
+    }
+
+    // Otherwise, render the message once for each variant:
+    else {
+
+      if(!rendered[sink->variant]) {
+        line_offsets[sink->variant] = lines.length;
+        render_sink_record(&lines, record, sink);
+        line_lengths[sink->variant] =
+          lines.length - line_offsets[sink->variant];
+        rendered[sink->variant] = 1;
+      }
 
-  // Get current time information:
-  time(&raw_time);
-  time_info = localtime(&raw_time);
+      line = lines.data + line_offsets[sink->variant];
+      line_length = line_lengths[sink->variant];
 
-  // Format it into a string:
-  strftime(
-    timestamp,
-    TIME_FMT_SIZE,
-    time_format->string_representation,
-    time_info
-  );
+    }
 
-  // Log the string to a file:
-  fprintf(log_file, "[%s] ", timestamp);
+    fwrite(line, 1, line_length, sink->stream);
 
-}
+  }
+
+  text_buffer_release(&lines);
 
-static void print_context(const char *context) {
-  color_text(logger_color_pallet.tag_colors[CONTEXT_TAG].text_color);
-  color_background(
-    logger_color_pallet.tag_colors[CONTEXT_TAG].background_color
-  );
-  printf("%s: ", context);
 }
 
-static void print_formatted_text(const char* text_format, va_list text_args) {
+static void write_mapped_log_file(const char* text, size_t text_length) {
+
+  char *mapping;
+  int reserved = 0;
+  size_t offset;
+
+  pthread_rwlock_rdlock(&mapped_log_file_lock);
+
+  // The file may have been closed since the caller checked it:
+  mapping = mapped_log_file;
+
+  offset = atomic_load_explicit(&mapped_log_file_offset, memory_order_relaxed);
+
+  // Only reserve space once it's allocated, so texts that can't be stored
+  // don't leave holes in the file. Texts beyond the mapping are discarded:
+  while(
+    mapping != NULL &&
+    offset + text_length <= MAPPED_LOG_FILE_WINDOW && (
+      offset + text_length <= atomic_load_explicit(
+        &mapped_log_file_allocated,
+        memory_order_acquire
+      ) ||
+      grow_mapped_log_file(offset + text_length) == 0
+    )
+  ) {
+    if(
+      atomic_compare_exchange_weak_explicit(
+        &mapped_log_file_offset,
+        &offset,
+        offset + text_length,
+        memory_order_relaxed,
+        memory_order_relaxed
+      )
+    ) {
+      reserved = 1;
+      break;
+    }
+  }
 
-  va_list text_args_copy;
+  if(reserved)
+    memcpy(mapping + offset, text, text_length);
 
-  // We need to copy the args va_list because any v*printf() makes the va_list
-  // unusable for future v*printf() calls.
-  va_copy(text_args_copy, text_args);
-  vprintf(text_format, text_args_copy);
-  va_end(text_args_copy);
+  pthread_rwlock_unlock(&mapped_log_file_lock);
 
 }
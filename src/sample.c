@@ -151,6 +151,14 @@ int main() {
 
   printf("\n");
 
+  // Using asynchronous logging:
+  printf("Using asynchronous logging: \n");
+
+  enable_async_logging(256);
+
+  for (i = 0; i < THREAD_NUM; i++)
+    info("Async", "Message number %d written by the writer thread!\n", i+1);
+
   // Clean up:
   logger_module_clean_up();
 
@@ -214,12 +222,12 @@ void* thread_example (void *args) {
         break;
 
       case 5:
-        lock_logger_recursive_mutex();
+        begin_logger_batch();
         color_text(BLU);
         color_background(B_GRN);
         printf("%s: Message number %d!\n", thread_context, i+1);
         reset_colors();
-        unlock_logger_recursive_mutex();
+        end_logger_batch();
         break;
     }
 